@@ -1,15 +1,22 @@
 #version 430 core
 
-in vec3 vert;
-in vec2 vertTexCoord;
+layout(std140, binding = 0) uniform FrameConstants
+{
+    mat4 worldProjection;
+};
 
-uniform mat4 model;
+layout(location = 0) in vec2 vert;
+layout(location = 1) in mat4 model;
+layout(location = 5) in vec4 uvRect;
+layout(location = 6) in float space;
 
 out vec2 fragTexCoord;
 
 void main() 
 {
-    fragTexCoord = vec2(1.0 - vertTexCoord.x, 1.0 - vertTexCoord.y);
+    vec2 texCoord = vec2(vert.x * 0.5 + 0.5, 0.5 - vert.y * 0.5);
+    fragTexCoord = uvRect.xy + texCoord * uvRect.zw;
     
-    gl_Position = model * vec4(vert, 1);
+    mat4 projection = space > 0.5 ? worldProjection : mat4(1.0);
+    gl_Position = projection * model * vec4(vert, 1.0, 1);
 }
\ No newline at end of file
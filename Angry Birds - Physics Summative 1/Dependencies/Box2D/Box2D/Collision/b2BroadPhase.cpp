@@ -17,14 +17,66 @@
 */
 
 #include <Box2D/Collision/b2BroadPhase.h>
+#include <Box2D/Common/b2TaskScheduler.h>
+
+// The fewest moved proxies worth handing to another thread.
+const int32 b2_minPairQueryRange = 32;
+
+// Queries the tree for moved proxies. Each thread adds pairs to its own buffer.
+class b2PairQueryTask : public b2Task
+{
+public:
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		b2PairBuffer* buffer = broadPhase->m_pairBuffers + threadIndex;
+		const b2DynamicTree* tree = &broadPhase->m_tree;
+
+		for (int32 i = begin; i < end; ++i)
+		{
+			buffer->queryProxyId = broadPhase->m_moveBuffer[i];
+			if (buffer->queryProxyId == b2BroadPhase::e_nullProxy)
+			{
+				continue;
+			}
+
+			// We have to query the tree with the fat AABB so that
+			// we don't fail to create a pair that may touch later.
+			const b2AABB& fatAABB = tree->GetFatAABB(buffer->queryProxyId);
+
+			// Query tree, create pairs and add them pair buffer.
+			tree->Query(buffer, fatAABB);
+		}
+	}
+
+	b2BroadPhase* broadPhase;
+};
+
+// Sorts each pair buffer to expose duplicates, so they can be merged in order.
+class b2PairSortTask : public b2Task
+{
+public:
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		B2_NOT_USED(threadIndex);
+
+		for (int32 i = begin; i < end; ++i)
+		{
+			b2PairBuffer* buffer = broadPhase->m_pairBuffers + i;
+			std::sort(buffer->pairs, buffer->pairs + buffer->count, b2PairLessThan);
+		}
+	}
+
+	b2BroadPhase* broadPhase;
+};
 
 b2BroadPhase::b2BroadPhase()
 {
 	m_proxyCount = 0;
 
-	m_pairCapacity = 16;
-	m_pairCount = 0;
-	m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
+	m_taskScheduler = NULL;
+	m_pairBuffers = NULL;
+	m_pairBufferCount = 0;
+	SetTaskScheduler(NULL);
 
 	m_moveCapacity = 16;
 	m_moveCount = 0;
@@ -34,7 +86,41 @@ b2BroadPhase::b2BroadPhase()
 b2BroadPhase::~b2BroadPhase()
 {
 	b2Free(m_moveBuffer);
-	b2Free(m_pairBuffer);
+
+	for (int32 i = 0; i < m_pairBufferCount; ++i)
+	{
+		b2Free(m_pairBuffers[i].pairs);
+	}
+	b2Free(m_pairBuffers);
+}
+
+void b2BroadPhase::Clear()
+{
+	m_tree.Clear();
+	m_proxyCount = 0;
+	m_moveCount = 0;
+}
+
+void b2BroadPhase::SetTaskScheduler(b2TaskScheduler* scheduler)
+{
+	for (int32 i = 0; i < m_pairBufferCount; ++i)
+	{
+		b2Free(m_pairBuffers[i].pairs);
+	}
+	b2Free(m_pairBuffers);
+
+	m_taskScheduler = scheduler;
+	m_pairBufferCount = scheduler ? scheduler->GetThreadCount() : 1;
+	m_pairBuffers = (b2PairBuffer*)b2Alloc(m_pairBufferCount * sizeof(b2PairBuffer));
+	for (int32 i = 0; i < m_pairBufferCount; ++i)
+	{
+		b2PairBuffer* buffer = m_pairBuffers + i;
+		buffer->capacity = 16;
+		buffer->count = 0;
+		buffer->pairs = (b2Pair*)b2Alloc(buffer->capacity * sizeof(b2Pair));
+		buffer->queryProxyId = e_nullProxy;
+		buffer->head = 0;
+	}
 }
 
 int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
@@ -92,28 +178,62 @@ void b2BroadPhase::UnBufferMove(int32 proxyId)
 	}
 }
 
+void b2BroadPhase::FindPairs()
+{
+	// Reset pair buffers
+	for (int32 i = 0; i < m_pairBufferCount; ++i)
+	{
+		m_pairBuffers[i].count = 0;
+		m_pairBuffers[i].head = 0;
+	}
+
+	// The moves are all in, so the wide layout can be brought up to date for
+	// the queries below and the ones made before the next step.
+	m_tree.UpdateWideLayout();
+
+	// Perform tree queries for all moving proxies. Which buffer a pair lands
+	// in doesn't matter, the merge puts them back in order.
+	b2PairQueryTask queryTask;
+	queryTask.broadPhase = this;
+	b2PairSortTask sortTask;
+	sortTask.broadPhase = this;
+	if (m_taskScheduler)
+	{
+		m_taskScheduler->ParallelFor(&queryTask, m_moveCount, b2_minPairQueryRange);
+		m_taskScheduler->ParallelFor(&sortTask, m_pairBufferCount, 1);
+	}
+	else
+	{
+		queryTask.Execute(0, m_moveCount, 0);
+		sortTask.Execute(0, m_pairBufferCount, 0);
+	}
+
+	// Reset move buffer
+	m_moveCount = 0;
+}
+
 // This is called from b2DynamicTree::Query when we are gathering pairs.
-bool b2BroadPhase::QueryCallback(int32 proxyId)
+bool b2PairBuffer::QueryCallback(int32 proxyId)
 {
 	// A proxy cannot form a pair with itself.
-	if (proxyId == m_queryProxyId)
+	if (proxyId == queryProxyId)
 	{
 		return true;
 	}
 
 	// Grow the pair buffer as needed.
-	if (m_pairCount == m_pairCapacity)
+	if (count == capacity)
 	{
-		b2Pair* oldBuffer = m_pairBuffer;
-		m_pairCapacity *= 2;
-		m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
-		memcpy(m_pairBuffer, oldBuffer, m_pairCount * sizeof(b2Pair));
+		b2Pair* oldBuffer = pairs;
+		capacity *= 2;
+		pairs = (b2Pair*)b2Alloc(capacity * sizeof(b2Pair));
+		memcpy(pairs, oldBuffer, count * sizeof(b2Pair));
 		b2Free(oldBuffer);
 	}
 
-	m_pairBuffer[m_pairCount].proxyIdA = b2Min(proxyId, m_queryProxyId);
-	m_pairBuffer[m_pairCount].proxyIdB = b2Max(proxyId, m_queryProxyId);
-	++m_pairCount;
+	pairs[count].proxyIdA = b2Min(proxyId, queryProxyId);
+	pairs[count].proxyIdB = b2Max(proxyId, queryProxyId);
+	++count;
 
 	return true;
 }
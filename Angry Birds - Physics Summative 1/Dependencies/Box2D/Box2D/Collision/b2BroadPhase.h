@@ -24,12 +24,29 @@
 #include <Box2D/Collision/b2DynamicTree.h>
 #include <algorithm>
 
+class b2TaskScheduler;
+
 struct b2Pair
 {
 	int32 proxyIdA;
 	int32 proxyIdB;
 };
 
+/// The pairs found by one thread during UpdatePairs. This is an internal struct.
+struct b2PairBuffer
+{
+	/// This is called from b2DynamicTree::Query when we are gathering pairs.
+	bool QueryCallback(int32 proxyId);
+
+	b2Pair* pairs;
+	int32 capacity;
+	int32 count;
+
+	// The proxy being queried and, once sorted, the next pair to merge.
+	int32 queryProxyId;
+	int32 head;
+};
+
 /// The broad-phase is used for computing pairs and performing volume queries and ray casts.
 /// This broad-phase does not persist pairs. Instead, this reports potentially new pairs.
 /// It is up to the client to consume the new pairs and to track subsequent overlap.
@@ -52,6 +69,9 @@ public:
 	/// Destroy a proxy. It is up to the client to remove any pairs.
 	void DestroyProxy(int32 proxyId);
 
+	/// Destroy all proxies at once.
+	void Clear();
+
 	/// Call MoveProxy as many times as you like, then when you are done
 	/// call UpdatePairs to finalized the proxy pairs (for your time step).
 	void MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement);
@@ -71,6 +91,10 @@ public:
 	/// Get the number of proxies.
 	int32 GetProxyCount() const;
 
+	/// Use a task scheduler to query the tree for moved proxies on several threads, or NULL
+	/// to query on the calling thread. The pairs reported are the same either way.
+	void SetTaskScheduler(b2TaskScheduler* scheduler);
+
 	/// Update the pairs. This results in pair callbacks. This can only add pairs.
 	template <typename T>
 	void UpdatePairs(T* callback);
@@ -90,6 +114,19 @@ public:
 	template <typename T>
 	void RayCast(T* callback, const b2RayCastInput& input) const;
 
+	/// Query a batch of AABBs for overlapping proxies. See b2DynamicTree::QueryBatch.
+	template <typename T>
+	void QueryBatch(T* callback, const b2AABB* aabbs, int32 count) const;
+
+	/// Ray-cast a batch of rays against the proxies. See b2DynamicTree::RayCastBatch.
+	template <typename T>
+	void RayCastBatch(T* callback, const b2RayCastInput* inputs, int32 count) const;
+
+	/// Keep a 4-wide layout of the embedded tree for queries. See b2DynamicTree::SetWideLayout.
+	/// It is brought up to date when the pairs are updated.
+	void SetWideTreeLayout(bool flag) { m_tree.SetWideLayout(flag); }
+	bool GetWideTreeLayout() const { return m_tree.GetWideLayout(); }
+
 	/// Get the height of the embedded tree.
 	int32 GetTreeHeight() const;
 
@@ -106,12 +143,13 @@ public:
 
 private:
 
-	friend class b2DynamicTree;
+	friend class b2PairQueryTask;
+	friend class b2PairSortTask;
 
 	void BufferMove(int32 proxyId);
 	void UnBufferMove(int32 proxyId);
 
-	bool QueryCallback(int32 proxyId);
+	void FindPairs();
 
 	b2DynamicTree m_tree;
 
@@ -121,11 +159,10 @@ private:
 	int32 m_moveCapacity;
 	int32 m_moveCount;
 
-	b2Pair* m_pairBuffer;
-	int32 m_pairCapacity;
-	int32 m_pairCount;
-
-	int32 m_queryProxyId;
+	// One pair buffer per task scheduler thread.
+	b2TaskScheduler* m_taskScheduler;
+	b2PairBuffer* m_pairBuffers;
+	int32 m_pairBufferCount;
 };
 
 /// This is used to sort pairs.
@@ -184,53 +221,49 @@ inline float32 b2BroadPhase::GetTreeQuality() const
 template <typename T>
 void b2BroadPhase::UpdatePairs(T* callback)
 {
-	// Reset pair buffer
-	m_pairCount = 0;
-
-	// Perform tree queries for all moving proxies.
-	for (int32 i = 0; i < m_moveCount; ++i)
+	// Query the tree for all moving proxies into the sorted pair buffers.
+	FindPairs();
+
+	// Merge the pair buffers in order, skipping duplicate pairs, and send
+	// the pairs back to the client.
+	b2Pair previous;
+	previous.proxyIdA = e_nullProxy;
+	previous.proxyIdB = e_nullProxy;
+	for (;;)
 	{
-		m_queryProxyId = m_moveBuffer[i];
-		if (m_queryProxyId == e_nullProxy)
+		b2PairBuffer* minBuffer = NULL;
+		for (int32 i = 0; i < m_pairBufferCount; ++i)
 		{
-			continue;
-		}
+			b2PairBuffer* buffer = m_pairBuffers + i;
+			if (buffer->head == buffer->count)
+			{
+				continue;
+			}
 
-		// We have to query the tree with the fat AABB so that
-		// we don't fail to create a pair that may touch later.
-		const b2AABB& fatAABB = m_tree.GetFatAABB(m_queryProxyId);
+			if (minBuffer == NULL || b2PairLessThan(buffer->pairs[buffer->head], minBuffer->pairs[minBuffer->head]))
+			{
+				minBuffer = buffer;
+			}
+		}
 
-		// Query tree, create pairs and add them pair buffer.
-		m_tree.Query(this, fatAABB);
-	}
+		if (minBuffer == NULL)
+		{
+			break;
+		}
 
-	// Reset move buffer
-	m_moveCount = 0;
+		const b2Pair* pair = minBuffer->pairs + minBuffer->head;
+		++minBuffer->head;
 
-	// Sort the pair buffer to expose duplicates.
-	std::sort(m_pairBuffer, m_pairBuffer + m_pairCount, b2PairLessThan);
+		if (pair->proxyIdA == previous.proxyIdA && pair->proxyIdB == previous.proxyIdB)
+		{
+			continue;
+		}
+		previous = *pair;
 
-	// Send the pairs back to the client.
-	int32 i = 0;
-	while (i < m_pairCount)
-	{
-		b2Pair* primaryPair = m_pairBuffer + i;
-		void* userDataA = m_tree.GetUserData(primaryPair->proxyIdA);
-		void* userDataB = m_tree.GetUserData(primaryPair->proxyIdB);
+		void* userDataA = m_tree.GetUserData(pair->proxyIdA);
+		void* userDataB = m_tree.GetUserData(pair->proxyIdB);
 
 		callback->AddPair(userDataA, userDataB);
-		++i;
-
-		// Skip any duplicate pairs.
-		while (i < m_pairCount)
-		{
-			b2Pair* pair = m_pairBuffer + i;
-			if (pair->proxyIdA != primaryPair->proxyIdA || pair->proxyIdB != primaryPair->proxyIdB)
-			{
-				break;
-			}
-			++i;
-		}
 	}
 
 	// Try to keep the tree balanced.
@@ -249,6 +282,18 @@ inline void b2BroadPhase::RayCast(T* callback, const b2RayCastInput& input) cons
 	m_tree.RayCast(callback, input);
 }
 
+template <typename T>
+inline void b2BroadPhase::QueryBatch(T* callback, const b2AABB* aabbs, int32 count) const
+{
+	m_tree.QueryBatch(callback, aabbs, count);
+}
+
+template <typename T>
+inline void b2BroadPhase::RayCastBatch(T* callback, const b2RayCastInput* inputs, int32 count) const
+{
+	m_tree.RayCastBatch(callback, inputs, count);
+}
+
 inline void b2BroadPhase::ShiftOrigin(const b2Vec2& newOrigin)
 {
 	m_tree.ShiftOrigin(newOrigin);
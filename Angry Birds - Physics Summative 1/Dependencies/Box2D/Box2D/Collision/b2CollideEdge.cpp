@@ -26,7 +26,8 @@
 // This accounts for edge connectivity.
 void b2CollideEdgeAndCircle(b2Manifold* manifold,
 							const b2EdgeShape* edgeA, const b2Transform& xfA,
-							const b2CircleShape* circleB, const b2Transform& xfB)
+							const b2CircleShape* circleB, const b2Transform& xfB,
+							float32 speculativeDistance)
 {
 	manifold->pointCount = 0;
 	
@@ -40,7 +41,7 @@ void b2CollideEdgeAndCircle(b2Manifold* manifold,
 	float32 u = b2Dot(e, B - Q);
 	float32 v = b2Dot(e, Q - A);
 	
-	float32 radius = edgeA->m_radius + circleB->m_radius;
+	float32 radius = edgeA->m_radius + circleB->m_radius + speculativeDistance;
 	
 	b2ContactFeature cf;
 	cf.indexB = 0;
@@ -194,7 +195,7 @@ struct b2ReferenceFace
 struct b2EPCollider
 {
 	void Collide(b2Manifold* manifold, const b2EdgeShape* edgeA, const b2Transform& xfA,
-				 const b2PolygonShape* polygonB, const b2Transform& xfB);
+				 const b2PolygonShape* polygonB, const b2Transform& xfB, float32 speculativeDistance);
 	b2EPAxis ComputeEdgeSeparation();
 	b2EPAxis ComputePolygonSeparation();
 	
@@ -228,7 +229,7 @@ struct b2EPCollider
 // 7. Return if _any_ axis indicates separation
 // 8. Clip
 void b2EPCollider::Collide(b2Manifold* manifold, const b2EdgeShape* edgeA, const b2Transform& xfA,
-						   const b2PolygonShape* polygonB, const b2Transform& xfB)
+						   const b2PolygonShape* polygonB, const b2Transform& xfB, float32 speculativeDistance)
 {
 	m_xf = b2MulT(xfA, xfB);
 	
@@ -432,7 +433,7 @@ void b2EPCollider::Collide(b2Manifold* manifold, const b2EdgeShape* edgeA, const
 		m_polygonB.normals[i] = b2Mul(m_xf.q, polygonB->m_normals[i]);
 	}
 	
-	m_radius = 2.0f * b2_polygonRadius;
+	m_radius = 2.0f * b2_polygonRadius + speculativeDistance;
 	
 	manifold->pointCount = 0;
 	
@@ -691,8 +692,9 @@ b2EPAxis b2EPCollider::ComputePolygonSeparation()
 
 void b2CollideEdgeAndPolygon(	b2Manifold* manifold,
 							 const b2EdgeShape* edgeA, const b2Transform& xfA,
-							 const b2PolygonShape* polygonB, const b2Transform& xfB)
+							 const b2PolygonShape* polygonB, const b2Transform& xfB,
+							 float32 speculativeDistance)
 {
 	b2EPCollider collider;
-	collider.Collide(manifold, edgeA, xfA, polygonB, xfB);
+	collider.Collide(manifold, edgeA, xfA, polygonB, xfB, speculativeDistance);
 }
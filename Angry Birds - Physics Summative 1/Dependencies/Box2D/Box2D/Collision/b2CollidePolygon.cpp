@@ -115,19 +115,23 @@ static void b2FindIncidentEdge(b2ClipVertex c[2],
 // The normal points from 1 to 2
 void b2CollidePolygons(b2Manifold* manifold,
 					  const b2PolygonShape* polyA, const b2Transform& xfA,
-					  const b2PolygonShape* polyB, const b2Transform& xfB)
+					  const b2PolygonShape* polyB, const b2Transform& xfB,
+					  float32 speculativeDistance)
 {
 	manifold->pointCount = 0;
 	float32 totalRadius = polyA->m_radius + polyB->m_radius;
 
+	// The side planes still clip to the skin, only the separation tests are widened.
+	float32 keepRadius = totalRadius + speculativeDistance;
+
 	int32 edgeA = 0;
 	float32 separationA = b2FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
-	if (separationA > totalRadius)
+	if (separationA > keepRadius)
 		return;
 
 	int32 edgeB = 0;
 	float32 separationB = b2FindMaxSeparation(&edgeB, polyB, xfB, polyA, xfA);
-	if (separationB > totalRadius)
+	if (separationB > keepRadius)
 		return;
 
 	const b2PolygonShape* poly1;	// reference polygon
@@ -217,7 +221,7 @@ void b2CollidePolygons(b2Manifold* manifold,
 	{
 		float32 separation = b2Dot(normal, clipPoints2[i].v) - frontOffset;
 
-		if (separation <= totalRadius)
+		if (separation <= keepRadius)
 		{
 			b2ManifoldPoint* cp = manifold->points + pointCount;
 			cp->localPoint = b2MulT(xf2, clipPoints2[i].v);
@@ -41,12 +41,41 @@ b2DynamicTree::b2DynamicTree()
 	m_path = 0;
 
 	m_insertionCount = 0;
+
+	m_wideNodes = NULL;
+	m_wideNodeCount = 0;
+	m_wideNodeCapacity = 0;
+	m_wideLayout = false;
+	m_wideDirty = true;
 }
 
 b2DynamicTree::~b2DynamicTree()
 {
 	// This frees the entire tree in one shot.
 	b2Free(m_nodes);
+	b2Free(m_wideNodes);
+}
+
+void b2DynamicTree::Clear()
+{
+	m_root = b2_nullNode;
+	m_nodeCount = 0;
+
+	// Rebuild the free list over the whole pool.
+	for (int32 i = 0; i < m_nodeCapacity - 1; ++i)
+	{
+		m_nodes[i].next = i + 1;
+		m_nodes[i].height = -1;
+	}
+	m_nodes[m_nodeCapacity-1].next = b2_nullNode;
+	m_nodes[m_nodeCapacity-1].height = -1;
+	m_freeList = 0;
+
+	m_path = 0;
+
+	m_insertionCount = 0;
+
+	m_wideDirty = true;
 }
 
 // Allocate a node from the pool. Grow the pool if necessary.
@@ -176,6 +205,7 @@ bool b2DynamicTree::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& d
 void b2DynamicTree::InsertLeaf(int32 leaf)
 {
 	++m_insertionCount;
+	m_wideDirty = true;
 
 	if (m_root == b2_nullNode)
 	{
@@ -315,6 +345,8 @@ void b2DynamicTree::InsertLeaf(int32 leaf)
 
 void b2DynamicTree::RemoveLeaf(int32 leaf)
 {
+	m_wideDirty = true;
+
 	if (leaf == m_root)
 	{
 		m_root = b2_nullNode;
@@ -668,6 +700,42 @@ void b2DynamicTree::Validate() const
 	b2Assert(GetHeight() == ComputeHeight());
 
 	b2Assert(m_nodeCount + freeCount == m_nodeCapacity);
+
+	ValidateWideLayout();
+#endif
+}
+
+void b2DynamicTree::ValidateWideLayout() const
+{
+#if defined(b2DEBUG)
+	if (IsWideLayoutCurrent() == false)
+	{
+		return;
+	}
+
+	// Each leaf is in the wide layout once, with the same bounds.
+	int32 leafCount = 0;
+	for (int32 i = 0; i < m_wideNodeCount; ++i)
+	{
+		const b2WideTreeNode* node = m_wideNodes + i;
+		b2Assert(1 <= node->count && node->count <= 4);
+		for (int32 j = 0; j < node->count; ++j)
+		{
+			int32 child = node->children[j];
+			if (b2IsWideTreeLeaf(child) == false)
+			{
+				b2Assert(i < child && child < m_wideNodeCount);
+				continue;
+			}
+
+			const b2TreeNode* leaf = m_nodes + b2GetWideTreeProxy(child);
+			b2Assert(leaf->IsLeaf());
+			b2Assert(leaf->aabb.lowerBound.x == node->lowerX[j] && leaf->aabb.upperBound.y == node->upperY[j]);
+			++leafCount;
+		}
+	}
+
+	b2Assert(leafCount == (m_nodeCount + 1) / 2);
 #endif
 }
 
@@ -765,6 +833,7 @@ void b2DynamicTree::RebuildBottomUp()
 
 	m_root = nodes[0];
 	b2Free(nodes);
+	m_wideDirty = true;
 
 	Validate();
 }
@@ -777,4 +846,114 @@ void b2DynamicTree::ShiftOrigin(const b2Vec2& newOrigin)
 		m_nodes[i].aabb.lowerBound -= newOrigin;
 		m_nodes[i].aabb.upperBound -= newOrigin;
 	}
+
+	m_wideDirty = true;
+}
+
+void b2DynamicTree::SetWideLayout(bool flag)
+{
+	if (flag == m_wideLayout)
+	{
+		return;
+	}
+
+	m_wideLayout = flag;
+	m_wideDirty = true;
+
+	if (flag == false)
+	{
+		b2Free(m_wideNodes);
+		m_wideNodes = NULL;
+		m_wideNodeCount = 0;
+		m_wideNodeCapacity = 0;
+	}
+}
+
+void b2DynamicTree::UpdateWideLayout()
+{
+	if (m_wideLayout == false || m_wideDirty == false)
+	{
+		return;
+	}
+
+	// Every wide node but a lone leaf root opens at least one binary node, so this is enough.
+	if (m_wideNodeCapacity < m_nodeCount + 1)
+	{
+		b2Free(m_wideNodes);
+		m_wideNodeCapacity = b2Max(m_nodeCapacity, m_nodeCount + 1);
+		m_wideNodes = (b2WideTreeNode*)b2Alloc(m_wideNodeCapacity * sizeof(b2WideTreeNode));
+	}
+
+	m_wideNodeCount = 0;
+	if (m_root != b2_nullNode)
+	{
+		CollapseNode(m_root);
+	}
+
+	m_wideDirty = false;
+
+	ValidateWideLayout();
+}
+
+// Make a wide node for a binary node by opening descendants until there are four children,
+// and collapse the internal children the same way. The widest child is opened first, as it is
+// the one most likely to be overlapped.
+int32 b2DynamicTree::CollapseNode(int32 nodeId)
+{
+	int32 wideId = m_wideNodeCount++;
+
+	int32 children[4];
+	int32 count = 1;
+	children[0] = nodeId;
+	while (count < 4)
+	{
+		int32 best = -1;
+		float32 bestPerimeter = -1.0f;
+		for (int32 i = 0; i < count; ++i)
+		{
+			const b2TreeNode* child = m_nodes + children[i];
+			if (child->IsLeaf() == false && child->aabb.GetPerimeter() > bestPerimeter)
+			{
+				best = i;
+				bestPerimeter = child->aabb.GetPerimeter();
+			}
+		}
+
+		if (best == -1)
+		{
+			break;
+		}
+
+		const b2TreeNode* opened = m_nodes + children[best];
+		children[best] = opened->child1;
+		children[count++] = opened->child2;
+	}
+
+	// The children are collapsed first, so the node is only written once they are done.
+	b2WideTreeNode node;
+	node.count = count;
+	for (int32 i = 0; i < 4; ++i)
+	{
+		if (i < count)
+		{
+			const b2TreeNode* child = m_nodes + children[i];
+			node.lowerX[i] = child->aabb.lowerBound.x;
+			node.lowerY[i] = child->aabb.lowerBound.y;
+			node.upperX[i] = child->aabb.upperBound.x;
+			node.upperY[i] = child->aabb.upperBound.y;
+			node.children[i] = child->IsLeaf() ? -2 - children[i] : CollapseNode(children[i]);
+		}
+		else
+		{
+			// An empty slot overlaps nothing. It is skipped by count, but the SIMD tests still load it.
+			node.lowerX[i] = b2_maxFloat;
+			node.lowerY[i] = b2_maxFloat;
+			node.upperX[i] = -b2_maxFloat;
+			node.upperY[i] = -b2_maxFloat;
+			node.children[i] = b2_nullNode;
+		}
+	}
+
+	m_wideNodes[wideId] = node;
+	return wideId;
 }
@@ -21,6 +21,7 @@
 
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Common/b2GrowableStack.h>
+#include <Box2D/Common/b2WideFloat.h>
 
 #define b2_nullNode (-1)
 
@@ -50,6 +51,21 @@ struct b2TreeNode
 	int32 height;
 };
 
+/// A node of the wide layout of the dynamic tree. The bounds of the four children are
+/// stored side by side so they can be tested together. The client does not interact
+/// with this directly.
+struct b2WideTreeNode
+{
+	float32 lowerX[4];
+	float32 lowerY[4];
+	float32 upperX[4];
+	float32 upperY[4];
+
+	// Wide node index, or a leaf as -2 - proxyId. Only the first count are used.
+	int32 children[4];
+	int32 count;
+};
+
 /// A dynamic AABB tree broad-phase, inspired by Nathanael Presson's btDbvt.
 /// A dynamic tree arranges data in a binary tree to accelerate
 /// queries such as volume queries and ray casts. Leafs are proxies
@@ -67,6 +83,9 @@ public:
 	/// Destroy the tree, freeing the node pool.
 	~b2DynamicTree();
 
+	/// Destroy all proxies at once. The node pool is kept.
+	void Clear();
+
 	/// Create a proxy. Provide a tight fitting AABB and a userData pointer.
 	int32 CreateProxy(const b2AABB& aabb, void* userData);
 
@@ -101,6 +120,33 @@ public:
 	template <typename T>
 	void RayCast(T* callback, const b2RayCastInput& input) const;
 
+	/// Query a batch of AABBs for overlapping proxies. The AABBs are tested against each
+	/// node several at a time with SIMD, so the tree is traversed once per packet rather
+	/// than once per AABB. The callback class is called with QueryCallback(proxyId, index)
+	/// for each proxy that overlaps AABB index. Returning false stops that query only.
+	template <typename T>
+	void QueryBatch(T* callback, const b2AABB* aabbs, int32 count) const;
+
+	/// Ray-cast a batch of rays against the proxies in the tree. The rays are tested against
+	/// each node several at a time with SIMD slab tests, so rays that start close together
+	/// and point the same way should be next to each other in the array. The callback class
+	/// is called with RayCastCallback(input, proxyId, index) for each proxy hit by ray index,
+	/// and its return value clips or terminates that ray the same way as in RayCast.
+	template <typename T>
+	void RayCastBatch(T* callback, const b2RayCastInput* inputs, int32 count) const;
+
+	/// Keep a 4-wide layout of the tree for queries. Each wide node holds the bounds of its four
+	/// children side by side, so one visit tests them all with SIMD. The binary tree is still
+	/// the one that is updated, the wide layout is collapsed from it by UpdateWideLayout.
+	/// Proxy ids are the same in both.
+	void SetWideLayout(bool flag);
+	bool GetWideLayout() const { return m_wideLayout; }
+
+	/// Collapse the binary tree into the wide layout if it changed since the last call.
+	/// Queries only use the wide layout while it is up to date, so call this after moving
+	/// proxies and before querying. Unlike the queries, this is not thread safe.
+	void UpdateWideLayout();
+
 	/// Validate this tree. For testing.
 	void Validate() const;
 
@@ -138,6 +184,30 @@ private:
 
 	void ValidateStructure(int32 index) const;
 	void ValidateMetrics(int32 index) const;
+	void ValidateWideLayout() const;
+
+	int32 CollapseNode(int32 nodeId);
+	bool IsWideLayoutCurrent() const;
+
+	template <typename T>
+	void QueryWide(T* callback, const b2AABB& aabb) const;
+
+	template <typename T>
+	void RayCastWide(T* callback, const b2RayCastInput& input) const;
+
+	template <typename T>
+	bool QueryPacketLeaf(T* callback, int32 first, int32 count, int32 proxyId, int32 bits,
+		float32* lowerX, float32* lowerY, float32* upperX, float32* upperY, int32* activeCount) const;
+
+	template <typename T>
+	bool RayCastPacketLeaf(T* callback, const b2RayCastInput* inputs, int32 first, int32 count,
+		int32 proxyId, int32 bits, float32* maxFractions, int32* activeCount) const;
+
+	template <typename F, int32 W, typename T>
+	void QueryPacket(T* callback, const b2AABB* aabbs, int32 first, int32 count) const;
+
+	template <typename F, int32 W, typename T>
+	void RayCastPacket(T* callback, const b2RayCastInput* inputs, int32 first, int32 count) const;
 
 	int32 m_root;
 
@@ -151,6 +221,12 @@ private:
 	uint32 m_path;
 
 	int32 m_insertionCount;
+
+	b2WideTreeNode* m_wideNodes;
+	int32 m_wideNodeCount;
+	int32 m_wideNodeCapacity;
+	bool m_wideLayout;
+	bool m_wideDirty;
 };
 
 inline void* b2DynamicTree::GetUserData(int32 proxyId) const
@@ -165,9 +241,68 @@ inline const b2AABB& b2DynamicTree::GetFatAABB(int32 proxyId) const
 	return m_nodes[proxyId].aabb;
 }
 
+inline bool b2DynamicTree::IsWideLayoutCurrent() const
+{
+	return m_wideLayout && m_wideDirty == false;
+}
+
+inline bool b2IsWideTreeLeaf(int32 child)
+{
+	return child < b2_nullNode;
+}
+
+inline int32 b2GetWideTreeProxy(int32 child)
+{
+	return -2 - child;
+}
+
+#if B2_WIDE_SSE2
+#define b2_treePacketSize 4
+#define b2TreePacketFloat b2FloatW4
+#else
+#define b2_treePacketSize 1
+#define b2TreePacketFloat b2FloatW1
+#endif
+
+// Lane bits of the boxes that overlap an AABB, same test as b2TestOverlap.
+template <typename F>
+inline int32 b2OverlapBitsW(F lowerX, F lowerY, F upperX, F upperY, const b2AABB& aabb)
+{
+	return b2MaskBitsW(b2AndW(
+		b2AndW(b2GreaterEqualW(upperX, F::Splat(aabb.lowerBound.x)), b2GreaterEqualW(F::Splat(aabb.upperBound.x), lowerX)),
+		b2AndW(b2GreaterEqualW(upperY, F::Splat(aabb.lowerBound.y)), b2GreaterEqualW(F::Splat(aabb.upperBound.y), lowerY))));
+}
+
+// Lane bits of the rays that pass through a box between fraction 0 and their max fraction.
+// invX and invY are the reciprocals of the ray directions.
+template <typename F>
+inline int32 b2RayBitsW(F lowerX, F lowerY, F upperX, F upperY, F rayX, F rayY, F invX, F invY, F maxT)
+{
+	F tx1 = (lowerX - rayX) * invX;
+	F tx2 = (upperX - rayX) * invX;
+	F ty1 = (lowerY - rayY) * invY;
+	F ty2 = (upperY - rayY) * invY;
+	F tEnter = b2MaxW(b2MaxW(b2MinW(tx1, tx2), b2MinW(ty1, ty2)), F::Splat(0.0f));
+	F tExit = b2MinW(b2MinW(b2MaxW(tx1, tx2), b2MaxW(ty1, ty2)), maxT);
+	return b2MaskBitsW(b2GreaterEqualW(tExit, tEnter));
+}
+
+// The reciprocal of a ray direction component. A huge finite slope stands in for infinity,
+// so a ray starting on a slab plane gives 0 rather than NaN.
+inline float32 b2RayInverse(float32 d)
+{
+	return d != 0.0f ? 1.0f / d : b2_maxFloat;
+}
+
 template <typename T>
 inline void b2DynamicTree::Query(T* callback, const b2AABB& aabb) const
 {
+	if (IsWideLayoutCurrent())
+	{
+		QueryWide(callback, aabb);
+		return;
+	}
+
 	b2GrowableStack<int32, 256> stack;
 	stack.Push(m_root);
 
@@ -203,6 +338,12 @@ inline void b2DynamicTree::Query(T* callback, const b2AABB& aabb) const
 template <typename T>
 inline void b2DynamicTree::RayCast(T* callback, const b2RayCastInput& input) const
 {
+	if (IsWideLayoutCurrent())
+	{
+		RayCastWide(callback, input);
+		return;
+	}
+
 	b2Vec2 p1 = input.p1;
 	b2Vec2 p2 = input.p2;
 	b2Vec2 r = p2 - p1;
@@ -286,4 +427,407 @@ inline void b2DynamicTree::RayCast(T* callback, const b2RayCastInput& input) con
 	}
 }
 
+template <typename T>
+inline void b2DynamicTree::QueryBatch(T* callback, const b2AABB* aabbs, int32 count) const
+{
+	for (int32 i = 0; i < count; i += b2_treePacketSize)
+	{
+		QueryPacket<b2TreePacketFloat, b2_treePacketSize>(callback, aabbs, i, b2Min(count - i, b2_treePacketSize));
+	}
+}
+
+template <typename T>
+inline void b2DynamicTree::RayCastBatch(T* callback, const b2RayCastInput* inputs, int32 count) const
+{
+	for (int32 i = 0; i < count; i += b2_treePacketSize)
+	{
+		RayCastPacket<b2TreePacketFloat, b2_treePacketSize>(callback, inputs, i, b2Min(count - i, b2_treePacketSize));
+	}
+}
+
+template <typename T>
+inline void b2DynamicTree::QueryWide(T* callback, const b2AABB& aabb) const
+{
+	if (m_wideNodeCount == 0)
+	{
+		return;
+	}
+
+	b2GrowableStack<int32, 256> stack;
+	stack.Push(0);
+
+	while (stack.GetCount() > 0)
+	{
+		const b2WideTreeNode* node = m_wideNodes + stack.Pop();
+
+		int32 bits = 0;
+		for (int32 i = 0; i < 4; i += b2_treePacketSize)
+		{
+			bits |= b2OverlapBitsW(b2TreePacketFloat::Load(node->lowerX + i), b2TreePacketFloat::Load(node->lowerY + i),
+				b2TreePacketFloat::Load(node->upperX + i), b2TreePacketFloat::Load(node->upperY + i), aabb) << i;
+		}
+
+		for (int32 i = 0; i < node->count; ++i)
+		{
+			if ((bits & (1 << i)) == 0)
+			{
+				continue;
+			}
+
+			int32 child = node->children[i];
+			if (b2IsWideTreeLeaf(child) == false)
+			{
+				stack.Push(child);
+				continue;
+			}
+
+			bool proceed = callback->QueryCallback(b2GetWideTreeProxy(child));
+			if (proceed == false)
+			{
+				return;
+			}
+		}
+	}
+}
+
+// Same as RayCast, except each child is tested with a slab test against the ray from 0 to
+// the max fraction, which is tighter than the segment AABB and separating axis tests.
+template <typename T>
+inline void b2DynamicTree::RayCastWide(T* callback, const b2RayCastInput& input) const
+{
+	if (m_wideNodeCount == 0)
+	{
+		return;
+	}
+
+	b2Vec2 d = input.p2 - input.p1;
+	b2Assert(d.LengthSquared() > 0.0f);
+
+	b2TreePacketFloat rayX = b2TreePacketFloat::Splat(input.p1.x);
+	b2TreePacketFloat rayY = b2TreePacketFloat::Splat(input.p1.y);
+	b2TreePacketFloat invX = b2TreePacketFloat::Splat(b2RayInverse(d.x));
+	b2TreePacketFloat invY = b2TreePacketFloat::Splat(b2RayInverse(d.y));
+	float32 maxFraction = input.maxFraction;
+
+	b2GrowableStack<int32, 256> stack;
+	stack.Push(0);
+
+	while (stack.GetCount() > 0)
+	{
+		const b2WideTreeNode* node = m_wideNodes + stack.Pop();
+
+		b2TreePacketFloat maxT = b2TreePacketFloat::Splat(maxFraction);
+		int32 bits = 0;
+		for (int32 i = 0; i < 4; i += b2_treePacketSize)
+		{
+			bits |= b2RayBitsW(b2TreePacketFloat::Load(node->lowerX + i), b2TreePacketFloat::Load(node->lowerY + i),
+				b2TreePacketFloat::Load(node->upperX + i), b2TreePacketFloat::Load(node->upperY + i),
+				rayX, rayY, invX, invY, maxT) << i;
+		}
+
+		for (int32 i = 0; i < node->count; ++i)
+		{
+			if ((bits & (1 << i)) == 0)
+			{
+				continue;
+			}
+
+			int32 child = node->children[i];
+			if (b2IsWideTreeLeaf(child) == false)
+			{
+				stack.Push(child);
+				continue;
+			}
+
+			b2RayCastInput subInput;
+			subInput.p1 = input.p1;
+			subInput.p2 = input.p2;
+			subInput.maxFraction = maxFraction;
+
+			float32 value = callback->RayCastCallback(subInput, b2GetWideTreeProxy(child));
+
+			if (value == 0.0f)
+			{
+				// The client has terminated the ray cast.
+				return;
+			}
+
+			if (value > 0.0f)
+			{
+				maxFraction = value;
+			}
+		}
+	}
+}
+
+// Reports a leaf to the queries of a packet whose lane bits are set. Returns true if a query
+// was stopped, it then gets an inverted box that overlaps nothing.
+template <typename T>
+inline bool b2DynamicTree::QueryPacketLeaf(T* callback, int32 first, int32 count, int32 proxyId, int32 bits,
+	float32* lowerX, float32* lowerY, float32* upperX, float32* upperY, int32* activeCount) const
+{
+	bool stopped = false;
+	for (int32 i = 0; i < count; ++i)
+	{
+		if ((bits & (1 << i)) == 0)
+		{
+			continue;
+		}
+
+		bool proceed = callback->QueryCallback(proxyId, first + i);
+		if (proceed == false)
+		{
+			lowerX[i] = lowerY[i] = b2_maxFloat;
+			upperX[i] = upperY[i] = -b2_maxFloat;
+			--(*activeCount);
+			stopped = true;
+		}
+	}
+
+	return stopped;
+}
+
+// Queries up to W AABBs together, lanes past count get an inverted box.
+template <typename F, int32 W, typename T>
+inline void b2DynamicTree::QueryPacket(T* callback, const b2AABB* aabbs, int32 first, int32 count) const
+{
+	float32 lowerX[W], lowerY[W], upperX[W], upperY[W];
+	for (int32 i = 0; i < W; ++i)
+	{
+		if (i < count)
+		{
+			const b2AABB& aabb = aabbs[first + i];
+			lowerX[i] = aabb.lowerBound.x;
+			lowerY[i] = aabb.lowerBound.y;
+			upperX[i] = aabb.upperBound.x;
+			upperY[i] = aabb.upperBound.y;
+		}
+		else
+		{
+			lowerX[i] = lowerY[i] = b2_maxFloat;
+			upperX[i] = upperY[i] = -b2_maxFloat;
+		}
+	}
+
+	F qLowerX = F::Load(lowerX);
+	F qLowerY = F::Load(lowerY);
+	F qUpperX = F::Load(upperX);
+	F qUpperY = F::Load(upperY);
+	int32 activeCount = count;
+
+	b2GrowableStack<int32, 256> stack;
+	if (IsWideLayoutCurrent())
+	{
+		if (m_wideNodeCount > 0)
+		{
+			stack.Push(0);
+		}
+
+		while (stack.GetCount() > 0 && activeCount > 0)
+		{
+			const b2WideTreeNode* node = m_wideNodes + stack.Pop();
+			for (int32 c = 0; c < node->count; ++c)
+			{
+				b2AABB child;
+				child.lowerBound.Set(node->lowerX[c], node->lowerY[c]);
+				child.upperBound.Set(node->upperX[c], node->upperY[c]);
+				int32 bits = b2OverlapBitsW(qLowerX, qLowerY, qUpperX, qUpperY, child);
+				if (bits == 0)
+				{
+					continue;
+				}
+
+				if (b2IsWideTreeLeaf(node->children[c]) == false)
+				{
+					stack.Push(node->children[c]);
+				}
+				else if (QueryPacketLeaf(callback, first, count, b2GetWideTreeProxy(node->children[c]), bits,
+					lowerX, lowerY, upperX, upperY, &activeCount))
+				{
+					qLowerX = F::Load(lowerX);
+					qLowerY = F::Load(lowerY);
+					qUpperX = F::Load(upperX);
+					qUpperY = F::Load(upperY);
+				}
+			}
+		}
+
+		return;
+	}
+
+	stack.Push(m_root);
+
+	while (stack.GetCount() > 0 && activeCount > 0)
+	{
+		int32 nodeId = stack.Pop();
+		if (nodeId == b2_nullNode)
+		{
+			continue;
+		}
+
+		const b2TreeNode* node = m_nodes + nodeId;
+
+		int32 bits = b2OverlapBitsW(qLowerX, qLowerY, qUpperX, qUpperY, node->aabb);
+		if (bits == 0)
+		{
+			continue;
+		}
+
+		if (node->IsLeaf() == false)
+		{
+			stack.Push(node->child1);
+			stack.Push(node->child2);
+		}
+		else if (QueryPacketLeaf(callback, first, count, nodeId, bits, lowerX, lowerY, upperX, upperY, &activeCount))
+		{
+			qLowerX = F::Load(lowerX);
+			qLowerY = F::Load(lowerY);
+			qUpperX = F::Load(upperX);
+			qUpperY = F::Load(upperY);
+		}
+	}
+}
+
+// Reports a leaf to the rays of a packet whose lane bits are set, and clips or terminates
+// them by what the callback returns. Returns true if a max fraction changed.
+template <typename T>
+inline bool b2DynamicTree::RayCastPacketLeaf(T* callback, const b2RayCastInput* inputs, int32 first, int32 count,
+	int32 proxyId, int32 bits, float32* maxFractions, int32* activeCount) const
+{
+	bool clipped = false;
+	for (int32 i = 0; i < count; ++i)
+	{
+		if ((bits & (1 << i)) == 0)
+		{
+			continue;
+		}
+
+		const b2RayCastInput& input = inputs[first + i];
+		b2RayCastInput subInput;
+		subInput.p1 = input.p1;
+		subInput.p2 = input.p2;
+		subInput.maxFraction = maxFractions[i];
+
+		float32 value = callback->RayCastCallback(subInput, proxyId, first + i);
+
+		if (value == 0.0f)
+		{
+			// The client has terminated this ray.
+			maxFractions[i] = -1.0f;
+			--(*activeCount);
+			clipped = true;
+		}
+		else if (value > 0.0f)
+		{
+			maxFractions[i] = value;
+			clipped = true;
+		}
+	}
+
+	return clipped;
+}
+
+// Casts up to W rays together. Each node is tested with a slab test against the segment of each
+// ray from 0 to its max fraction, which is tighter than the segment AABB and separating axis tests
+// of RayCast. Lanes past count, and rays the callback terminated, get a max fraction of -1.
+template <typename F, int32 W, typename T>
+inline void b2DynamicTree::RayCastPacket(T* callback, const b2RayCastInput* inputs, int32 first, int32 count) const
+{
+	float32 p1X[W], p1Y[W], invDX[W], invDY[W], maxFractions[W];
+	for (int32 i = 0; i < W; ++i)
+	{
+		if (i < count)
+		{
+			const b2RayCastInput& input = inputs[first + i];
+			b2Vec2 d = input.p2 - input.p1;
+			b2Assert(d.LengthSquared() > 0.0f);
+			p1X[i] = input.p1.x;
+			p1Y[i] = input.p1.y;
+			invDX[i] = b2RayInverse(d.x);
+			invDY[i] = b2RayInverse(d.y);
+			maxFractions[i] = input.maxFraction;
+		}
+		else
+		{
+			p1X[i] = p1Y[i] = 0.0f;
+			invDX[i] = invDY[i] = 1.0f;
+			maxFractions[i] = -1.0f;
+		}
+	}
+
+	F rayX = F::Load(p1X);
+	F rayY = F::Load(p1Y);
+	F invX = F::Load(invDX);
+	F invY = F::Load(invDY);
+	F maxT = F::Load(maxFractions);
+	int32 activeCount = count;
+
+	b2GrowableStack<int32, 256> stack;
+	if (IsWideLayoutCurrent())
+	{
+		if (m_wideNodeCount > 0)
+		{
+			stack.Push(0);
+		}
+
+		while (stack.GetCount() > 0 && activeCount > 0)
+		{
+			const b2WideTreeNode* node = m_wideNodes + stack.Pop();
+			for (int32 c = 0; c < node->count; ++c)
+			{
+				int32 bits = b2RayBitsW(F::Splat(node->lowerX[c]), F::Splat(node->lowerY[c]),
+					F::Splat(node->upperX[c]), F::Splat(node->upperY[c]), rayX, rayY, invX, invY, maxT);
+				if (bits == 0)
+				{
+					continue;
+				}
+
+				if (b2IsWideTreeLeaf(node->children[c]) == false)
+				{
+					stack.Push(node->children[c]);
+				}
+				else if (RayCastPacketLeaf(callback, inputs, first, count, b2GetWideTreeProxy(node->children[c]), bits, maxFractions, &activeCount))
+				{
+					maxT = F::Load(maxFractions);
+				}
+			}
+		}
+
+		return;
+	}
+
+	stack.Push(m_root);
+
+	while (stack.GetCount() > 0 && activeCount > 0)
+	{
+		int32 nodeId = stack.Pop();
+		if (nodeId == b2_nullNode)
+		{
+			continue;
+		}
+
+		const b2TreeNode* node = m_nodes + nodeId;
+
+		int32 bits = b2RayBitsW(F::Splat(node->aabb.lowerBound.x), F::Splat(node->aabb.lowerBound.y),
+			F::Splat(node->aabb.upperBound.x), F::Splat(node->aabb.upperBound.y), rayX, rayY, invX, invY, maxT);
+		if (bits == 0)
+		{
+			continue;
+		}
+
+		if (node->IsLeaf() == false)
+		{
+			stack.Push(node->child1);
+			stack.Push(node->child2);
+		}
+		else if (RayCastPacketLeaf(callback, inputs, first, count, nodeId, bits, maxFractions, &activeCount))
+		{
+			maxT = F::Load(maxFractions);
+		}
+	}
+}
+
+#undef b2_treePacketSize
+#undef b2TreePacketFloat
+
 #endif
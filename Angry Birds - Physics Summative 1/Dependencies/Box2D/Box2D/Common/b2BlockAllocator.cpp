@@ -17,6 +17,7 @@
 */
 
 #include <Box2D/Common/b2BlockAllocator.h>
+#include <Box2D/Common/b2Math.h>
 #include <limits.h>
 #include <string.h>
 #include <stddef.h>
@@ -58,10 +59,14 @@ b2BlockAllocator::b2BlockAllocator()
 
 	m_chunkSpace = b2_chunkArrayIncrement;
 	m_chunkCount = 0;
+	m_spareChunkCount = 0;
 	m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
 	
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 	memset(m_freeLists, 0, sizeof(m_freeLists));
+	memset(m_liveCounts, 0, sizeof(m_liveCounts));
+	memset(m_peakCounts, 0, sizeof(m_peakCounts));
+	memset(m_chunkCounts, 0, sizeof(m_chunkCounts));
 
 	if (s_blockSizeLookupInitialized == false)
 	{
@@ -86,7 +91,7 @@ b2BlockAllocator::b2BlockAllocator()
 
 b2BlockAllocator::~b2BlockAllocator()
 {
-	for (int32 i = 0; i < m_chunkCount; ++i)
+	for (int32 i = 0; i < m_chunkCount + m_spareChunkCount; ++i)
 	{
 		b2Free(m_chunks[i].blocks);
 	}
@@ -109,6 +114,9 @@ void* b2BlockAllocator::Allocate(int32 size)
 	int32 index = s_blockSizeLookup[size];
 	b2Assert(0 <= index && index < b2_blockSizes);
 
+	++m_liveCounts[index];
+	m_peakCounts[index] = b2Max(m_peakCounts[index], m_liveCounts[index]);
+
 	if (m_freeLists[index])
 	{
 		b2Block* block = m_freeLists[index];
@@ -117,18 +125,27 @@ void* b2BlockAllocator::Allocate(int32 size)
 	}
 	else
 	{
-		if (m_chunkCount == m_chunkSpace)
+		b2Chunk* chunk = m_chunks + m_chunkCount;
+		if (m_spareChunkCount > 0)
 		{
-			b2Chunk* oldChunks = m_chunks;
-			m_chunkSpace += b2_chunkArrayIncrement;
-			m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
-			memcpy(m_chunks, oldChunks, m_chunkCount * sizeof(b2Chunk));
-			memset(m_chunks + m_chunkCount, 0, b2_chunkArrayIncrement * sizeof(b2Chunk));
-			b2Free(oldChunks);
+			// Carve a chunk kept by Reset.
+			--m_spareChunkCount;
 		}
+		else
+		{
+			if (m_chunkCount == m_chunkSpace)
+			{
+				b2Chunk* oldChunks = m_chunks;
+				m_chunkSpace += b2_chunkArrayIncrement;
+				m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
+				memcpy(m_chunks, oldChunks, m_chunkCount * sizeof(b2Chunk));
+				memset(m_chunks + m_chunkCount, 0, b2_chunkArrayIncrement * sizeof(b2Chunk));
+				b2Free(oldChunks);
+				chunk = m_chunks + m_chunkCount;
+			}
 
-		b2Chunk* chunk = m_chunks + m_chunkCount;
-		chunk->blocks = (b2Block*)b2Alloc(b2_chunkSize);
+			chunk->blocks = (b2Block*)b2Alloc(b2_chunkSize);
+		}
 #if defined(_DEBUG)
 		memset(chunk->blocks, 0xcd, b2_chunkSize);
 #endif
@@ -147,6 +164,7 @@ void* b2BlockAllocator::Allocate(int32 size)
 
 		m_freeLists[index] = chunk->blocks->next;
 		++m_chunkCount;
+		++m_chunkCounts[index];
 
 		return chunk->blocks;
 	}
@@ -196,6 +214,9 @@ void b2BlockAllocator::Free(void* p, int32 size)
 	memset(p, 0xfd, blockSize);
 #endif
 
+	b2Assert(m_liveCounts[index] > 0);
+	--m_liveCounts[index];
+
 	b2Block* block = (b2Block*)p;
 	block->next = m_freeLists[index];
 	m_freeLists[index] = block;
@@ -203,13 +224,60 @@ void b2BlockAllocator::Free(void* p, int32 size)
 
 void b2BlockAllocator::Clear()
 {
-	for (int32 i = 0; i < m_chunkCount; ++i)
+	for (int32 i = 0; i < m_chunkCount + m_spareChunkCount; ++i)
 	{
 		b2Free(m_chunks[i].blocks);
 	}
 
 	m_chunkCount = 0;
+	m_spareChunkCount = 0;
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 
 	memset(m_freeLists, 0, sizeof(m_freeLists));
+	memset(m_liveCounts, 0, sizeof(m_liveCounts));
+	memset(m_chunkCounts, 0, sizeof(m_chunkCounts));
+}
+
+void b2BlockAllocator::Reset()
+{
+	m_spareChunkCount += m_chunkCount;
+	m_chunkCount = 0;
+
+	memset(m_freeLists, 0, sizeof(m_freeLists));
+	memset(m_liveCounts, 0, sizeof(m_liveCounts));
+	memset(m_chunkCounts, 0, sizeof(m_chunkCounts));
+}
+
+int32 b2BlockAllocator::GetSizeClassCount() const
+{
+	return b2_blockSizes;
+}
+
+int32 b2BlockAllocator::GetBlockSize(int32 sizeClass) const
+{
+	b2Assert(0 <= sizeClass && sizeClass < b2_blockSizes);
+	return s_blockSizes[sizeClass];
+}
+
+int32 b2BlockAllocator::GetLiveCount(int32 sizeClass) const
+{
+	b2Assert(0 <= sizeClass && sizeClass < b2_blockSizes);
+	return m_liveCounts[sizeClass];
+}
+
+int32 b2BlockAllocator::GetPeakCount(int32 sizeClass) const
+{
+	b2Assert(0 <= sizeClass && sizeClass < b2_blockSizes);
+	return m_peakCounts[sizeClass];
+}
+
+int32 b2BlockAllocator::GetChunkCount(int32 sizeClass) const
+{
+	b2Assert(0 <= sizeClass && sizeClass < b2_blockSizes);
+	return m_chunkCounts[sizeClass];
+}
+
+int32 b2BlockAllocator::GetSpareChunkCount() const
+{
+	return m_spareChunkCount;
 }
@@ -46,14 +46,43 @@ public:
 
 	void Clear();
 
+	/// Free every block at once. The chunks are kept and carved into blocks of any size
+	/// again as they are needed. Memory larger than b2_maxBlockSize is not freed.
+	void Reset();
+
+	/// Get the number of block sizes. Statistics are kept for each of them.
+	int32 GetSizeClassCount() const;
+
+	/// Get the block size of a size class.
+	int32 GetBlockSize(int32 sizeClass) const;
+
+	/// Get the number of blocks of a size class in use.
+	int32 GetLiveCount(int32 sizeClass) const;
+
+	/// Get the most blocks of a size class that were in use at once, over all resets.
+	int32 GetPeakCount(int32 sizeClass) const;
+
+	/// Get the number of chunks carved into blocks of a size class.
+	int32 GetChunkCount(int32 sizeClass) const;
+
+	/// Get the number of chunks kept by Reset that were not carved again yet.
+	int32 GetSpareChunkCount() const;
+
 private:
 
 	b2Chunk* m_chunks;
 	int32 m_chunkCount;
 	int32 m_chunkSpace;
 
+	// The chunks after m_chunkCount that were kept by Reset.
+	int32 m_spareChunkCount;
+
 	b2Block* m_freeLists[b2_blockSizes];
 
+	int32 m_liveCounts[b2_blockSizes];
+	int32 m_peakCounts[b2_blockSizes];
+	int32 m_chunkCounts[b2_blockSizes];
+
 	static int32 s_blockSizes[b2_blockSizes];
 	static uint8 s_blockSizeLookup[b2_maxBlockSize + 1];
 	static bool s_blockSizeLookupInitialized;
@@ -80,6 +80,10 @@ typedef double float64;
 /// Making it larger may create artifacts for vertex collision.
 #define b2_polygonRadius		(2.0f * b2_linearSlop)
 
+/// With speculative contacts, shapes closer than this get contact points on top of the
+/// distance their bodies can close in one step. This is in meters.
+#define b2_speculativeDistance	(4.0f * b2_linearSlop)
+
 /// Maximum number of sub-steps per contact in continuous physics simulation.
 #define b2_maxSubSteps			8
 
@@ -117,6 +121,17 @@ typedef double float64;
 #define b2_baumgarte				0.2f
 #define b2_toiBaugarte				0.75f
 
+/// The stiffness of contacts in the soft step solver, in Hertz. It is capped at a quarter
+/// of the sub-step rate.
+#define b2_contactHertz				30.0f
+
+/// The damping ratio of contacts in the soft step solver. Contacts are heavily over-damped
+/// so overlap is removed without bounce.
+#define b2_contactDampingRatio		10.0f
+
+/// The fastest the soft step solver pushes overlapping shapes apart, in meters per second.
+#define b2_contactPushVelocity		3.0f
+
 
 // Sleep
 
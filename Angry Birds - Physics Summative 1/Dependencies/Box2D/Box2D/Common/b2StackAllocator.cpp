@@ -19,9 +19,14 @@
 #include <Box2D/Common/b2StackAllocator.h>
 #include <Box2D/Common/b2Math.h>
 
-b2StackAllocator::b2StackAllocator()
+b2StackAllocator::b2StackAllocator(int32 initialSize)
 {
+	b2Assert(initialSize >= 0);
+	m_capacity = initialSize;
+	m_data = m_capacity > 0 ? (char*)b2Alloc(m_capacity) : NULL;
 	m_index = 0;
+	m_spillCount = 0;
+	m_spillSize = 0;
 	m_allocation = 0;
 	m_maxAllocation = 0;
 	m_entryCount = 0;
@@ -31,18 +36,24 @@ b2StackAllocator::~b2StackAllocator()
 {
 	b2Assert(m_index == 0);
 	b2Assert(m_entryCount == 0);
+	b2Free(m_data);
 }
 
 void* b2StackAllocator::Allocate(int32 size)
 {
 	b2Assert(m_entryCount < b2_maxStackEntries);
 
+	// Keep the next block aligned.
+	size = (size + b2_stackAlignment - 1) & ~(b2_stackAlignment - 1);
+
 	b2StackEntry* entry = m_entries + m_entryCount;
 	entry->size = size;
-	if (m_index + size > b2_stackSize)
+	if (m_index + size > m_capacity)
 	{
 		entry->data = (char*)b2Alloc(size);
 		entry->usedMalloc = true;
+		++m_spillCount;
+		m_spillSize += size;
 	}
 	else
 	{
@@ -75,9 +86,44 @@ void b2StackAllocator::Free(void* p)
 	--m_entryCount;
 
 	p = NULL;
+
+	// The arena is unused now, grow it to the high-water mark.
+	if (m_entryCount == 0 && m_maxAllocation > m_capacity)
+	{
+		int32 capacity = b2Max(m_capacity, 1024);
+		while (capacity < m_maxAllocation)
+		{
+			capacity *= 2;
+		}
+
+		b2Free(m_data);
+		m_data = (char*)b2Alloc(capacity);
+		m_capacity = capacity;
+	}
 }
 
 int32 b2StackAllocator::GetMaxAllocation() const
 {
 	return m_maxAllocation;
 }
+
+int32 b2StackAllocator::GetCapacity() const
+{
+	return m_capacity;
+}
+
+int32 b2StackAllocator::GetSpillCount() const
+{
+	return m_spillCount;
+}
+
+int32 b2StackAllocator::GetSpillSize() const
+{
+	return m_spillSize;
+}
+
+void b2StackAllocator::ResetSpillStats()
+{
+	m_spillCount = 0;
+	m_spillSize = 0;
+}
@@ -21,8 +21,9 @@
 
 #include <Box2D/Common/b2Settings.h>
 
-const int32 b2_stackSize = 100 * 1024;	// 100k
+const int32 b2_stackSize = 100 * 1024;	// 100k, the default initial arena size
 const int32 b2_maxStackEntries = 32;
+const int32 b2_stackAlignment = 16;	// block size granularity, a power of two
 
 struct b2StackEntry
 {
@@ -34,10 +35,14 @@ struct b2StackEntry
 // This is a stack allocator used for fast per step allocations.
 // You must nest allocate/free pairs. The code will assert
 // if you try to interleave multiple allocate/free pairs.
+// Sizes are rounded up to b2_stackAlignment, so every block is as aligned as the blocks
+// b2Alloc returns. Allocations that don't fit in the arena spill to b2Alloc. Once every
+// allocation is freed, the arena is grown by doubling until it holds the largest total
+// seen, so a scene only spills until its high-water mark was reached once.
 class b2StackAllocator
 {
 public:
-	b2StackAllocator();
+	b2StackAllocator(int32 initialSize = b2_stackSize);
 	~b2StackAllocator();
 
 	void* Allocate(int32 size);
@@ -45,11 +50,24 @@ public:
 
 	int32 GetMaxAllocation() const;
 
+	/// Get the size of the arena in bytes.
+	int32 GetCapacity() const;
+
+	/// Get the number and the total size of the allocations that spilled to b2Alloc
+	/// since the last call to ResetSpillStats.
+	int32 GetSpillCount() const;
+	int32 GetSpillSize() const;
+	void ResetSpillStats();
+
 private:
 
-	char m_data[b2_stackSize];
+	char* m_data;
+	int32 m_capacity;
 	int32 m_index;
 
+	int32 m_spillCount;
+	int32 m_spillSize;
+
 	int32 m_allocation;
 	int32 m_maxAllocation;
 
@@ -0,0 +1,55 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_TASK_SCHEDULER_H
+#define B2_TASK_SCHEDULER_H
+
+#include <Box2D/Common/b2Settings.h>
+
+/// The most threads a task scheduler can run the world's tasks on.
+#define b2_maxTaskThreads	64
+
+/// A range of work that a task scheduler splits up and runs on several threads.
+class b2Task
+{
+public:
+	virtual ~b2Task() {}
+
+	/// Process the items [begin, end). The thread index is in [0, thread count) and no two
+	/// threads running the same task at the same time share an index, so it can be used to
+	/// select per-thread scratch memory. Index 0 is the thread that called ParallelFor.
+	virtual void Execute(int32 begin, int32 end, int32 threadIndex) = 0;
+};
+
+/// Implement this to run the world's parallel work on your own job system, or use b2ThreadPool.
+/// The world only calls ParallelFor from inside b2World::Step, and the results of a step do not
+/// depend on how the items are split between threads.
+class b2TaskScheduler
+{
+public:
+	virtual ~b2TaskScheduler() {}
+
+	/// The number of threads that may execute tasks, including the calling thread.
+	virtual int32 GetThreadCount() const = 0;
+
+	/// Run the task over the items [0, count) in ranges of at least minRange items, and return
+	/// once every item has been processed.
+	virtual void ParallelFor(b2Task* task, int32 count, int32 minRange) = 0;
+};
+
+#endif
@@ -0,0 +1,224 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2ThreadPool.h>
+#include <Box2D/Common/b2Math.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// How many ranges each thread is dealt per ParallelFor. More ranges balance uneven work
+// better, fewer cost less locking.
+const int32 b2_rangesPerThread = 4;
+
+// The ranges dealt to one thread for the current ParallelFor. The owner takes ranges
+// from the head and thieves take them from the tail.
+struct b2RangeQueue
+{
+	std::mutex mutex;
+	int32 head;
+	int32 tail;
+};
+
+struct b2ThreadPoolData
+{
+	std::vector<std::thread> workers;
+	b2RangeQueue* queues;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	uint32 generation;
+	int32 busyWorkers;
+	bool shutdown;
+
+	// The current ParallelFor.
+	b2Task* task;
+	int32 count;
+	int32 rangeSize;
+};
+
+b2ThreadPool::b2ThreadPool(int32 threadCount)
+{
+	if (threadCount <= 0)
+	{
+		threadCount = b2Max(int32(std::thread::hardware_concurrency()), 1);
+	}
+	m_threadCount = b2Min(threadCount, b2_maxTaskThreads);
+
+	m_data = new b2ThreadPoolData;
+	m_data->queues = new b2RangeQueue[m_threadCount];
+	for (int32 i = 0; i < m_threadCount; ++i)
+	{
+		m_data->queues[i].head = 0;
+		m_data->queues[i].tail = 0;
+	}
+	m_data->generation = 0;
+	m_data->busyWorkers = 0;
+	m_data->shutdown = false;
+	m_data->task = NULL;
+	m_data->count = 0;
+	m_data->rangeSize = 1;
+
+	// Thread 0 is whoever calls ParallelFor.
+	m_data->workers.reserve(m_threadCount - 1);
+	for (int32 i = 1; i < m_threadCount; ++i)
+	{
+		m_data->workers.push_back(std::thread(&b2ThreadPool::WorkerMain, this, i));
+	}
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_data->mutex);
+		m_data->shutdown = true;
+	}
+	m_data->wake.notify_all();
+
+	for (size_t i = 0; i < m_data->workers.size(); ++i)
+	{
+		m_data->workers[i].join();
+	}
+
+	delete [] m_data->queues;
+	delete m_data;
+}
+
+int32 b2ThreadPool::GetThreadCount() const
+{
+	return m_threadCount;
+}
+
+void b2ThreadPool::ParallelFor(b2Task* task, int32 count, int32 minRange)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	minRange = b2Max(minRange, 1);
+	if (m_threadCount == 1 || count <= minRange)
+	{
+		task->Execute(0, count, 0);
+		return;
+	}
+
+	// Deal contiguous runs of ranges to each thread. The workers are all waiting
+	// for the next generation, so the queues can be filled without locking them.
+	int32 rangeTarget = m_threadCount * b2_rangesPerThread;
+	int32 rangeSize = b2Max(minRange, (count + rangeTarget - 1) / rangeTarget);
+	int32 rangeCount = (count + rangeSize - 1) / rangeSize;
+	for (int32 i = 0; i < m_threadCount; ++i)
+	{
+		m_data->queues[i].head = i * rangeCount / m_threadCount;
+		m_data->queues[i].tail = (i + 1) * rangeCount / m_threadCount;
+	}
+
+	m_data->task = task;
+	m_data->count = count;
+	m_data->rangeSize = rangeSize;
+
+	{
+		std::lock_guard<std::mutex> lock(m_data->mutex);
+		m_data->busyWorkers = int32(m_data->workers.size());
+		++m_data->generation;
+	}
+	m_data->wake.notify_all();
+
+	RunRanges(0);
+
+	// Workers still running their last range have to finish before the task goes away.
+	std::unique_lock<std::mutex> lock(m_data->mutex);
+	while (m_data->busyWorkers > 0)
+	{
+		m_data->done.wait(lock);
+	}
+	m_data->task = NULL;
+}
+
+void b2ThreadPool::WorkerMain(int32 threadIndex)
+{
+	uint32 generation = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_data->mutex);
+			while (m_data->shutdown == false && m_data->generation == generation)
+			{
+				m_data->wake.wait(lock);
+			}
+
+			if (m_data->shutdown)
+			{
+				return;
+			}
+
+			generation = m_data->generation;
+		}
+
+		RunRanges(threadIndex);
+
+		std::lock_guard<std::mutex> lock(m_data->mutex);
+		if (--m_data->busyWorkers == 0)
+		{
+			m_data->done.notify_one();
+		}
+	}
+}
+
+void b2ThreadPool::RunRanges(int32 threadIndex)
+{
+	for (;;)
+	{
+		int32 range = -1;
+
+		// Take the next range from our own queue.
+		{
+			b2RangeQueue* queue = m_data->queues + threadIndex;
+			std::lock_guard<std::mutex> lock(queue->mutex);
+			if (queue->head < queue->tail)
+			{
+				range = queue->head++;
+			}
+		}
+
+		// Otherwise steal the last range of another thread. Queues only shrink during a
+		// ParallelFor, so once every queue is empty the work is done.
+		for (int32 i = 1; i < m_threadCount && range == -1; ++i)
+		{
+			b2RangeQueue* queue = m_data->queues + (threadIndex + i) % m_threadCount;
+			std::lock_guard<std::mutex> lock(queue->mutex);
+			if (queue->head < queue->tail)
+			{
+				range = --queue->tail;
+			}
+		}
+
+		if (range == -1)
+		{
+			return;
+		}
+
+		int32 begin = range * m_data->rangeSize;
+		int32 end = b2Min(begin + m_data->rangeSize, m_data->count);
+		m_data->task->Execute(begin, end, threadIndex);
+	}
+}
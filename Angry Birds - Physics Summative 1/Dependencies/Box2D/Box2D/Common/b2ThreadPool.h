@@ -0,0 +1,57 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_THREAD_POOL_H
+#define B2_THREAD_POOL_H
+
+#include <Box2D/Common/b2TaskScheduler.h>
+
+struct b2ThreadPoolData;
+
+/// A work-stealing thread pool. ParallelFor splits the items into ranges and deals them out to
+/// one queue per thread. Each thread works through its own queue from the front and, once it is
+/// empty, steals ranges from the back of the other queues.
+class b2ThreadPool : public b2TaskScheduler
+{
+public:
+	/// Create a pool that runs tasks on threadCount threads: the calling thread plus
+	/// threadCount - 1 workers. A count of 0 uses one thread per hardware thread.
+	/// The count is limited to b2_maxTaskThreads.
+	explicit b2ThreadPool(int32 threadCount = 0);
+
+	/// Stops and joins the workers.
+	~b2ThreadPool();
+
+	/// @see b2TaskScheduler::GetThreadCount
+	int32 GetThreadCount() const;
+
+	/// @see b2TaskScheduler::ParallelFor
+	void ParallelFor(b2Task* task, int32 count, int32 minRange);
+
+private:
+	b2ThreadPool(const b2ThreadPool&);
+	b2ThreadPool& operator=(const b2ThreadPool&);
+
+	void WorkerMain(int32 threadIndex);
+	void RunRanges(int32 threadIndex);
+
+	b2ThreadPoolData* m_data;
+	int32 m_threadCount;
+};
+
+#endif
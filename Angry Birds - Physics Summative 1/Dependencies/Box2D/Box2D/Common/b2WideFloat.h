@@ -0,0 +1,112 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_WIDE_FLOAT_H
+#define B2_WIDE_FLOAT_H
+
+#include <Box2D/Common/b2Settings.h>
+#include <math.h>
+
+// Lane types for the solver loops that process several bodies or constraints at a time. The
+// loops are templates over the lane type, so b2FloatW1 runs exactly the same float operations
+// as b2FloatW4 and gives bit identical results. It is also the fallback for CPUs without SSE2.
+//
+// A lane type F has F::Splat, F::Load, b2StoreW, the arithmetic operators, b2MinW, b2MaxW,
+// b2SqrtW, and comparisons returning F::Mask, which works with b2AndW, b2OrW and b2SelectW.
+// b2MaskBitsW packs a mask into one bit per lane, lane 0 in bit 0.
+// b2MinW and b2MaxW match b2Min and b2Max, they return the second operand when the comparison
+// fails.
+//
+// This header is only for code built for the default instruction set. Code built for AVX2
+// defines its own lane types, see b2WideContactSolverAVX2.cpp.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define B2_WIDE_SSE2 1
+#include <emmintrin.h>
+#else
+#define B2_WIDE_SSE2 0
+#endif
+
+/// One lane.
+struct b2MaskW1
+{
+	bool v;
+};
+
+struct b2FloatW1
+{
+	typedef b2MaskW1 Mask;
+
+	static b2FloatW1 Splat(float32 x) { b2FloatW1 r = { x }; return r; }
+	static b2FloatW1 Load(const float32* p) { b2FloatW1 r = { *p }; return r; }
+
+	float32 v;
+};
+
+inline void b2StoreW(b2FloatW1 a, float32* p) { *p = a.v; }
+inline b2FloatW1 operator + (b2FloatW1 a, b2FloatW1 b) { b2FloatW1 r = { a.v + b.v }; return r; }
+inline b2FloatW1 operator - (b2FloatW1 a, b2FloatW1 b) { b2FloatW1 r = { a.v - b.v }; return r; }
+inline b2FloatW1 operator * (b2FloatW1 a, b2FloatW1 b) { b2FloatW1 r = { a.v * b.v }; return r; }
+inline b2FloatW1 operator / (b2FloatW1 a, b2FloatW1 b) { b2FloatW1 r = { a.v / b.v }; return r; }
+inline b2FloatW1 operator - (b2FloatW1 a) { b2FloatW1 r = { -a.v }; return r; }
+inline b2FloatW1 b2MinW(b2FloatW1 a, b2FloatW1 b) { b2FloatW1 r = { a.v < b.v ? a.v : b.v }; return r; }
+inline b2FloatW1 b2MaxW(b2FloatW1 a, b2FloatW1 b) { b2FloatW1 r = { a.v > b.v ? a.v : b.v }; return r; }
+inline b2FloatW1 b2SqrtW(b2FloatW1 a) { b2FloatW1 r = { sqrtf(a.v) }; return r; }
+inline b2MaskW1 b2GreaterW(b2FloatW1 a, b2FloatW1 b) { b2MaskW1 r = { a.v > b.v }; return r; }
+inline b2MaskW1 b2GreaterEqualW(b2FloatW1 a, b2FloatW1 b) { b2MaskW1 r = { a.v >= b.v }; return r; }
+inline b2MaskW1 b2AndW(b2MaskW1 a, b2MaskW1 b) { b2MaskW1 r = { a.v && b.v }; return r; }
+inline b2MaskW1 b2OrW(b2MaskW1 a, b2MaskW1 b) { b2MaskW1 r = { a.v || b.v }; return r; }
+inline b2FloatW1 b2SelectW(b2MaskW1 m, b2FloatW1 a, b2FloatW1 b) { return m.v ? a : b; }
+inline int32 b2MaskBitsW(b2MaskW1 m) { return m.v ? 1 : 0; }
+
+#if B2_WIDE_SSE2
+
+/// Four lanes with SSE2.
+struct b2FloatW4
+{
+	typedef b2FloatW4 Mask;
+
+	static b2FloatW4 Splat(float32 x) { b2FloatW4 r = { _mm_set1_ps(x) }; return r; }
+	static b2FloatW4 Load(const float32* p) { b2FloatW4 r = { _mm_loadu_ps(p) }; return r; }
+
+	__m128 v;
+};
+
+inline void b2StoreW(b2FloatW4 a, float32* p) { _mm_storeu_ps(p, a.v); }
+inline b2FloatW4 operator + (b2FloatW4 a, b2FloatW4 b) { b2FloatW4 r = { _mm_add_ps(a.v, b.v) }; return r; }
+inline b2FloatW4 operator - (b2FloatW4 a, b2FloatW4 b) { b2FloatW4 r = { _mm_sub_ps(a.v, b.v) }; return r; }
+inline b2FloatW4 operator * (b2FloatW4 a, b2FloatW4 b) { b2FloatW4 r = { _mm_mul_ps(a.v, b.v) }; return r; }
+inline b2FloatW4 operator / (b2FloatW4 a, b2FloatW4 b) { b2FloatW4 r = { _mm_div_ps(a.v, b.v) }; return r; }
+inline b2FloatW4 operator - (b2FloatW4 a) { b2FloatW4 r = { _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)) }; return r; }
+inline b2FloatW4 b2MinW(b2FloatW4 a, b2FloatW4 b) { b2FloatW4 r = { _mm_min_ps(a.v, b.v) }; return r; }
+inline b2FloatW4 b2MaxW(b2FloatW4 a, b2FloatW4 b) { b2FloatW4 r = { _mm_max_ps(a.v, b.v) }; return r; }
+inline b2FloatW4 b2SqrtW(b2FloatW4 a) { b2FloatW4 r = { _mm_sqrt_ps(a.v) }; return r; }
+inline b2FloatW4 b2GreaterW(b2FloatW4 a, b2FloatW4 b) { b2FloatW4 r = { _mm_cmpgt_ps(a.v, b.v) }; return r; }
+inline b2FloatW4 b2GreaterEqualW(b2FloatW4 a, b2FloatW4 b) { b2FloatW4 r = { _mm_cmpge_ps(a.v, b.v) }; return r; }
+inline b2FloatW4 b2AndW(b2FloatW4 a, b2FloatW4 b) { b2FloatW4 r = { _mm_and_ps(a.v, b.v) }; return r; }
+inline b2FloatW4 b2OrW(b2FloatW4 a, b2FloatW4 b) { b2FloatW4 r = { _mm_or_ps(a.v, b.v) }; return r; }
+inline b2FloatW4 b2SelectW(b2FloatW4 m, b2FloatW4 a, b2FloatW4 b)
+{
+	b2FloatW4 r = { _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)) };
+	return r;
+}
+inline int32 b2MaskBitsW(b2FloatW4 m) { return _mm_movemask_ps(m.v); }
+
+#endif
+
+#endif
@@ -19,8 +19,6 @@
 #include <Box2D/Dynamics/Contacts/b2ChainAndCircleContact.h>
 #include <Box2D/Common/b2BlockAllocator.h>
 #include <Box2D/Dynamics/b2Fixture.h>
-#include <Box2D/Collision/Shapes/b2ChainShape.h>
-#include <Box2D/Collision/Shapes/b2EdgeShape.h>
 
 #include <new>
 
@@ -37,17 +35,8 @@ void b2ChainAndCircleContact::Destroy(b2Contact* contact, b2BlockAllocator* allo
 }
 
 b2ChainAndCircleContact::b2ChainAndCircleContact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB)
-: b2Contact(fixtureA, indexA, fixtureB, indexB)
+: b2Contact(fixtureA, indexA, fixtureB, indexB, e_chainAndCircleContact)
 {
 	b2Assert(m_fixtureA->GetType() == b2Shape::e_chain);
 	b2Assert(m_fixtureB->GetType() == b2Shape::e_circle);
 }
-
-void b2ChainAndCircleContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
-{
-	b2ChainShape* chain = (b2ChainShape*)m_fixtureA->GetShape();
-	b2EdgeShape edge;
-	chain->GetChildEdge(&edge, m_indexA);
-	b2CollideEdgeAndCircle(	manifold, &edge, xfA,
-							(b2CircleShape*)m_fixtureB->GetShape(), xfB);
-}
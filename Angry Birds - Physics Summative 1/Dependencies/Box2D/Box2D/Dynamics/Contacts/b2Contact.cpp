@@ -34,74 +34,92 @@
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2World.h>
 
-b2ContactRegister b2Contact::s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
-bool b2Contact::s_initialized = false;
-
-void b2Contact::InitializeRegisters()
+b2ContactType b2Contact::GetType(b2Shape::Type typeA, b2Shape::Type typeB)
 {
-	AddType(b2CircleContact::Create, b2CircleContact::Destroy, b2Shape::e_circle, b2Shape::e_circle);
-	AddType(b2PolygonAndCircleContact::Create, b2PolygonAndCircleContact::Destroy, b2Shape::e_polygon, b2Shape::e_circle);
-	AddType(b2PolygonContact::Create, b2PolygonContact::Destroy, b2Shape::e_polygon, b2Shape::e_polygon);
-	AddType(b2EdgeAndCircleContact::Create, b2EdgeAndCircleContact::Destroy, b2Shape::e_edge, b2Shape::e_circle);
-	AddType(b2EdgeAndPolygonContact::Create, b2EdgeAndPolygonContact::Destroy, b2Shape::e_edge, b2Shape::e_polygon);
-	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, b2Shape::e_chain, b2Shape::e_circle);
-	AddType(b2ChainAndPolygonContact::Create, b2ChainAndPolygonContact::Destroy, b2Shape::e_chain, b2Shape::e_polygon);
-}
+	b2Assert(0 <= typeA && typeA < b2Shape::e_typeCount);
+	b2Assert(0 <= typeB && typeB < b2Shape::e_typeCount);
 
-void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destoryFcn,
-						b2Shape::Type type1, b2Shape::Type type2)
-{
-	b2Assert(0 <= type1 && type1 < b2Shape::e_typeCount);
-	b2Assert(0 <= type2 && type2 < b2Shape::e_typeCount);
-	
-	s_registers[type1][type2].createFcn = createFcn;
-	s_registers[type1][type2].destroyFcn = destoryFcn;
-	s_registers[type1][type2].primary = true;
-
-	if (type1 != type2)
+	switch (typeA)
 	{
-		s_registers[type2][type1].createFcn = createFcn;
-		s_registers[type2][type1].destroyFcn = destoryFcn;
-		s_registers[type2][type1].primary = false;
+	case b2Shape::e_circle:
+		return typeB == b2Shape::e_circle ? e_circleContact : e_nullContact;
+
+	case b2Shape::e_polygon:
+		if (typeB == b2Shape::e_circle)
+		{
+			return e_polygonAndCircleContact;
+		}
+		return typeB == b2Shape::e_polygon ? e_polygonContact : e_nullContact;
+
+	case b2Shape::e_edge:
+		if (typeB == b2Shape::e_circle)
+		{
+			return e_edgeAndCircleContact;
+		}
+		return typeB == b2Shape::e_polygon ? e_edgeAndPolygonContact : e_nullContact;
+
+	case b2Shape::e_chain:
+		if (typeB == b2Shape::e_circle)
+		{
+			return e_chainAndCircleContact;
+		}
+		return typeB == b2Shape::e_polygon ? e_chainAndPolygonContact : e_nullContact;
+
+	default:
+		return e_nullContact;
 	}
 }
 
 b2Contact* b2Contact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator)
 {
-	if (s_initialized == false)
-	{
-		InitializeRegisters();
-		s_initialized = true;
-	}
-
-	b2Shape::Type type1 = fixtureA->GetType();
-	b2Shape::Type type2 = fixtureB->GetType();
+	b2Shape::Type typeA = fixtureA->GetType();
+	b2Shape::Type typeB = fixtureB->GetType();
 
-	b2Assert(0 <= type1 && type1 < b2Shape::e_typeCount);
-	b2Assert(0 <= type2 && type2 < b2Shape::e_typeCount);
-	
-	b2ContactCreateFcn* createFcn = s_registers[type1][type2].createFcn;
-	if (createFcn)
+	// The contact classes take their shapes in a fixed order, swap the fixtures to match it.
+	b2ContactType type = GetType(typeA, typeB);
+	if (type == e_nullContact)
 	{
-		if (s_registers[type1][type2].primary)
-		{
-			return createFcn(fixtureA, indexA, fixtureB, indexB, allocator);
-		}
-		else
+		type = GetType(typeB, typeA);
+		if (type == e_nullContact)
 		{
-			return createFcn(fixtureB, indexB, fixtureA, indexA, allocator);
+			return NULL;
 		}
+
+		b2Swap(fixtureA, fixtureB);
+		b2Swap(indexA, indexB);
 	}
-	else
+
+	switch (type)
 	{
+	case e_circleContact:
+		return b2CircleContact::Create(fixtureA, indexA, fixtureB, indexB, allocator);
+
+	case e_polygonAndCircleContact:
+		return b2PolygonAndCircleContact::Create(fixtureA, indexA, fixtureB, indexB, allocator);
+
+	case e_polygonContact:
+		return b2PolygonContact::Create(fixtureA, indexA, fixtureB, indexB, allocator);
+
+	case e_edgeAndCircleContact:
+		return b2EdgeAndCircleContact::Create(fixtureA, indexA, fixtureB, indexB, allocator);
+
+	case e_edgeAndPolygonContact:
+		return b2EdgeAndPolygonContact::Create(fixtureA, indexA, fixtureB, indexB, allocator);
+
+	case e_chainAndCircleContact:
+		return b2ChainAndCircleContact::Create(fixtureA, indexA, fixtureB, indexB, allocator);
+
+	case e_chainAndPolygonContact:
+		return b2ChainAndPolygonContact::Create(fixtureA, indexA, fixtureB, indexB, allocator);
+
+	default:
+		b2Assert(false);
 		return NULL;
 	}
 }
 
 void b2Contact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
 {
-	b2Assert(s_initialized == true);
-
 	b2Fixture* fixtureA = contact->m_fixtureA;
 	b2Fixture* fixtureB = contact->m_fixtureB;
 
@@ -113,19 +131,46 @@ void b2Contact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
 		fixtureB->GetBody()->SetAwake(true);
 	}
 
-	b2Shape::Type typeA = fixtureA->GetType();
-	b2Shape::Type typeB = fixtureB->GetType();
+	switch (contact->m_type)
+	{
+	case e_circleContact:
+		b2CircleContact::Destroy(contact, allocator);
+		break;
+
+	case e_polygonAndCircleContact:
+		b2PolygonAndCircleContact::Destroy(contact, allocator);
+		break;
+
+	case e_polygonContact:
+		b2PolygonContact::Destroy(contact, allocator);
+		break;
+
+	case e_edgeAndCircleContact:
+		b2EdgeAndCircleContact::Destroy(contact, allocator);
+		break;
+
+	case e_edgeAndPolygonContact:
+		b2EdgeAndPolygonContact::Destroy(contact, allocator);
+		break;
+
+	case e_chainAndCircleContact:
+		b2ChainAndCircleContact::Destroy(contact, allocator);
+		break;
 
-	b2Assert(0 <= typeA && typeB < b2Shape::e_typeCount);
-	b2Assert(0 <= typeA && typeB < b2Shape::e_typeCount);
+	case e_chainAndPolygonContact:
+		b2ChainAndPolygonContact::Destroy(contact, allocator);
+		break;
 
-	b2ContactDestroyFcn* destroyFcn = s_registers[typeA][typeB].destroyFcn;
-	destroyFcn(contact, allocator);
+	default:
+		b2Assert(false);
+		break;
+	}
 }
 
-b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
+b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB, b2ContactType type)
 {
 	m_flags = e_enabledFlag;
+	m_type = type;
 
 	m_fixtureA = fA;
 	m_fixtureB = fB;
@@ -148,7 +193,12 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 	m_nodeB.next = NULL;
 	m_nodeB.other = NULL;
 
+	m_island = NULL;
+	m_islandPrev = NULL;
+	m_islandNext = NULL;
+
 	m_toiCount = 0;
+	m_toiIndex = b2_nullTOIIndex;
 
 	m_friction = b2MixFriction(m_fixtureA->m_friction, m_fixtureB->m_friction);
 	m_restitution = b2MixRestitution(m_fixtureA->m_restitution, m_fixtureB->m_restitution);
@@ -160,74 +210,137 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 // Note: do not assume the fixture AABBs are overlapping or are valid.
 void b2Contact::Update(b2ContactListener* listener)
 {
-	b2Manifold oldManifold = m_manifold;
-
-	// Re-enable this contact.
-	m_flags |= e_enabledFlag;
+	b2Manifold oldManifold;
+	bool wasTouching;
+	UpdateManifold(&oldManifold, &wasTouching, 0.0f);
+	ReportUpdate(&oldManifold, wasTouching, listener);
+}
 
-	bool touching = false;
-	bool wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
+// How far a point of the fixture can be from the body's center of mass, from the fixture's AABB.
+static float32 b2FixtureReach(const b2Fixture* fixture, int32 childIndex, const b2Vec2& center)
+{
+	const b2AABB& aabb = fixture->GetAABB(childIndex);
+	b2Vec2 d = b2Max(b2Abs(aabb.lowerBound - center), b2Abs(aabb.upperBound - center));
+	return d.Length();
+}
 
-	bool sensorA = m_fixtureA->IsSensor();
-	bool sensorB = m_fixtureB->IsSensor();
-	bool sensor = sensorA || sensorB;
+// Bound the distance the two fixtures can close in the given time at the current velocities.
+float32 b2Contact::ComputeSpeculativeDistance(float32 speculativeTime) const
+{
+	const b2Body* bodyA = m_fixtureA->GetBody();
+	const b2Body* bodyB = m_fixtureB->GetBody();
 
-	b2Body* bodyA = m_fixtureA->GetBody();
-	b2Body* bodyB = m_fixtureB->GetBody();
-	const b2Transform& xfA = bodyA->GetTransform();
-	const b2Transform& xfB = bodyB->GetTransform();
+	float32 speed = b2Distance(bodyA->GetLinearVelocity(), bodyB->GetLinearVelocity());
 
-	// Is this contact a sensor?
-	if (sensor)
+	float32 wA = bodyA->GetAngularVelocity();
+	if (wA != 0.0f)
 	{
-		const b2Shape* shapeA = m_fixtureA->GetShape();
-		const b2Shape* shapeB = m_fixtureB->GetShape();
-		touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB);
+		speed += b2Abs(wA) * b2FixtureReach(m_fixtureA, m_indexA, bodyA->GetWorldCenter());
+	}
 
-		// Sensors don't generate manifolds.
-		m_manifold.pointCount = 0;
+	float32 wB = bodyB->GetAngularVelocity();
+	if (wB != 0.0f)
+	{
+		speed += b2Abs(wB) * b2FixtureReach(m_fixtureB, m_indexB, bodyB->GetWorldCenter());
 	}
-	else
+
+	return b2_speculativeDistance + speculativeTime * speed;
+}
+
+void b2Contact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB, float32 speculativeDistance)
+{
+	switch (m_type)
 	{
-		Evaluate(&m_manifold, xfA, xfB);
-		touching = m_manifold.pointCount > 0;
+	case e_circleContact:
+		((b2CircleContact*)this)->Evaluate(manifold, xfA, xfB, speculativeDistance);
+		break;
 
-		// Match old contact ids to new contact ids and copy the
-		// stored impulses to warm start the solver.
-		for (int32 i = 0; i < m_manifold.pointCount; ++i)
-		{
-			b2ManifoldPoint* mp2 = m_manifold.points + i;
-			mp2->normalImpulse = 0.0f;
-			mp2->tangentImpulse = 0.0f;
-			b2ContactID id2 = mp2->id;
-
-			for (int32 j = 0; j < oldManifold.pointCount; ++j)
-			{
-				b2ManifoldPoint* mp1 = oldManifold.points + j;
-
-				if (mp1->id.key == id2.key)
-				{
-					mp2->normalImpulse = mp1->normalImpulse;
-					mp2->tangentImpulse = mp1->tangentImpulse;
-					break;
-				}
-			}
-		}
+	case e_polygonAndCircleContact:
+		((b2PolygonAndCircleContact*)this)->Evaluate(manifold, xfA, xfB, speculativeDistance);
+		break;
 
-		if (touching != wasTouching)
-		{
-			bodyA->SetAwake(true);
-			bodyB->SetAwake(true);
-		}
+	case e_polygonContact:
+		((b2PolygonContact*)this)->Evaluate(manifold, xfA, xfB, speculativeDistance);
+		break;
+
+	case e_edgeAndCircleContact:
+		((b2EdgeAndCircleContact*)this)->Evaluate(manifold, xfA, xfB, speculativeDistance);
+		break;
+
+	case e_edgeAndPolygonContact:
+		((b2EdgeAndPolygonContact*)this)->Evaluate(manifold, xfA, xfB, speculativeDistance);
+		break;
+
+	case e_chainAndCircleContact:
+		((b2ChainAndCircleContact*)this)->Evaluate(manifold, xfA, xfB, speculativeDistance);
+		break;
+
+	case e_chainAndPolygonContact:
+		((b2ChainAndPolygonContact*)this)->Evaluate(manifold, xfA, xfB, speculativeDistance);
+		break;
+
+	default:
+		b2Assert(false);
+		break;
 	}
+}
+
+bool b2Contact::TestSensorOverlap() const
+{
+	const b2Shape* shapeA = m_fixtureA->GetShape();
+	const b2Shape* shapeB = m_fixtureB->GetShape();
+	const b2Transform& xfA = m_fixtureA->GetBody()->GetTransform();
+	const b2Transform& xfB = m_fixtureB->GetBody()->GetTransform();
+	return b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB);
+}
 
-	if (touching)
+void b2Contact::UpdateManifold(b2Manifold* oldManifold, bool* wasTouching, float32 speculativeTime)
+{
+	switch (m_type)
 	{
-		m_flags |= e_touchingFlag;
+	case e_circleContact:
+		UpdateManifold<b2CircleContact>(oldManifold, wasTouching, speculativeTime);
+		break;
+
+	case e_polygonAndCircleContact:
+		UpdateManifold<b2PolygonAndCircleContact>(oldManifold, wasTouching, speculativeTime);
+		break;
+
+	case e_polygonContact:
+		UpdateManifold<b2PolygonContact>(oldManifold, wasTouching, speculativeTime);
+		break;
+
+	case e_edgeAndCircleContact:
+		UpdateManifold<b2EdgeAndCircleContact>(oldManifold, wasTouching, speculativeTime);
+		break;
+
+	case e_edgeAndPolygonContact:
+		UpdateManifold<b2EdgeAndPolygonContact>(oldManifold, wasTouching, speculativeTime);
+		break;
+
+	case e_chainAndCircleContact:
+		UpdateManifold<b2ChainAndCircleContact>(oldManifold, wasTouching, speculativeTime);
+		break;
+
+	case e_chainAndPolygonContact:
+		UpdateManifold<b2ChainAndPolygonContact>(oldManifold, wasTouching, speculativeTime);
+		break;
+
+	default:
+		b2Assert(false);
+		break;
 	}
-	else
+}
+
+void b2Contact::ReportUpdate(const b2Manifold* oldManifold, bool wasTouching, b2ContactListener* listener)
+{
+	bool touching = (m_flags & e_touchingFlag) == e_touchingFlag;
+	bool sensor = m_fixtureA->IsSensor() || m_fixtureB->IsSensor();
+
+	if (sensor == false && touching != wasTouching)
 	{
-		m_flags &= ~e_touchingFlag;
+		m_fixtureA->GetBody()->SetAwake(true);
+		m_fixtureB->GetBody()->SetAwake(true);
 	}
 
 	if (wasTouching == false && touching == true && listener)
@@ -242,6 +355,6 @@ void b2Contact::Update(b2ContactListener* listener)
 
 	if (sensor == false && touching && listener)
 	{
-		listener->PreSolve(this, &oldManifold);
+		listener->PreSolve(this, oldManifold);
 	}
 }
@@ -23,6 +23,7 @@
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Collision/Shapes/b2Shape.h>
 #include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/b2TOIQueue.h>
 
 class b2Body;
 class b2Contact;
@@ -31,6 +32,7 @@ class b2World;
 class b2BlockAllocator;
 class b2StackAllocator;
 class b2ContactListener;
+struct b2PersistentIsland;
 
 /// Friction mixing law. The idea is to allow either fixture to drive the restitution to zero.
 /// For example, anything slides on ice.
@@ -46,16 +48,19 @@ inline float32 b2MixRestitution(float32 restitution1, float32 restitution2)
 	return restitution1 > restitution2 ? restitution1 : restitution2;
 }
 
-typedef b2Contact* b2ContactCreateFcn(	b2Fixture* fixtureA, int32 indexA,
-										b2Fixture* fixtureB, int32 indexB,
-										b2BlockAllocator* allocator);
-typedef void b2ContactDestroyFcn(b2Contact* contact, b2BlockAllocator* allocator);
-
-struct b2ContactRegister
+/// The shape pair of a contact. Each type has its own contact class, which takes the
+/// shapes in the order of its name.
+enum b2ContactType
 {
-	b2ContactCreateFcn* createFcn;
-	b2ContactDestroyFcn* destroyFcn;
-	bool primary;
+	e_circleContact,
+	e_polygonAndCircleContact,
+	e_polygonContact,
+	e_edgeAndCircleContact,
+	e_edgeAndPolygonContact,
+	e_chainAndCircleContact,
+	e_chainAndPolygonContact,
+	e_contactTypeCount,
+	e_nullContact = e_contactTypeCount
 };
 
 /// A contact edge is used to connect bodies and contacts together
@@ -141,11 +146,18 @@ public:
 	/// Get the desired tangent speed. In meters per second.
 	float32 GetTangentSpeed() const;
 
-	/// Evaluate this contact with your own manifold and transforms.
-	virtual void Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB) = 0;
+	/// Get the shape pair type of this contact.
+	b2ContactType GetType() const;
+
+	/// Evaluate this contact with your own manifold and transforms. Points up to
+	/// speculativeDistance apart are kept, pass zero for touching points only.
+	void Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB, float32 speculativeDistance);
 
 protected:
 	friend class b2ContactManager;
+	friend class b2IslandManager;
+	friend class b2TOIQueue;
+	friend class b2NarrowPhaseTask;
 	friend class b2World;
 	friend class b2ContactSolver;
 	friend class b2Body;
@@ -176,23 +188,35 @@ protected:
 	/// Flag this contact for filtering. Filtering will occur the next time step.
 	void FlagForFiltering();
 
-	static void AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destroyFcn,
-						b2Shape::Type typeA, b2Shape::Type typeB);
-	static void InitializeRegisters();
+	// The contact type of a shape pair in this order, e_nullContact if the shapes do not
+	// collide in this order.
+	static b2ContactType GetType(b2Shape::Type typeA, b2Shape::Type typeB);
 	static b2Contact* Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator);
-	static void Destroy(b2Contact* contact, b2Shape::Type typeA, b2Shape::Type typeB, b2BlockAllocator* allocator);
 	static void Destroy(b2Contact* contact, b2BlockAllocator* allocator);
 
-	b2Contact() : m_fixtureA(NULL), m_fixtureB(NULL) {}
-	b2Contact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
-	virtual ~b2Contact() {}
+	b2Contact() : m_type(e_nullContact), m_island(NULL), m_fixtureA(NULL), m_fixtureB(NULL), m_toiIndex(b2_nullTOIIndex) {}
+	b2Contact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2ContactType type);
+	~b2Contact() {}
 
 	void Update(b2ContactListener* listener);
 
-	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
-	static bool s_initialized;
+	// Update in two halves, so the contact manager can compute manifolds on several threads.
+	// UpdateManifold only writes to this contact. ReportUpdate wakes the bodies and calls
+	// the listener, so it must run on the stepping thread. With a positive speculativeTime
+	// the manifold keeps points the bodies could close on within that time.
+	void UpdateManifold(b2Manifold* oldManifold, bool* wasTouching, float32 speculativeTime);
+	void ReportUpdate(const b2Manifold* oldManifold, bool wasTouching, b2ContactListener* listener);
+
+	// UpdateManifold for a contact of class T. The manifold function is called directly, so
+	// the contact manager can update each contact type in its own loop.
+	template <typename T>
+	void UpdateManifold(b2Manifold* oldManifold, bool* wasTouching, float32 speculativeTime);
+
+	float32 ComputeSpeculativeDistance(float32 speculativeTime) const;
+	bool TestSensorOverlap() const;
 
 	uint32 m_flags;
+	b2ContactType m_type;
 
 	// World pool and list pointers.
 	b2Contact* m_prev;
@@ -202,6 +226,11 @@ protected:
 	b2ContactEdge m_nodeA;
 	b2ContactEdge m_nodeB;
 
+	// The persistent island of a solid, touching contact.
+	b2PersistentIsland* m_island;
+	b2Contact* m_islandPrev;
+	b2Contact* m_islandNext;
+
 	b2Fixture* m_fixtureA;
 	b2Fixture* m_fixtureB;
 
@@ -213,6 +242,9 @@ protected:
 	int32 m_toiCount;
 	float32 m_toi;
 
+	// Position in the TOI queue of the world, while the contact has a TOI event.
+	int32 m_toiIndex;
+
 	float32 m_friction;
 	float32 m_restitution;
 
@@ -261,6 +293,11 @@ inline bool b2Contact::IsTouching() const
 	return (m_flags & e_touchingFlag) == e_touchingFlag;
 }
 
+inline b2ContactType b2Contact::GetType() const
+{
+	return m_type;
+}
+
 inline b2Contact* b2Contact::GetNext()
 {
 	return m_next;
@@ -346,4 +383,69 @@ inline float32 b2Contact::GetTangentSpeed() const
 	return m_tangentSpeed;
 }
 
+template <typename T>
+inline void b2Contact::UpdateManifold(b2Manifold* oldManifold, bool* wasTouching, float32 speculativeTime)
+{
+	*oldManifold = m_manifold;
+
+	// Re-enable this contact.
+	m_flags |= e_enabledFlag;
+
+	bool touching = false;
+	*wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
+
+	// Is this contact a sensor?
+	if (m_fixtureA->IsSensor() || m_fixtureB->IsSensor())
+	{
+		touching = TestSensorOverlap();
+
+		// Sensors don't generate manifolds.
+		m_manifold.pointCount = 0;
+	}
+	else
+	{
+		float32 speculativeDistance = 0.0f;
+		if (speculativeTime > 0.0f)
+		{
+			speculativeDistance = ComputeSpeculativeDistance(speculativeTime);
+		}
+
+		const b2Transform& xfA = m_fixtureA->GetBody()->GetTransform();
+		const b2Transform& xfB = m_fixtureB->GetBody()->GetTransform();
+		((T*)this)->T::Evaluate(&m_manifold, xfA, xfB, speculativeDistance);
+		touching = m_manifold.pointCount > 0;
+
+		// Match old contact ids to new contact ids and copy the
+		// stored impulses to warm start the solver.
+		for (int32 i = 0; i < m_manifold.pointCount; ++i)
+		{
+			b2ManifoldPoint* mp2 = m_manifold.points + i;
+			mp2->normalImpulse = 0.0f;
+			mp2->tangentImpulse = 0.0f;
+			b2ContactID id2 = mp2->id;
+
+			for (int32 j = 0; j < oldManifold->pointCount; ++j)
+			{
+				b2ManifoldPoint* mp1 = oldManifold->points + j;
+
+				if (mp1->id.key == id2.key)
+				{
+					mp2->normalImpulse = mp1->normalImpulse;
+					mp2->tangentImpulse = mp1->tangentImpulse;
+					break;
+				}
+			}
+		}
+	}
+
+	if (touching)
+	{
+		m_flags |= e_touchingFlag;
+	}
+	else
+	{
+		m_flags &= ~e_touchingFlag;
+	}
+}
+
 #endif
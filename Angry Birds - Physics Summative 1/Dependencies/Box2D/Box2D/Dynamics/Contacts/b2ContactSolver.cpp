@@ -19,11 +19,14 @@
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Dynamics/Contacts/b2WideContactSolver.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2World.h>
 #include <Box2D/Common/b2StackAllocator.h>
 
+#include <string.h>
+
 // Solver debugging is normally disabled because the block solver sometimes has to deal with a poorly conditioned effective mass matrix.
 #define B2_DEBUG_SOLVER 0
 
@@ -54,6 +57,11 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 	m_positions = def->positions;
 	m_velocities = def->velocities;
 	m_contacts = def->contacts;
+	m_wideLanes = 0;
+	m_wideBundles = NULL;
+	m_wideBundleCount = 0;
+	m_wideOverflow = NULL;
+	m_wideOverflowCount = 0;
 
 	// Initialize position independent portions of the constraints.
 	for (int32 i = 0; i < m_count; ++i)
@@ -77,8 +85,8 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 		vc->friction = contact->m_friction;
 		vc->restitution = contact->m_restitution;
 		vc->tangentSpeed = contact->m_tangentSpeed;
-		vc->indexA = bodyA->m_islandIndex;
-		vc->indexB = bodyB->m_islandIndex;
+		vc->indexA = bodyA->GetIslandIndex(def->sharedSlots);
+		vc->indexB = bodyB->GetIslandIndex(def->sharedSlots);
 		vc->invMassA = bodyA->m_invMass;
 		vc->invMassB = bodyB->m_invMass;
 		vc->invIA = bodyA->m_invI;
@@ -89,8 +97,8 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 		vc->normalMass.SetZero();
 
 		b2ContactPositionConstraint* pc = m_positionConstraints + i;
-		pc->indexA = bodyA->m_islandIndex;
-		pc->indexB = bodyB->m_islandIndex;
+		pc->indexA = vc->indexA;
+		pc->indexB = vc->indexB;
 		pc->invMassA = bodyA->m_invMass;
 		pc->invMassB = bodyB->m_invMass;
 		pc->localCenterA = bodyA->m_sweep.localCenter;
@@ -133,6 +141,12 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 
 b2ContactSolver::~b2ContactSolver()
 {
+	if (m_wideLanes > 0)
+	{
+		m_allocator->Free(m_wideOverflow);
+		m_allocator->Free(m_wideBundles);
+	}
+
 	m_allocator->Free(m_velocityConstraints);
 	m_allocator->Free(m_positionConstraints);
 }
@@ -159,15 +173,15 @@ void b2ContactSolver::InitializeVelocityConstraints()
 		b2Vec2 localCenterA = pc->localCenterA;
 		b2Vec2 localCenterB = pc->localCenterB;
 
-		b2Vec2 cA = m_positions[indexA].c;
-		float32 aA = m_positions[indexA].a;
-		b2Vec2 vA = m_velocities[indexA].v;
-		float32 wA = m_velocities[indexA].w;
+		b2Vec2 cA = m_positions.GetCenter(indexA);
+		float32 aA = m_positions.a[indexA];
+		b2Vec2 vA = m_velocities.GetLinear(indexA);
+		float32 wA = m_velocities.w[indexA];
 
-		b2Vec2 cB = m_positions[indexB].c;
-		float32 aB = m_positions[indexB].a;
-		b2Vec2 vB = m_velocities[indexB].v;
-		float32 wB = m_velocities[indexB].w;
+		b2Vec2 cB = m_positions.GetCenter(indexB);
+		float32 aB = m_positions.a[indexB];
+		b2Vec2 vB = m_velocities.GetLinear(indexB);
+		float32 wB = m_velocities.w[indexB];
 
 		b2Assert(manifold->pointCount > 0);
 
@@ -209,7 +223,21 @@ void b2ContactSolver::InitializeVelocityConstraints()
 			// Setup a velocity bias for restitution.
 			vcp->velocityBias = 0.0f;
 			float32 vRel = b2Dot(vc->normal, vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA));
-			if (vRel < -b2_velocityThreshold)
+			float32 separation = worldManifold.separations[j];
+			if (m_step.speculativeContacts && separation > 0.0f)
+			{
+				// A speculative point. The bodies may close the gap in this step, but no more.
+				vcp->velocityBias = -separation * m_step.inv_dt;
+
+				// If they would hit within the step, bounce now. The approach speed is gone
+				// before they touch, so a later step never sees the impact. Without restitution
+				// the bodies just close the gap.
+				if (vc->restitution > 0.0f && vRel < vcp->velocityBias && vRel < -b2_velocityThreshold)
+				{
+					vcp->velocityBias = b2Max(vcp->velocityBias, -vc->restitution * vRel);
+				}
+			}
+			else if (vRel < -b2_velocityThreshold)
 			{
 				vcp->velocityBias = -vc->restitution * vRel;
 			}
@@ -247,6 +275,228 @@ void b2ContactSolver::InitializeVelocityConstraints()
 			}
 		}
 	}
+
+	if (m_step.wideContactLanes > 0 && m_count >= b2_minWideContacts)
+	{
+		PrepareWideConstraints(m_step.wideContactLanes);
+	}
+}
+
+template <int32 W>
+static void b2PackWideConstraint(b2WideContactBundle<W>* bundle, int32 lane, const b2ContactVelocityConstraint* vc, int32 index)
+{
+	bundle->constraintIndex[lane] = index;
+	bundle->indexA[lane] = vc->indexA;
+	bundle->indexB[lane] = vc->indexB;
+	bundle->invMassA[lane] = vc->invMassA;
+	bundle->invIA[lane] = vc->invIA;
+	bundle->invMassB[lane] = vc->invMassB;
+	bundle->invIB[lane] = vc->invIB;
+	bundle->normalX[lane] = vc->normal.x;
+	bundle->normalY[lane] = vc->normal.y;
+	bundle->friction[lane] = vc->friction;
+	bundle->tangentSpeed[lane] = vc->tangentSpeed;
+	bundle->blockSolve[lane] = vc->pointCount == 2 && g_blockSolve ? 1.0f : 0.0f;
+	bundle->Kexx[lane] = vc->K.ex.x;
+	bundle->Kexy[lane] = vc->K.ex.y;
+	bundle->Keyx[lane] = vc->K.ey.x;
+	bundle->Keyy[lane] = vc->K.ey.y;
+	bundle->normalMassExx[lane] = vc->normalMass.ex.x;
+	bundle->normalMassExy[lane] = vc->normalMass.ex.y;
+	bundle->normalMassEyx[lane] = vc->normalMass.ey.x;
+	bundle->normalMassEyy[lane] = vc->normalMass.ey.y;
+
+	// Points past the point count stay zero, so the wide solver skips them.
+	for (int32 j = 0; j < vc->pointCount; ++j)
+	{
+		const b2VelocityConstraintPoint* vcp = vc->points + j;
+		typename b2WideContactBundle<W>::Point* cp = bundle->points + j;
+		cp->rAx[lane] = vcp->rA.x;
+		cp->rAy[lane] = vcp->rA.y;
+		cp->rBx[lane] = vcp->rB.x;
+		cp->rBy[lane] = vcp->rB.y;
+		cp->normalImpulse[lane] = vcp->normalImpulse;
+		cp->tangentImpulse[lane] = vcp->tangentImpulse;
+		cp->normalMass[lane] = vcp->normalMass;
+		cp->tangentMass[lane] = vcp->tangentMass;
+		cp->velocityBias[lane] = vcp->velocityBias;
+	}
+}
+
+// Pack the coloured constraints into bundles, one colour after another. Returns the bundle count.
+template <int32 W>
+static int32 b2PackWideConstraints(void* memory, const b2ContactVelocityConstraint* constraints,
+	const int32* order, const int32* colorCounts)
+{
+	b2WideContactBundle<W>* bundles = (b2WideContactBundle<W>*)memory;
+	int32 bundleCount = 0;
+	int32 orderIndex = 0;
+	for (int32 c = 0; c < b2_wideColorCount; ++c)
+	{
+		for (int32 k = 0; k < colorCounts[c]; ++k)
+		{
+			int32 lane = k % W;
+			if (lane == 0)
+			{
+				b2WideContactBundle<W>* bundle = bundles + bundleCount;
+				memset(bundle, 0, sizeof(b2WideContactBundle<W>));
+				for (int32 l = 0; l < W; ++l)
+				{
+					bundle->constraintIndex[l] = -1;
+					bundle->indexA[l] = -1;
+					bundle->indexB[l] = -1;
+				}
+				++bundleCount;
+			}
+
+			int32 index = order[orderIndex++];
+			b2PackWideConstraint(bundles + bundleCount - 1, lane, constraints + index, index);
+		}
+	}
+
+	return bundleCount;
+}
+
+template <int32 W>
+static void b2UnpackWideImpulses(const void* memory, int32 bundleCount, b2ContactVelocityConstraint* constraints)
+{
+	const b2WideContactBundle<W>* bundles = (const b2WideContactBundle<W>*)memory;
+	for (int32 i = 0; i < bundleCount; ++i)
+	{
+		const b2WideContactBundle<W>* bundle = bundles + i;
+		for (int32 l = 0; l < W; ++l)
+		{
+			int32 index = bundle->constraintIndex[l];
+			if (index < 0)
+			{
+				continue;
+			}
+
+			b2ContactVelocityConstraint* vc = constraints + index;
+			for (int32 j = 0; j < vc->pointCount; ++j)
+			{
+				vc->points[j].normalImpulse = bundle->points[j].normalImpulse[l];
+				vc->points[j].tangentImpulse = bundle->points[j].tangentImpulse[l];
+			}
+		}
+	}
+}
+
+// Colour the constraints so that no two constraints of a colour share a dynamic body, then pack
+// each colour into bundles for the wide solver. Static and kinematic bodies are never written by
+// the solver, so they don't constrain the colouring. Constraints that don't fit in any colour
+// are solved one at a time after the bundles.
+void b2ContactSolver::PrepareWideConstraints(int32 lanes)
+{
+	int32 bodyCount = 0;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		bodyCount = b2Max(bodyCount, b2Max(vc->indexA, vc->indexB) + 1);
+	}
+
+	int32 bundleSize;
+	switch (lanes)
+	{
+	case 8:
+		bundleSize = sizeof(b2WideContactBundle<8>);
+		break;
+	case 4:
+		bundleSize = sizeof(b2WideContactBundle<4>);
+		break;
+	default:
+		lanes = 1;
+		bundleSize = sizeof(b2WideContactBundle<1>);
+		break;
+	}
+
+	// Each colour leaves at most one partly filled bundle.
+	int32 bundleCapacity = (m_count + lanes - 1) / lanes + b2_wideColorCount;
+	m_wideLanes = lanes;
+	m_wideBundles = m_allocator->Allocate(bundleCapacity * bundleSize);
+	m_wideOverflow = (int32*)m_allocator->Allocate(m_count * sizeof(int32));
+	m_wideOverflowCount = 0;
+
+	int32* colors = (int32*)m_allocator->Allocate(m_count * sizeof(int32));
+	uint32* bodyColors = (uint32*)m_allocator->Allocate(bodyCount * sizeof(uint32));
+	memset(bodyColors, 0, bodyCount * sizeof(uint32));
+
+	int32 colorCounts[b2_wideColorCount];
+	for (int32 c = 0; c < b2_wideColorCount; ++c)
+	{
+		colorCounts[c] = 0;
+	}
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		bool dynamicA = vc->invMassA > 0.0f || vc->invIA > 0.0f;
+		bool dynamicB = vc->invMassB > 0.0f || vc->invIB > 0.0f;
+		uint32 used = (dynamicA ? bodyColors[vc->indexA] : 0) | (dynamicB ? bodyColors[vc->indexB] : 0);
+
+		colors[i] = -1;
+		for (int32 c = 0; c < b2_wideColorCount; ++c)
+		{
+			if ((used & (1u << c)) == 0)
+			{
+				colors[i] = c;
+				break;
+			}
+		}
+
+		if (colors[i] == -1)
+		{
+			m_wideOverflow[m_wideOverflowCount++] = i;
+			continue;
+		}
+
+		if (dynamicA)
+		{
+			bodyColors[vc->indexA] |= 1u << colors[i];
+		}
+
+		if (dynamicB)
+		{
+			bodyColors[vc->indexB] |= 1u << colors[i];
+		}
+
+		++colorCounts[colors[i]];
+	}
+
+	// Sort the coloured constraints by colour, keeping their order within a colour.
+	int32 colorStarts[b2_wideColorCount];
+	int32 colored = 0;
+	for (int32 c = 0; c < b2_wideColorCount; ++c)
+	{
+		colorStarts[c] = colored;
+		colored += colorCounts[c];
+	}
+
+	m_allocator->Free(bodyColors);
+	int32* order = (int32*)m_allocator->Allocate(b2Max(colored, 1) * sizeof(int32));
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		if (colors[i] >= 0)
+		{
+			order[colorStarts[colors[i]]++] = i;
+		}
+	}
+
+	switch (m_wideLanes)
+	{
+	case 8:
+		m_wideBundleCount = b2PackWideConstraints<8>(m_wideBundles, m_velocityConstraints, order, colorCounts);
+		break;
+	case 4:
+		m_wideBundleCount = b2PackWideConstraints<4>(m_wideBundles, m_velocityConstraints, order, colorCounts);
+		break;
+	default:
+		m_wideBundleCount = b2PackWideConstraints<1>(m_wideBundles, m_velocityConstraints, order, colorCounts);
+		break;
+	}
+
+	m_allocator->Free(order);
+	m_allocator->Free(colors);
 }
 
 void b2ContactSolver::WarmStart()
@@ -264,10 +514,10 @@ void b2ContactSolver::WarmStart()
 		float32 iB = vc->invIB;
 		int32 pointCount = vc->pointCount;
 
-		b2Vec2 vA = m_velocities[indexA].v;
-		float32 wA = m_velocities[indexA].w;
-		b2Vec2 vB = m_velocities[indexB].v;
-		float32 wB = m_velocities[indexB].w;
+		b2Vec2 vA = m_velocities.GetLinear(indexA);
+		float32 wA = m_velocities.w[indexA];
+		b2Vec2 vB = m_velocities.GetLinear(indexB);
+		float32 wB = m_velocities.w[indexB];
 
 		b2Vec2 normal = vc->normal;
 		b2Vec2 tangent = b2Cross(normal, 1.0f);
@@ -282,40 +532,67 @@ void b2ContactSolver::WarmStart()
 			vB += mB * P;
 		}
 
-		m_velocities[indexA].v = vA;
-		m_velocities[indexA].w = wA;
-		m_velocities[indexB].v = vB;
-		m_velocities[indexB].w = wB;
+		m_velocities.SetLinear(indexA, vA);
+		m_velocities.w[indexA] = wA;
+		m_velocities.SetLinear(indexB, vB);
+		m_velocities.w[indexB] = wB;
 	}
 }
 
-void b2ContactSolver::SolveVelocityConstraints()
+// Solve one contact constraint with the scalar solver.
+static void b2SolveVelocityConstraint(b2ContactVelocityConstraint* vc, const b2Velocity& velocities)
 {
-	for (int32 i = 0; i < m_count; ++i)
+	int32 indexA = vc->indexA;
+	int32 indexB = vc->indexB;
+	float32 mA = vc->invMassA;
+	float32 iA = vc->invIA;
+	float32 mB = vc->invMassB;
+	float32 iB = vc->invIB;
+	int32 pointCount = vc->pointCount;
+
+	b2Vec2 vA = velocities.GetLinear(indexA);
+	float32 wA = velocities.w[indexA];
+	b2Vec2 vB = velocities.GetLinear(indexB);
+	float32 wB = velocities.w[indexB];
+
+	b2Vec2 normal = vc->normal;
+	b2Vec2 tangent = b2Cross(normal, 1.0f);
+	float32 friction = vc->friction;
+
+	b2Assert(pointCount == 1 || pointCount == 2);
+
+	// Solve tangent constraints first because non-penetration is more important
+	// than friction.
+	for (int32 j = 0; j < pointCount; ++j)
 	{
-		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		b2VelocityConstraintPoint* vcp = vc->points + j;
 
-		int32 indexA = vc->indexA;
-		int32 indexB = vc->indexB;
-		float32 mA = vc->invMassA;
-		float32 iA = vc->invIA;
-		float32 mB = vc->invMassB;
-		float32 iB = vc->invIB;
-		int32 pointCount = vc->pointCount;
+		// Relative velocity at contact
+		b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
 
-		b2Vec2 vA = m_velocities[indexA].v;
-		float32 wA = m_velocities[indexA].w;
-		b2Vec2 vB = m_velocities[indexB].v;
-		float32 wB = m_velocities[indexB].w;
+		// Compute tangent force
+		float32 vt = b2Dot(dv, tangent) - vc->tangentSpeed;
+		float32 lambda = vcp->tangentMass * (-vt);
 
-		b2Vec2 normal = vc->normal;
-		b2Vec2 tangent = b2Cross(normal, 1.0f);
-		float32 friction = vc->friction;
+		// b2Clamp the accumulated force
+		float32 maxFriction = friction * vcp->normalImpulse;
+		float32 newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
+		lambda = newImpulse - vcp->tangentImpulse;
+		vcp->tangentImpulse = newImpulse;
+
+		// Apply contact impulse
+		b2Vec2 P = lambda * tangent;
 
-		b2Assert(pointCount == 1 || pointCount == 2);
+		vA -= mA * P;
+		wA -= iA * b2Cross(vcp->rA, P);
 
-		// Solve tangent constraints first because non-penetration is more important
-		// than friction.
+		vB += mB * P;
+		wB += iB * b2Cross(vcp->rB, P);
+	}
+
+	// Solve normal constraints
+	if (pointCount == 1 || g_blockSolve == false)
+	{
 		for (int32 j = 0; j < pointCount; ++j)
 		{
 			b2VelocityConstraintPoint* vcp = vc->points + j;
@@ -323,286 +600,304 @@ void b2ContactSolver::SolveVelocityConstraints()
 			// Relative velocity at contact
 			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
 
-			// Compute tangent force
-			float32 vt = b2Dot(dv, tangent) - vc->tangentSpeed;
-			float32 lambda = vcp->tangentMass * (-vt);
+			// Compute normal impulse
+			float32 vn = b2Dot(dv, normal);
+			float32 lambda = -vcp->normalMass * (vn - vcp->velocityBias);
 
-			// b2Clamp the accumulated force
-			float32 maxFriction = friction * vcp->normalImpulse;
-			float32 newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
-			lambda = newImpulse - vcp->tangentImpulse;
-			vcp->tangentImpulse = newImpulse;
+			// b2Clamp the accumulated impulse
+			float32 newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
+			lambda = newImpulse - vcp->normalImpulse;
+			vcp->normalImpulse = newImpulse;
 
 			// Apply contact impulse
-			b2Vec2 P = lambda * tangent;
-
+			b2Vec2 P = lambda * normal;
 			vA -= mA * P;
 			wA -= iA * b2Cross(vcp->rA, P);
 
 			vB += mB * P;
 			wB += iB * b2Cross(vcp->rB, P);
 		}
-
-		// Solve normal constraints
-		if (pointCount == 1 || g_blockSolve == false)
-		{
-			for (int32 j = 0; j < pointCount; ++j)
-			{
-				b2VelocityConstraintPoint* vcp = vc->points + j;
-
-				// Relative velocity at contact
-				b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
-
-				// Compute normal impulse
-				float32 vn = b2Dot(dv, normal);
-				float32 lambda = -vcp->normalMass * (vn - vcp->velocityBias);
-
-				// b2Clamp the accumulated impulse
-				float32 newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
-				lambda = newImpulse - vcp->normalImpulse;
-				vcp->normalImpulse = newImpulse;
-
-				// Apply contact impulse
-				b2Vec2 P = lambda * normal;
-				vA -= mA * P;
-				wA -= iA * b2Cross(vcp->rA, P);
-
-				vB += mB * P;
-				wB += iB * b2Cross(vcp->rB, P);
-			}
-		}
-		else
+	}
+	else
+	{
+		// Block solver developed in collaboration with Dirk Gregorius (back in 01/07 on Box2D_Lite).
+		// Build the mini LCP for this contact patch
+		//
+		// vn = A * x + b, vn >= 0, x >= 0 and vn_i * x_i = 0 with i = 1..2
+		//
+		// A = J * W * JT and J = ( -n, -r1 x n, n, r2 x n )
+		// b = vn0 - velocityBias
+		//
+		// The system is solved using the "Total enumeration method" (s. Murty). The complementary constraint vn_i * x_i
+		// implies that we must have in any solution either vn_i = 0 or x_i = 0. So for the 2D contact problem the cases
+		// vn1 = 0 and vn2 = 0, x1 = 0 and x2 = 0, x1 = 0 and vn2 = 0, x2 = 0 and vn1 = 0 need to be tested. The first valid
+		// solution that satisfies the problem is chosen.
+		// 
+		// In order to account of the accumulated impulse 'a' (because of the iterative nature of the solver which only requires
+		// that the accumulated impulse is clamped and not the incremental impulse) we change the impulse variable (x_i).
+		//
+		// Substitute:
+		// 
+		// x = a + d
+		// 
+		// a := old total impulse
+		// x := new total impulse
+		// d := incremental impulse 
+		//
+		// For the current iteration we extend the formula for the incremental impulse
+		// to compute the new total impulse:
+		//
+		// vn = A * d + b
+		//    = A * (x - a) + b
+		//    = A * x + b - A * a
+		//    = A * x + b'
+		// b' = b - A * a;
+
+		b2VelocityConstraintPoint* cp1 = vc->points + 0;
+		b2VelocityConstraintPoint* cp2 = vc->points + 1;
+
+		b2Vec2 a(cp1->normalImpulse, cp2->normalImpulse);
+		b2Assert(a.x >= 0.0f && a.y >= 0.0f);
+
+		// Relative velocity at contact
+		b2Vec2 dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+		b2Vec2 dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+
+		// Compute normal velocity
+		float32 vn1 = b2Dot(dv1, normal);
+		float32 vn2 = b2Dot(dv2, normal);
+
+		b2Vec2 b;
+		b.x = vn1 - cp1->velocityBias;
+		b.y = vn2 - cp2->velocityBias;
+
+		// Compute b'
+		b -= b2Mul(vc->K, a);
+
+		const float32 k_errorTol = 1e-3f;
+		B2_NOT_USED(k_errorTol);
+
+		for (;;)
 		{
-			// Block solver developed in collaboration with Dirk Gregorius (back in 01/07 on Box2D_Lite).
-			// Build the mini LCP for this contact patch
 			//
-			// vn = A * x + b, vn >= 0, x >= 0 and vn_i * x_i = 0 with i = 1..2
+			// Case 1: vn = 0
 			//
-			// A = J * W * JT and J = ( -n, -r1 x n, n, r2 x n )
-			// b = vn0 - velocityBias
+			// 0 = A * x + b'
 			//
-			// The system is solved using the "Total enumeration method" (s. Murty). The complementary constraint vn_i * x_i
-			// implies that we must have in any solution either vn_i = 0 or x_i = 0. So for the 2D contact problem the cases
-			// vn1 = 0 and vn2 = 0, x1 = 0 and x2 = 0, x1 = 0 and vn2 = 0, x2 = 0 and vn1 = 0 need to be tested. The first valid
-			// solution that satisfies the problem is chosen.
-			// 
-			// In order to account of the accumulated impulse 'a' (because of the iterative nature of the solver which only requires
-			// that the accumulated impulse is clamped and not the incremental impulse) we change the impulse variable (x_i).
+			// Solve for x:
 			//
-			// Substitute:
-			// 
-			// x = a + d
-			// 
-			// a := old total impulse
-			// x := new total impulse
-			// d := incremental impulse 
+			// x = - inv(A) * b'
 			//
-			// For the current iteration we extend the formula for the incremental impulse
-			// to compute the new total impulse:
-			//
-			// vn = A * d + b
-			//    = A * (x - a) + b
-			//    = A * x + b - A * a
-			//    = A * x + b'
-			// b' = b - A * a;
-
-			b2VelocityConstraintPoint* cp1 = vc->points + 0;
-			b2VelocityConstraintPoint* cp2 = vc->points + 1;
-
-			b2Vec2 a(cp1->normalImpulse, cp2->normalImpulse);
-			b2Assert(a.x >= 0.0f && a.y >= 0.0f);
-
-			// Relative velocity at contact
-			b2Vec2 dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
-			b2Vec2 dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
-
-			// Compute normal velocity
-			float32 vn1 = b2Dot(dv1, normal);
-			float32 vn2 = b2Dot(dv2, normal);
+			b2Vec2 x = - b2Mul(vc->normalMass, b);
 
-			b2Vec2 b;
-			b.x = vn1 - cp1->velocityBias;
-			b.y = vn2 - cp2->velocityBias;
-
-			// Compute b'
-			b -= b2Mul(vc->K, a);
-
-			const float32 k_errorTol = 1e-3f;
-			B2_NOT_USED(k_errorTol);
-
-			for (;;)
+			if (x.x >= 0.0f && x.y >= 0.0f)
 			{
-				//
-				// Case 1: vn = 0
-				//
-				// 0 = A * x + b'
-				//
-				// Solve for x:
-				//
-				// x = - inv(A) * b'
-				//
-				b2Vec2 x = - b2Mul(vc->normalMass, b);
-
-				if (x.x >= 0.0f && x.y >= 0.0f)
-				{
-					// Get the incremental impulse
-					b2Vec2 d = x - a;
+				// Get the incremental impulse
+				b2Vec2 d = x - a;
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
 #if B2_DEBUG_SOLVER == 1
-					// Postconditions
-					dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
-					dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+				// Postconditions
+				dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+				dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
 
-					// Compute normal velocity
-					vn1 = b2Dot(dv1, normal);
-					vn2 = b2Dot(dv2, normal);
+				// Compute normal velocity
+				vn1 = b2Dot(dv1, normal);
+				vn2 = b2Dot(dv2, normal);
 
-					b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
-					b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
 #endif
-					break;
-				}
+				break;
+			}
 
-				//
-				// Case 2: vn1 = 0 and x2 = 0
-				//
-				//   0 = a11 * x1 + a12 * 0 + b1' 
-				// vn2 = a21 * x1 + a22 * 0 + b2'
-				//
-				x.x = - cp1->normalMass * b.x;
-				x.y = 0.0f;
-				vn1 = 0.0f;
-				vn2 = vc->K.ex.y * x.x + b.y;
-				if (x.x >= 0.0f && vn2 >= 0.0f)
-				{
-					// Get the incremental impulse
-					b2Vec2 d = x - a;
+			//
+			// Case 2: vn1 = 0 and x2 = 0
+			//
+			//   0 = a11 * x1 + a12 * 0 + b1' 
+			// vn2 = a21 * x1 + a22 * 0 + b2'
+			//
+			x.x = - cp1->normalMass * b.x;
+			x.y = 0.0f;
+			vn1 = 0.0f;
+			vn2 = vc->K.ex.y * x.x + b.y;
+			if (x.x >= 0.0f && vn2 >= 0.0f)
+			{
+				// Get the incremental impulse
+				b2Vec2 d = x - a;
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
 #if B2_DEBUG_SOLVER == 1
-					// Postconditions
-					dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+				// Postconditions
+				dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
 
-					// Compute normal velocity
-					vn1 = b2Dot(dv1, normal);
+				// Compute normal velocity
+				vn1 = b2Dot(dv1, normal);
 
-					b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
 #endif
-					break;
-				}
+				break;
+			}
 
 
-				//
-				// Case 3: vn2 = 0 and x1 = 0
-				//
-				// vn1 = a11 * 0 + a12 * x2 + b1' 
-				//   0 = a21 * 0 + a22 * x2 + b2'
-				//
-				x.x = 0.0f;
-				x.y = - cp2->normalMass * b.y;
-				vn1 = vc->K.ey.x * x.y + b.x;
-				vn2 = 0.0f;
+			//
+			// Case 3: vn2 = 0 and x1 = 0
+			//
+			// vn1 = a11 * 0 + a12 * x2 + b1' 
+			//   0 = a21 * 0 + a22 * x2 + b2'
+			//
+			x.x = 0.0f;
+			x.y = - cp2->normalMass * b.y;
+			vn1 = vc->K.ey.x * x.y + b.x;
+			vn2 = 0.0f;
 
-				if (x.y >= 0.0f && vn1 >= 0.0f)
-				{
-					// Resubstitute for the incremental impulse
-					b2Vec2 d = x - a;
+			if (x.y >= 0.0f && vn1 >= 0.0f)
+			{
+				// Resubstitute for the incremental impulse
+				b2Vec2 d = x - a;
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
 #if B2_DEBUG_SOLVER == 1
-					// Postconditions
-					dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+				// Postconditions
+				dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
 
-					// Compute normal velocity
-					vn2 = b2Dot(dv2, normal);
+				// Compute normal velocity
+				vn2 = b2Dot(dv2, normal);
 
-					b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
 #endif
-					break;
-				}
+				break;
+			}
 
-				//
-				// Case 4: x1 = 0 and x2 = 0
-				// 
-				// vn1 = b1
-				// vn2 = b2;
-				x.x = 0.0f;
-				x.y = 0.0f;
-				vn1 = b.x;
-				vn2 = b.y;
-
-				if (vn1 >= 0.0f && vn2 >= 0.0f )
-				{
-					// Resubstitute for the incremental impulse
-					b2Vec2 d = x - a;
+			//
+			// Case 4: x1 = 0 and x2 = 0
+			// 
+			// vn1 = b1
+			// vn2 = b2;
+			x.x = 0.0f;
+			x.y = 0.0f;
+			vn1 = b.x;
+			vn2 = b.y;
+
+			if (vn1 >= 0.0f && vn2 >= 0.0f )
+			{
+				// Resubstitute for the incremental impulse
+				b2Vec2 d = x - a;
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
-					break;
-				}
-
-				// No solution, give up. This is hit sometimes, but it doesn't seem to matter.
 				break;
 			}
+
+			// No solution, give up. This is hit sometimes, but it doesn't seem to matter.
+			break;
 		}
+	}
+
+	velocities.SetLinear(indexA, vA);
+	velocities.w[indexA] = wA;
+	velocities.SetLinear(indexB, vB);
+	velocities.w[indexB] = wB;
+}
+
+void b2ContactSolver::SolveVelocityConstraints()
+{
+	if (m_wideLanes > 0)
+	{
+		SolveWideVelocityConstraints();
+		return;
+	}
 
-		m_velocities[indexA].v = vA;
-		m_velocities[indexA].w = wA;
-		m_velocities[indexB].v = vB;
-		m_velocities[indexB].w = wB;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2SolveVelocityConstraint(m_velocityConstraints + i, m_velocities);
+	}
+}
+
+void b2ContactSolver::SolveWideVelocityConstraints()
+{
+	switch (m_wideLanes)
+	{
+	case 8:
+		b2SolveWideContacts8((b2WideContactBundle<8>*)m_wideBundles, m_wideBundleCount, m_velocities);
+		break;
+	case 4:
+		b2SolveWideContacts4((b2WideContactBundle<4>*)m_wideBundles, m_wideBundleCount, m_velocities);
+		break;
+	default:
+		b2SolveWideContacts1((b2WideContactBundle<1>*)m_wideBundles, m_wideBundleCount, m_velocities);
+		break;
+	}
+
+	for (int32 i = 0; i < m_wideOverflowCount; ++i)
+	{
+		b2SolveVelocityConstraint(m_velocityConstraints + m_wideOverflow[i], m_velocities);
 	}
 }
 
 void b2ContactSolver::StoreImpulses()
 {
+	// The wide solver keeps the impulses in its bundles.
+	switch (m_wideLanes)
+	{
+	case 8:
+		b2UnpackWideImpulses<8>(m_wideBundles, m_wideBundleCount, m_velocityConstraints);
+		break;
+	case 4:
+		b2UnpackWideImpulses<4>(m_wideBundles, m_wideBundleCount, m_velocityConstraints);
+		break;
+	case 1:
+		b2UnpackWideImpulses<1>(m_wideBundles, m_wideBundleCount, m_velocityConstraints);
+		break;
+	}
+
 	for (int32 i = 0; i < m_count; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
@@ -686,11 +981,11 @@ bool b2ContactSolver::SolvePositionConstraints()
 		float32 iB = pc->invIB;
 		int32 pointCount = pc->pointCount;
 
-		b2Vec2 cA = m_positions[indexA].c;
-		float32 aA = m_positions[indexA].a;
+		b2Vec2 cA = m_positions.GetCenter(indexA);
+		float32 aA = m_positions.a[indexA];
 
-		b2Vec2 cB = m_positions[indexB].c;
-		float32 aB = m_positions[indexB].a;
+		b2Vec2 cB = m_positions.GetCenter(indexB);
+		float32 aB = m_positions.a[indexB];
 
 		// Solve normal constraints
 		for (int32 j = 0; j < pointCount; ++j)
@@ -734,11 +1029,11 @@ bool b2ContactSolver::SolvePositionConstraints()
 			aB += iB * b2Cross(rB, P);
 		}
 
-		m_positions[indexA].c = cA;
-		m_positions[indexA].a = aA;
+		m_positions.SetCenter(indexA, cA);
+		m_positions.a[indexA] = aA;
 
-		m_positions[indexB].c = cB;
-		m_positions[indexB].a = aB;
+		m_positions.SetCenter(indexB, cB);
+		m_positions.a[indexB] = aB;
 	}
 
 	// We can't expect minSpeparation >= -b2_linearSlop because we don't
@@ -777,11 +1072,11 @@ bool b2ContactSolver::SolveTOIPositionConstraints(int32 toiIndexA, int32 toiInde
 			iB = pc->invIB;
 		}
 
-		b2Vec2 cA = m_positions[indexA].c;
-		float32 aA = m_positions[indexA].a;
+		b2Vec2 cA = m_positions.GetCenter(indexA);
+		float32 aA = m_positions.a[indexA];
 
-		b2Vec2 cB = m_positions[indexB].c;
-		float32 aB = m_positions[indexB].a;
+		b2Vec2 cB = m_positions.GetCenter(indexB);
+		float32 aB = m_positions.a[indexB];
 
 		// Solve normal constraints
 		for (int32 j = 0; j < pointCount; ++j)
@@ -825,14 +1120,289 @@ bool b2ContactSolver::SolveTOIPositionConstraints(int32 toiIndexA, int32 toiInde
 			aB += iB * b2Cross(rB, P);
 		}
 
-		m_positions[indexA].c = cA;
-		m_positions[indexA].a = aA;
+		m_positions.SetCenter(indexA, cA);
+		m_positions.a[indexA] = aA;
 
-		m_positions[indexB].c = cB;
-		m_positions[indexB].a = aB;
+		m_positions.SetCenter(indexB, cB);
+		m_positions.a[indexB] = aB;
 	}
 
 	// We can't expect minSpeparation >= -b2_linearSlop because we don't
 	// push the separation above -b2_linearSlop.
 	return minSeparation >= -1.5f * b2_linearSlop;
 }
+
+// The constraints keep the Jacobians of the start of the step. Only the separation is
+// updated during the sub-steps, so the relative velocity stored here stays meaningful.
+void b2ContactSolver::InitializeSoftConstraints()
+{
+	b2Assert(m_step.wideContactLanes == 0);
+
+	InitializeVelocityConstraints();
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+
+		b2Vec2 vA = m_velocities.GetLinear(vc->indexA);
+		float32 wA = m_velocities.w[vc->indexA];
+		b2Vec2 vB = m_velocities.GetLinear(vc->indexB);
+		float32 wB = m_velocities.w[vc->indexB];
+
+		for (int32 j = 0; j < vc->pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+			vcp->velocityBias = b2Dot(vc->normal, vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA));
+			vcp->totalNormalImpulse = 0.0f;
+			vcp->totalTangentImpulse = 0.0f;
+		}
+	}
+}
+
+// Solve one contact constraint of a soft step. Separated points are speculative, the bodies
+// may close the gap in this sub-step but no more. Overlapping points are pushed out by a soft
+// spring when useBias is set.
+static void b2SolveSoftConstraint(b2ContactVelocityConstraint* vc, b2ContactPositionConstraint* pc,
+	const b2Position& positions, const b2Velocity& velocities, const b2ContactSoftness& softness,
+	float32 inv_h, bool useBias)
+{
+	int32 indexA = vc->indexA;
+	int32 indexB = vc->indexB;
+	float32 mA = vc->invMassA;
+	float32 iA = vc->invIA;
+	float32 mB = vc->invMassB;
+	float32 iB = vc->invIB;
+	int32 pointCount = vc->pointCount;
+
+	b2Vec2 vA = velocities.GetLinear(indexA);
+	float32 wA = velocities.w[indexA];
+	b2Vec2 vB = velocities.GetLinear(indexB);
+	float32 wB = velocities.w[indexB];
+
+	b2Transform xfA, xfB;
+	xfA.q.Set(positions.a[indexA]);
+	xfB.q.Set(positions.a[indexB]);
+	xfA.p = positions.GetCenter(indexA) - b2Mul(xfA.q, pc->localCenterA);
+	xfB.p = positions.GetCenter(indexB) - b2Mul(xfB.q, pc->localCenterB);
+
+	b2Vec2 normal = vc->normal;
+	b2Vec2 tangent = b2Cross(normal, 1.0f);
+	float32 friction = vc->friction;
+
+	// Targets of the normal constraints.
+	float32 biases[b2_maxManifoldPoints];
+	float32 massScales[b2_maxManifoldPoints];
+	float32 impulseScales[b2_maxManifoldPoints];
+	for (int32 j = 0; j < pointCount; ++j)
+	{
+		b2PositionSolverManifold psm;
+		psm.Initialize(pc, xfA, xfB, j);
+		float32 separation = psm.separation;
+
+		biases[j] = 0.0f;
+		massScales[j] = 1.0f;
+		impulseScales[j] = 0.0f;
+		if (separation > 0.0f)
+		{
+			biases[j] = separation * inv_h;
+		}
+		else if (useBias)
+		{
+			biases[j] = b2Max(softness.biasRate * b2Min(0.0f, separation + b2_linearSlop), -b2_contactPushVelocity);
+			massScales[j] = softness.massScale;
+			impulseScales[j] = softness.impulseScale;
+		}
+	}
+
+	// A single pass over two points in sequence leaves the body turning, so two points with
+	// the same softness are solved together when neither impulse would clamp.
+	bool solved = false;
+	if (pointCount == 2 && massScales[0] == massScales[1])
+	{
+		b2VelocityConstraintPoint* cp1 = vc->points + 0;
+		b2VelocityConstraintPoint* cp2 = vc->points + 1;
+
+		b2Vec2 dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+		b2Vec2 dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+
+		b2Vec2 a(cp1->normalImpulse, cp2->normalImpulse);
+		b2Vec2 b(b2Dot(dv1, normal) + biases[0], b2Dot(dv2, normal) + biases[1]);
+		b2Vec2 d = -massScales[0] * b2Mul(vc->normalMass, b) - impulseScales[0] * a;
+		b2Vec2 x = a + d;
+
+		if (x.x >= 0.0f && x.y >= 0.0f)
+		{
+			b2Vec2 P1 = d.x * normal;
+			b2Vec2 P2 = d.y * normal;
+			vA -= mA * (P1 + P2);
+			wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+
+			vB += mB * (P1 + P2);
+			wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+
+			cp1->normalImpulse = x.x;
+			cp2->normalImpulse = x.y;
+			solved = true;
+		}
+	}
+
+	// Solve normal constraints first, friction uses the new normal impulses.
+	for (int32 j = 0; j < pointCount && solved == false; ++j)
+	{
+		b2VelocityConstraintPoint* vcp = vc->points + j;
+
+		// Relative velocity at contact
+		b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+		float32 vn = b2Dot(dv, normal);
+
+		float32 impulse = -vcp->normalMass * massScales[j] * (vn + biases[j]) - impulseScales[j] * vcp->normalImpulse;
+
+		// b2Clamp the accumulated impulse
+		float32 newImpulse = b2Max(vcp->normalImpulse + impulse, 0.0f);
+		impulse = newImpulse - vcp->normalImpulse;
+		vcp->normalImpulse = newImpulse;
+
+		// Apply contact impulse
+		b2Vec2 P = impulse * normal;
+		vA -= mA * P;
+		wA -= iA * b2Cross(vcp->rA, P);
+
+		vB += mB * P;
+		wB += iB * b2Cross(vcp->rB, P);
+	}
+
+	for (int32 j = 0; j < pointCount; ++j)
+	{
+		b2VelocityConstraintPoint* vcp = vc->points + j;
+
+		// Relative velocity at contact
+		b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+
+		// Compute tangent force
+		float32 vt = b2Dot(dv, tangent) - vc->tangentSpeed;
+		float32 lambda = vcp->tangentMass * (-vt);
+
+		// b2Clamp the accumulated force
+		float32 maxFriction = friction * vcp->normalImpulse;
+		float32 newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
+		lambda = newImpulse - vcp->tangentImpulse;
+		vcp->tangentImpulse = newImpulse;
+
+		// Apply contact impulse
+		b2Vec2 P = lambda * tangent;
+
+		vA -= mA * P;
+		wA -= iA * b2Cross(vcp->rA, P);
+
+		vB += mB * P;
+		wB += iB * b2Cross(vcp->rB, P);
+	}
+
+	velocities.SetLinear(indexA, vA);
+	velocities.w[indexA] = wA;
+	velocities.SetLinear(indexB, vB);
+	velocities.w[indexB] = wB;
+}
+
+// Solve the contacts for one pass of a sub-step.
+void b2ContactSolver::SolveSoftConstraints(const b2ContactSoftness& softness, float32 inv_h, bool useBias)
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2SolveSoftConstraint(m_velocityConstraints + i, m_positionConstraints + i,
+			m_positions, m_velocities, softness, inv_h, useBias);
+	}
+
+	// The relax pass ends a sub-step, so its impulses are what the sub-step applied.
+	if (useBias == false)
+	{
+		for (int32 i = 0; i < m_count; ++i)
+		{
+			b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+			for (int32 j = 0; j < vc->pointCount; ++j)
+			{
+				b2VelocityConstraintPoint* vcp = vc->points + j;
+				vcp->totalNormalImpulse += vcp->normalImpulse;
+				vcp->totalTangentImpulse += vcp->tangentImpulse;
+			}
+		}
+	}
+}
+
+// The soft push out and the relax passes remove the approach velocity of an impact, so
+// bounces are applied afterwards from the relative velocity at the start of the step.
+void b2ContactSolver::ApplySoftRestitution()
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		if (vc->restitution == 0.0f)
+		{
+			continue;
+		}
+
+		int32 indexA = vc->indexA;
+		int32 indexB = vc->indexB;
+		float32 mA = vc->invMassA;
+		float32 iA = vc->invIA;
+		float32 mB = vc->invMassB;
+		float32 iB = vc->invIB;
+
+		b2Vec2 vA = m_velocities.GetLinear(indexA);
+		float32 wA = m_velocities.w[indexA];
+		b2Vec2 vB = m_velocities.GetLinear(indexB);
+		float32 wB = m_velocities.w[indexB];
+
+		b2Vec2 normal = vc->normal;
+
+		for (int32 j = 0; j < vc->pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+
+			// Only points that hit fast enough and were pushed at some point in the step bounce.
+			if (vcp->velocityBias > -b2_velocityThreshold || vcp->totalNormalImpulse == 0.0f)
+			{
+				continue;
+			}
+
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+			float32 vn = b2Dot(dv, normal);
+
+			float32 impulse = -vcp->normalMass * (vn + vc->restitution * vcp->velocityBias);
+			float32 newImpulse = b2Max(vcp->normalImpulse + impulse, 0.0f);
+			impulse = newImpulse - vcp->normalImpulse;
+			vcp->normalImpulse = newImpulse;
+			vcp->totalNormalImpulse += impulse;
+
+			b2Vec2 P = impulse * normal;
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
+		}
+
+		m_velocities.SetLinear(indexA, vA);
+		m_velocities.w[indexA] = wA;
+		m_velocities.SetLinear(indexB, vB);
+		m_velocities.w[indexB] = wB;
+	}
+}
+
+// The impulses of the last sub-step warm start the next step, the impulses of the whole
+// step are left in the constraints for the contact listener.
+void b2ContactSolver::StoreSoftImpulses()
+{
+	StoreImpulses();
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		for (int32 j = 0; j < vc->pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+			vcp->normalImpulse = vcp->totalNormalImpulse;
+			vcp->tangentImpulse = vcp->totalTangentImpulse;
+		}
+	}
+}
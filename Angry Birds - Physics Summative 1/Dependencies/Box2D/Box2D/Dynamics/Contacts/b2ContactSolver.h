@@ -36,7 +36,9 @@ struct b2VelocityConstraintPoint
 	float32 tangentImpulse;
 	float32 normalMass;
 	float32 tangentMass;
-	float32 velocityBias;
+	float32 velocityBias;		// the relative normal velocity before solving, with soft steps
+	float32 totalNormalImpulse;		// the impulses of all sub-steps of a soft step
+	float32 totalTangentImpulse;
 };
 
 struct b2ContactVelocityConstraint
@@ -56,13 +58,22 @@ struct b2ContactVelocityConstraint
 	int32 contactIndex;
 };
 
+/// The softness of the contact constraints of a soft step, for one sub-step.
+struct b2ContactSoftness
+{
+	float32 biasRate;		// the fraction of the overlap pushed out per second
+	float32 massScale;
+	float32 impulseScale;
+};
+
 struct b2ContactSolverDef
 {
 	b2TimeStep step;
 	b2Contact** contacts;
 	int32 count;
-	b2Position* positions;
-	b2Velocity* velocities;
+	b2Position positions;
+	b2Velocity velocities;
+	const int32* sharedSlots;
 	b2StackAllocator* allocator;
 };
 
@@ -81,14 +92,31 @@ public:
 	bool SolvePositionConstraints();
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
+	// The soft step solver. Each sub-step warm starts, solves with a soft push out, integrates
+	// positions and relaxes without the push out. Restitution is applied once after all sub-steps.
+	void InitializeSoftConstraints();
+	void SolveSoftConstraints(const b2ContactSoftness& softness, float32 inv_h, bool useBias);
+	void ApplySoftRestitution();
+	void StoreSoftImpulses();
+
+	void PrepareWideConstraints(int32 lanes);
+	void SolveWideVelocityConstraints();
+
 	b2TimeStep m_step;
-	b2Position* m_positions;
-	b2Velocity* m_velocities;
+	b2Position m_positions;
+	b2Velocity m_velocities;
 	b2StackAllocator* m_allocator;
 	b2ContactPositionConstraint* m_positionConstraints;
 	b2ContactVelocityConstraint* m_velocityConstraints;
 	b2Contact** m_contacts;
 	int m_count;
+
+	// Wide solver state, only used when m_wideLanes > 0.
+	int32 m_wideLanes;
+	void* m_wideBundles;
+	int32 m_wideBundleCount;
+	int32* m_wideOverflow;
+	int32 m_wideOverflowCount;
 };
 
 #endif
@@ -35,15 +35,8 @@ void b2EdgeAndPolygonContact::Destroy(b2Contact* contact, b2BlockAllocator* allo
 }
 
 b2EdgeAndPolygonContact::b2EdgeAndPolygonContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
-: b2Contact(fixtureA, 0, fixtureB, 0)
+: b2Contact(fixtureA, 0, fixtureB, 0, e_edgeAndPolygonContact)
 {
 	b2Assert(m_fixtureA->GetType() == b2Shape::e_edge);
 	b2Assert(m_fixtureB->GetType() == b2Shape::e_polygon);
 }
-
-void b2EdgeAndPolygonContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
-{
-	b2CollideEdgeAndPolygon(	manifold,
-								(b2EdgeShape*)m_fixtureA->GetShape(), xfA,
-								(b2PolygonShape*)m_fixtureB->GetShape(), xfB);
-}
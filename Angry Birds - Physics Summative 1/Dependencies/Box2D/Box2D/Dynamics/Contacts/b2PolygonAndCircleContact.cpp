@@ -35,15 +35,8 @@ void b2PolygonAndCircleContact::Destroy(b2Contact* contact, b2BlockAllocator* al
 }
 
 b2PolygonAndCircleContact::b2PolygonAndCircleContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
-: b2Contact(fixtureA, 0, fixtureB, 0)
+: b2Contact(fixtureA, 0, fixtureB, 0, e_polygonAndCircleContact)
 {
 	b2Assert(m_fixtureA->GetType() == b2Shape::e_polygon);
 	b2Assert(m_fixtureB->GetType() == b2Shape::e_circle);
 }
-
-void b2PolygonAndCircleContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
-{
-	b2CollidePolygonAndCircle(	manifold,
-								(b2PolygonShape*)m_fixtureA->GetShape(), xfA,
-								(b2CircleShape*)m_fixtureB->GetShape(), xfB);
-}
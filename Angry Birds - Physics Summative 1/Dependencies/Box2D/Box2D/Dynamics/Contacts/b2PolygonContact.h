@@ -20,6 +20,7 @@
 #define B2_POLYGON_CONTACT_H
 
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
 
 class b2BlockAllocator;
 
@@ -33,7 +34,14 @@ public:
 	b2PolygonContact(b2Fixture* fixtureA, b2Fixture* fixtureB);
 	~b2PolygonContact() {}
 
-	void Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB);
+	void Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB, float32 speculativeDistance);
 };
 
+inline void b2PolygonContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB, float32 speculativeDistance)
+{
+	b2CollidePolygons(	manifold,
+						(b2PolygonShape*)m_fixtureA->GetShape(), xfA,
+						(b2PolygonShape*)m_fixtureB->GetShape(), xfB, speculativeDistance);
+}
+
 #endif
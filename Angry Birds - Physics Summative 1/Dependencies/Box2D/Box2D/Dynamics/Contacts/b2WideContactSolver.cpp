@@ -0,0 +1,93 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/Contacts/b2WideContactSolver.h>
+#include <Box2D/Dynamics/Contacts/b2WideContactSolverKernel.h>
+#include <Box2D/Common/b2WideFloat.h>
+
+#if B2_WIDE_SSE2 && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+void b2SolveWideContacts1(b2WideContactBundle<1>* bundles, int32 count, const b2Velocity& velocities)
+{
+	b2SolveWideContactBundles<b2FloatW1, 1>(bundles, count, velocities);
+}
+
+#if B2_WIDE_SSE2
+
+void b2SolveWideContacts4(b2WideContactBundle<4>* bundles, int32 count, const b2Velocity& velocities)
+{
+	b2SolveWideContactBundles<b2FloatW4, 4>(bundles, count, velocities);
+}
+
+// AVX2 needs the CPU to support it and the OS to save the YMM registers.
+static bool b2CpuHasAVX2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+
+	__cpuid(info, 1);
+	const int osxsave = 1 << 27;
+	const int avx = 1 << 28;
+	if ((info[2] & osxsave) == 0 || (info[2] & avx) == 0 || (_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#else
+	return false;
+#endif
+}
+
+int32 b2GetWideContactLanes()
+{
+	if (b2HasWideContacts8() && b2CpuHasAVX2())
+	{
+		return 8;
+	}
+
+	return 4;
+}
+
+#else
+
+void b2SolveWideContacts4(b2WideContactBundle<4>* bundles, int32 count, const b2Velocity& velocities)
+{
+	B2_NOT_USED(bundles);
+	B2_NOT_USED(count);
+	B2_NOT_USED(velocities);
+	b2Assert(false);
+}
+
+int32 b2GetWideContactLanes()
+{
+	return 1;
+}
+
+#endif
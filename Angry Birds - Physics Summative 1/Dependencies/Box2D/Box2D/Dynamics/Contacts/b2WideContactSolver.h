@@ -0,0 +1,76 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_WIDE_CONTACT_SOLVER_H
+#define B2_WIDE_CONTACT_SOLVER_H
+
+#include <Box2D/Common/b2Settings.h>
+
+struct b2Velocity;
+
+/// The most colours the contacts of an island are split into. Contacts that do not fit
+/// in any colour are solved by the scalar solver after the wide batches.
+#define b2_wideColorCount	12
+
+/// Islands with fewer contacts than this are solved by the scalar solver.
+#define b2_minWideContacts	16
+
+/// Up to W contact constraints in structure of arrays layout, one per lane. No two lanes
+/// share a dynamic body, so the lanes can be solved at the same time. Unused lanes have a
+/// constraint index of -1 and zero mass, so they solve to nothing.
+template <int32 W>
+struct b2WideContactBundle
+{
+	struct Point
+	{
+		float32 rAx[W], rAy[W];
+		float32 rBx[W], rBy[W];
+		float32 normalImpulse[W];
+		float32 tangentImpulse[W];
+		float32 normalMass[W];
+		float32 tangentMass[W];
+		float32 velocityBias[W];
+	};
+
+	Point points[b2_maxManifoldPoints];
+	float32 normalX[W], normalY[W];
+	float32 Kexx[W], Kexy[W], Keyx[W], Keyy[W];
+	float32 normalMassExx[W], normalMassExy[W], normalMassEyx[W], normalMassEyy[W];
+	float32 invMassA[W], invIA[W];
+	float32 invMassB[W], invIB[W];
+	float32 friction[W];
+	float32 tangentSpeed[W];
+	float32 blockSolve[W];		// 1 for two point constraints solved as a block, otherwise 0
+	int32 indexA[W];
+	int32 indexB[W];
+	int32 constraintIndex[W];
+};
+
+/// The widest lanes this CPU supports: 8 with AVX2, 4 with SSE2, otherwise 1.
+int32 b2GetWideContactLanes();
+
+/// False when b2WideContactSolverAVX2.cpp was built without AVX2 code generation.
+bool b2HasWideContacts8();
+
+/// Solve one velocity iteration of the bundles in order. Every lane width runs the same
+/// float operations in the same order, so all widths give bit identical results.
+void b2SolveWideContacts1(b2WideContactBundle<1>* bundles, int32 count, const b2Velocity& velocities);
+void b2SolveWideContacts4(b2WideContactBundle<4>* bundles, int32 count, const b2Velocity& velocities);
+void b2SolveWideContacts8(b2WideContactBundle<8>* bundles, int32 count, const b2Velocity& velocities);
+
+#endif
@@ -0,0 +1,79 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+// This file is built with AVX2 code generation (-mavx2 or /arch:AVX2). Its code only runs
+// after b2GetWideContactLanes has checked that the CPU supports AVX2, so it must not share
+// inline functions with the rest of the library.
+
+#include <Box2D/Dynamics/Contacts/b2WideContactSolver.h>
+#include <Box2D/Dynamics/Contacts/b2WideContactSolverKernel.h>
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+// Eight lanes with AVX. The operations are the same as the four SSE2 lanes, so both give the
+// same results. No FMA, fusing would change the rounding.
+struct b2FloatW8
+{
+	typedef b2FloatW8 Mask;
+
+	static b2FloatW8 Splat(float32 x) { b2FloatW8 r = { _mm256_set1_ps(x) }; return r; }
+	static b2FloatW8 Load(const float32* p) { b2FloatW8 r = { _mm256_loadu_ps(p) }; return r; }
+
+	__m256 v;
+};
+
+inline void b2StoreW(b2FloatW8 a, float32* p) { _mm256_storeu_ps(p, a.v); }
+inline b2FloatW8 operator + (b2FloatW8 a, b2FloatW8 b) { b2FloatW8 r = { _mm256_add_ps(a.v, b.v) }; return r; }
+inline b2FloatW8 operator - (b2FloatW8 a, b2FloatW8 b) { b2FloatW8 r = { _mm256_sub_ps(a.v, b.v) }; return r; }
+inline b2FloatW8 operator * (b2FloatW8 a, b2FloatW8 b) { b2FloatW8 r = { _mm256_mul_ps(a.v, b.v) }; return r; }
+inline b2FloatW8 operator - (b2FloatW8 a) { b2FloatW8 r = { _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)) }; return r; }
+inline b2FloatW8 b2MinW(b2FloatW8 a, b2FloatW8 b) { b2FloatW8 r = { _mm256_min_ps(a.v, b.v) }; return r; }
+inline b2FloatW8 b2MaxW(b2FloatW8 a, b2FloatW8 b) { b2FloatW8 r = { _mm256_max_ps(a.v, b.v) }; return r; }
+inline b2FloatW8 b2GreaterEqualW(b2FloatW8 a, b2FloatW8 b) { b2FloatW8 r = { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; return r; }
+inline b2FloatW8 b2AndW(b2FloatW8 a, b2FloatW8 b) { b2FloatW8 r = { _mm256_and_ps(a.v, b.v) }; return r; }
+inline b2FloatW8 b2OrW(b2FloatW8 a, b2FloatW8 b) { b2FloatW8 r = { _mm256_or_ps(a.v, b.v) }; return r; }
+inline b2FloatW8 b2SelectW(b2FloatW8 m, b2FloatW8 a, b2FloatW8 b) { b2FloatW8 r = { _mm256_blendv_ps(b.v, a.v, m.v) }; return r; }
+
+void b2SolveWideContacts8(b2WideContactBundle<8>* bundles, int32 count, const b2Velocity& velocities)
+{
+	b2SolveWideContactBundles<b2FloatW8, 8>(bundles, count, velocities);
+}
+
+bool b2HasWideContacts8()
+{
+	return true;
+}
+
+#else
+
+void b2SolveWideContacts8(b2WideContactBundle<8>* bundles, int32 count, const b2Velocity& velocities)
+{
+	B2_NOT_USED(bundles);
+	B2_NOT_USED(count);
+	B2_NOT_USED(velocities);
+	b2Assert(false);
+}
+
+bool b2HasWideContacts8()
+{
+	return false;
+}
+
+#endif
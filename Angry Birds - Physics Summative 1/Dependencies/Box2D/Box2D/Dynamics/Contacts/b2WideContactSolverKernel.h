@@ -0,0 +1,289 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_WIDE_CONTACT_SOLVER_KERNEL_H
+#define B2_WIDE_CONTACT_SOLVER_KERNEL_H
+
+#include <Box2D/Dynamics/Contacts/b2WideContactSolver.h>
+#include <Box2D/Dynamics/b2TimeStep.h>
+
+// The velocity iteration of b2ContactSolver::SolveVelocityConstraints written once for any lane
+// type F holding W floats. Each translation unit that includes this defines its own F, so code
+// compiled for one instruction set never ends up shared with another.
+//
+// F needs F::Splat, F::Load, b2StoreW, the arithmetic operators, b2MinW, b2MaxW, and for the
+// mask type F::Mask b2GreaterEqualW, b2AndW, b2OrW and b2SelectW.
+//
+// The operations follow the scalar solver expression by expression, so a lane computes exactly
+// what the scalar solver computes for the same constraint.
+
+template <typename F, int32 W>
+static void b2SolveWideContactBundles(b2WideContactBundle<W>* bundles, int32 count, const b2Velocity& velocities)
+{
+	typedef typename F::Mask M;
+	typedef typename b2WideContactBundle<W>::Point Point;
+
+	const F zero = F::Splat(0.0f);
+	const F one = F::Splat(1.0f);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2WideContactBundle<W>* bundle = bundles + i;
+
+		float32 gather[6][W];
+		for (int32 l = 0; l < W; ++l)
+		{
+			int32 indexA = bundle->indexA[l];
+			int32 indexB = bundle->indexB[l];
+			if (indexA >= 0)
+			{
+				gather[0][l] = velocities.vx[indexA];
+				gather[1][l] = velocities.vy[indexA];
+				gather[2][l] = velocities.w[indexA];
+			}
+			else
+			{
+				gather[0][l] = gather[1][l] = gather[2][l] = 0.0f;
+			}
+
+			if (indexB >= 0)
+			{
+				gather[3][l] = velocities.vx[indexB];
+				gather[4][l] = velocities.vy[indexB];
+				gather[5][l] = velocities.w[indexB];
+			}
+			else
+			{
+				gather[3][l] = gather[4][l] = gather[5][l] = 0.0f;
+			}
+		}
+
+		F vAx = F::Load(gather[0]);
+		F vAy = F::Load(gather[1]);
+		F wA = F::Load(gather[2]);
+		F vBx = F::Load(gather[3]);
+		F vBy = F::Load(gather[4]);
+		F wB = F::Load(gather[5]);
+
+		F mA = F::Load(bundle->invMassA);
+		F iA = F::Load(bundle->invIA);
+		F mB = F::Load(bundle->invMassB);
+		F iB = F::Load(bundle->invIB);
+
+		F nx = F::Load(bundle->normalX);
+		F ny = F::Load(bundle->normalY);
+		F tx = ny;
+		F ty = -nx;
+		F friction = F::Load(bundle->friction);
+		F tangentSpeed = F::Load(bundle->tangentSpeed);
+
+		// Solve tangent constraints first because non-penetration is more important
+		// than friction. Unused second points have zero mass and impulse, so they change nothing.
+		for (int32 j = 0; j < b2_maxManifoldPoints; ++j)
+		{
+			Point* cp = bundle->points + j;
+			F rAx = F::Load(cp->rAx), rAy = F::Load(cp->rAy);
+			F rBx = F::Load(cp->rBx), rBy = F::Load(cp->rBy);
+
+			// Relative velocity at contact
+			F dvx = ((vBx + (-wB) * rBy) - vAx) - (-wA) * rAy;
+			F dvy = ((vBy + wB * rBx) - vAy) - wA * rAx;
+
+			// Compute tangent force
+			F vt = (dvx * tx + dvy * ty) - tangentSpeed;
+			F lambda = F::Load(cp->tangentMass) * (-vt);
+
+			// Clamp the accumulated force
+			F tangentImpulse = F::Load(cp->tangentImpulse);
+			F maxFriction = friction * F::Load(cp->normalImpulse);
+			F newImpulse = b2MaxW(-maxFriction, b2MinW(tangentImpulse + lambda, maxFriction));
+			lambda = newImpulse - tangentImpulse;
+			b2StoreW(newImpulse, cp->tangentImpulse);
+
+			// Apply contact impulse
+			F Px = lambda * tx;
+			F Py = lambda * ty;
+
+			vAx = vAx - mA * Px;
+			vAy = vAy - mA * Py;
+			wA = wA - iA * (rAx * Py - rAy * Px);
+
+			vBx = vBx + mB * Px;
+			vBy = vBy + mB * Py;
+			wB = wB + iB * (rBx * Py - rBy * Px);
+		}
+
+		Point* cp1 = bundle->points + 0;
+		Point* cp2 = bundle->points + 1;
+		F r1Ax = F::Load(cp1->rAx), r1Ay = F::Load(cp1->rAy);
+		F r1Bx = F::Load(cp1->rBx), r1By = F::Load(cp1->rBy);
+		F r2Ax = F::Load(cp2->rAx), r2Ay = F::Load(cp2->rAy);
+		F r2Bx = F::Load(cp2->rBx), r2By = F::Load(cp2->rBy);
+		F a1 = F::Load(cp1->normalImpulse);
+		F a2 = F::Load(cp2->normalImpulse);
+
+		// Solve normal constraints one point at a time. This is the result for one point
+		// constraints, and for two point constraints when block solving is off.
+		F svAx = vAx, svAy = vAy, swA = wA;
+		F svBx = vBx, svBy = vBy, swB = wB;
+		F sx[b2_maxManifoldPoints];
+		for (int32 j = 0; j < b2_maxManifoldPoints; ++j)
+		{
+			Point* cp = bundle->points + j;
+			F rAx = j == 0 ? r1Ax : r2Ax, rAy = j == 0 ? r1Ay : r2Ay;
+			F rBx = j == 0 ? r1Bx : r2Bx, rBy = j == 0 ? r1By : r2By;
+			F normalImpulse = j == 0 ? a1 : a2;
+
+			// Relative velocity at contact
+			F dvx = ((svBx + (-swB) * rBy) - svAx) - (-swA) * rAy;
+			F dvy = ((svBy + swB * rBx) - svAy) - swA * rAx;
+
+			// Compute normal impulse
+			F vn = dvx * nx + dvy * ny;
+			F lambda = (-F::Load(cp->normalMass)) * (vn - F::Load(cp->velocityBias));
+
+			// Clamp the accumulated impulse
+			F newImpulse = b2MaxW(normalImpulse + lambda, zero);
+			lambda = newImpulse - normalImpulse;
+			sx[j] = newImpulse;
+
+			// Apply contact impulse
+			F Px = lambda * nx;
+			F Py = lambda * ny;
+			svAx = svAx - mA * Px;
+			svAy = svAy - mA * Py;
+			swA = swA - iA * (rAx * Py - rAy * Px);
+
+			svBx = svBx + mB * Px;
+			svBy = svBy + mB * Py;
+			swB = swB + iB * (rBx * Py - rBy * Px);
+		}
+
+		// Block solver, see b2ContactSolver::SolveVelocityConstraints. All four cases are
+		// evaluated and the first valid one is selected per lane.
+		{
+			// Relative velocity at contact
+			F dv1x = ((vBx + (-wB) * r1By) - vAx) - (-wA) * r1Ay;
+			F dv1y = ((vBy + wB * r1Bx) - vAy) - wA * r1Ax;
+			F dv2x = ((vBx + (-wB) * r2By) - vAx) - (-wA) * r2Ay;
+			F dv2y = ((vBy + wB * r2Bx) - vAy) - wA * r2Ax;
+
+			// Compute normal velocity
+			F vn1 = dv1x * nx + dv1y * ny;
+			F vn2 = dv2x * nx + dv2y * ny;
+
+			F Kexx = F::Load(bundle->Kexx), Kexy = F::Load(bundle->Kexy);
+			F Keyx = F::Load(bundle->Keyx), Keyy = F::Load(bundle->Keyy);
+
+			// Compute b'
+			F bx = vn1 - F::Load(cp1->velocityBias);
+			F by = vn2 - F::Load(cp2->velocityBias);
+			bx = bx - (Kexx * a1 + Keyx * a2);
+			by = by - (Kexy * a1 + Keyy * a2);
+
+			// Case 1: vn = 0
+			F x1x = -(F::Load(bundle->normalMassExx) * bx + F::Load(bundle->normalMassEyx) * by);
+			F x1y = -(F::Load(bundle->normalMassExy) * bx + F::Load(bundle->normalMassEyy) * by);
+			M case1 = b2AndW(b2GreaterEqualW(x1x, zero), b2GreaterEqualW(x1y, zero));
+
+			// Case 2: vn1 = 0 and x2 = 0
+			F x2x = (-F::Load(cp1->normalMass)) * bx;
+			F vn2c = Kexy * x2x + by;
+			M case2 = b2AndW(b2GreaterEqualW(x2x, zero), b2GreaterEqualW(vn2c, zero));
+
+			// Case 3: vn2 = 0 and x1 = 0
+			F x3y = (-F::Load(cp2->normalMass)) * by;
+			F vn1c = Keyx * x3y + bx;
+			M case3 = b2AndW(b2GreaterEqualW(x3y, zero), b2GreaterEqualW(vn1c, zero));
+
+			// Case 4: x1 = 0 and x2 = 0
+			M case4 = b2AndW(b2GreaterEqualW(bx, zero), b2GreaterEqualW(by, zero));
+
+			F xx = b2SelectW(case1, x1x, b2SelectW(case2, x2x, zero));
+			F xy = b2SelectW(case1, x1y, b2SelectW(case2, zero, b2SelectW(case3, x3y, zero)));
+			M solved = b2OrW(b2OrW(case1, case2), b2OrW(case3, case4));
+
+			// Get the incremental impulse
+			F dx = xx - a1;
+			F dy = xy - a2;
+
+			// Apply incremental impulse
+			F P1x = dx * nx, P1y = dx * ny;
+			F P2x = dy * nx, P2y = dy * ny;
+			F bvAx = vAx - mA * (P1x + P2x);
+			F bvAy = vAy - mA * (P1y + P2y);
+			F bwA = wA - iA * ((r1Ax * P1y - r1Ay * P1x) + (r2Ax * P2y - r2Ay * P2x));
+
+			F bvBx = vBx + mB * (P1x + P2x);
+			F bvBy = vBy + mB * (P1y + P2y);
+			F bwB = wB + iB * ((r1Bx * P1y - r1By * P1x) + (r2Bx * P2y - r2By * P2x));
+
+			// When no case is valid the scalar solver gives up and changes nothing.
+			bvAx = b2SelectW(solved, bvAx, vAx);
+			bvAy = b2SelectW(solved, bvAy, vAy);
+			bwA = b2SelectW(solved, bwA, wA);
+			bvBx = b2SelectW(solved, bvBx, vBx);
+			bvBy = b2SelectW(solved, bvBy, vBy);
+			bwB = b2SelectW(solved, bwB, wB);
+			xx = b2SelectW(solved, xx, a1);
+			xy = b2SelectW(solved, xy, a2);
+
+			M block = b2GreaterEqualW(F::Load(bundle->blockSolve), one);
+			vAx = b2SelectW(block, bvAx, svAx);
+			vAy = b2SelectW(block, bvAy, svAy);
+			wA = b2SelectW(block, bwA, swA);
+			vBx = b2SelectW(block, bvBx, svBx);
+			vBy = b2SelectW(block, bvBy, svBy);
+			wB = b2SelectW(block, bwB, swB);
+
+			// Accumulate
+			b2StoreW(b2SelectW(block, xx, sx[0]), cp1->normalImpulse);
+			b2StoreW(b2SelectW(block, xy, sx[1]), cp2->normalImpulse);
+		}
+
+		b2StoreW(vAx, gather[0]);
+		b2StoreW(vAy, gather[1]);
+		b2StoreW(wA, gather[2]);
+		b2StoreW(vBx, gather[3]);
+		b2StoreW(vBy, gather[4]);
+		b2StoreW(wB, gather[5]);
+
+		// Static and kinematic bodies can be in several lanes, and the solver never changes
+		// their velocity, so only dynamic bodies are written back.
+		for (int32 l = 0; l < W; ++l)
+		{
+			int32 indexA = bundle->indexA[l];
+			int32 indexB = bundle->indexB[l];
+			if (indexA >= 0 && (bundle->invMassA[l] > 0.0f || bundle->invIA[l] > 0.0f))
+			{
+				velocities.vx[indexA] = gather[0][l];
+				velocities.vy[indexA] = gather[1][l];
+				velocities.w[indexA] = gather[2][l];
+			}
+
+			if (indexB >= 0 && (bundle->invMassB[l] > 0.0f || bundle->invIB[l] > 0.0f))
+			{
+				velocities.vx[indexB] = gather[3][l];
+				velocities.vy[indexB] = gather[4][l];
+				velocities.w[indexB] = gather[5][l];
+			}
+		}
+	}
+}
+
+#endif
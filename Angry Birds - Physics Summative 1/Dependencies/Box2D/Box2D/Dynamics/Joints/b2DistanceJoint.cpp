@@ -61,8 +61,8 @@ b2DistanceJoint::b2DistanceJoint(const b2DistanceJointDef* def)
 
 void b2DistanceJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexA = m_bodyA->m_islandIndex;
-	m_indexB = m_bodyB->m_islandIndex;
+	m_indexA = m_bodyA->GetIslandIndex(data.sharedSlots);
+	m_indexB = m_bodyB->GetIslandIndex(data.sharedSlots);
 	m_localCenterA = m_bodyA->m_sweep.localCenter;
 	m_localCenterB = m_bodyB->m_sweep.localCenter;
 	m_invMassA = m_bodyA->m_invMass;
@@ -70,15 +70,15 @@ void b2DistanceJoint::InitVelocityConstraints(const b2SolverData& data)
 	m_invIA = m_bodyA->m_invI;
 	m_invIB = m_bodyB->m_invI;
 
-	b2Vec2 cA = data.positions[m_indexA].c;
-	float32 aA = data.positions[m_indexA].a;
-	b2Vec2 vA = data.velocities[m_indexA].v;
-	float32 wA = data.velocities[m_indexA].w;
+	b2Vec2 cA = data.positions.GetCenter(m_indexA);
+	float32 aA = data.positions.a[m_indexA];
+	b2Vec2 vA = data.velocities.GetLinear(m_indexA);
+	float32 wA = data.velocities.w[m_indexA];
 
-	b2Vec2 cB = data.positions[m_indexB].c;
-	float32 aB = data.positions[m_indexB].a;
-	b2Vec2 vB = data.velocities[m_indexB].v;
-	float32 wB = data.velocities[m_indexB].w;
+	b2Vec2 cB = data.positions.GetCenter(m_indexB);
+	float32 aB = data.positions.a[m_indexB];
+	b2Vec2 vB = data.velocities.GetLinear(m_indexB);
+	float32 wB = data.velocities.w[m_indexB];
 
 	b2Rot qA(aA), qB(aB);
 
@@ -148,18 +148,23 @@ void b2DistanceJoint::InitVelocityConstraints(const b2SolverData& data)
 		m_impulse = 0.0f;
 	}
 
-	data.velocities[m_indexA].v = vA;
-	data.velocities[m_indexA].w = wA;
-	data.velocities[m_indexB].v = vB;
-	data.velocities[m_indexB].w = wB;
+	data.velocities.SetLinear(m_indexA, vA);
+	data.velocities.w[m_indexA] = wA;
+	data.velocities.SetLinear(m_indexB, vB);
+	data.velocities.w[m_indexB] = wB;
 }
 
 void b2DistanceJoint::SolveVelocityConstraints(const b2SolverData& data)
 {
-	b2Vec2 vA = data.velocities[m_indexA].v;
-	float32 wA = data.velocities[m_indexA].w;
-	b2Vec2 vB = data.velocities[m_indexB].v;
-	float32 wB = data.velocities[m_indexB].w;
+	if (m_chained)
+	{
+		return;
+	}
+
+	b2Vec2 vA = data.velocities.GetLinear(m_indexA);
+	float32 wA = data.velocities.w[m_indexA];
+	b2Vec2 vB = data.velocities.GetLinear(m_indexB);
+	float32 wB = data.velocities.w[m_indexB];
 
 	// Cdot = dot(u, v + cross(w, r))
 	b2Vec2 vpA = vA + b2Cross(wA, m_rA);
@@ -175,10 +180,10 @@ void b2DistanceJoint::SolveVelocityConstraints(const b2SolverData& data)
 	vB += m_invMassB * P;
 	wB += m_invIB * b2Cross(m_rB, P);
 
-	data.velocities[m_indexA].v = vA;
-	data.velocities[m_indexA].w = wA;
-	data.velocities[m_indexB].v = vB;
-	data.velocities[m_indexB].w = wB;
+	data.velocities.SetLinear(m_indexA, vA);
+	data.velocities.w[m_indexA] = wA;
+	data.velocities.SetLinear(m_indexB, vB);
+	data.velocities.w[m_indexB] = wB;
 }
 
 bool b2DistanceJoint::SolvePositionConstraints(const b2SolverData& data)
@@ -189,10 +194,10 @@ bool b2DistanceJoint::SolvePositionConstraints(const b2SolverData& data)
 		return true;
 	}
 
-	b2Vec2 cA = data.positions[m_indexA].c;
-	float32 aA = data.positions[m_indexA].a;
-	b2Vec2 cB = data.positions[m_indexB].c;
-	float32 aB = data.positions[m_indexB].a;
+	b2Vec2 cA = data.positions.GetCenter(m_indexA);
+	float32 aA = data.positions.a[m_indexA];
+	b2Vec2 cB = data.positions.GetCenter(m_indexB);
+	float32 aB = data.positions.a[m_indexB];
 
 	b2Rot qA(aA), qB(aB);
 
@@ -212,10 +217,10 @@ bool b2DistanceJoint::SolvePositionConstraints(const b2SolverData& data)
 	cB += m_invMassB * P;
 	aB += m_invIB * b2Cross(rB, P);
 
-	data.positions[m_indexA].c = cA;
-	data.positions[m_indexA].a = aA;
-	data.positions[m_indexB].c = cB;
-	data.positions[m_indexB].a = aB;
+	data.positions.SetCenter(m_indexA, cA);
+	data.positions.a[m_indexA] = aA;
+	data.positions.SetCenter(m_indexB, cB);
+	data.positions.a[m_indexB] = aB;
 
 	return b2Abs(C) < b2_linearSlop;
 }
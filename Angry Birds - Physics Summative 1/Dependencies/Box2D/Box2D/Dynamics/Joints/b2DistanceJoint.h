@@ -104,6 +104,7 @@ public:
 protected:
 
 	friend class b2Joint;
+	friend class b2JointChainSolver;
 	b2DistanceJoint(const b2DistanceJointDef* data);
 
 	void InitVelocityConstraints(const b2SolverData& data);
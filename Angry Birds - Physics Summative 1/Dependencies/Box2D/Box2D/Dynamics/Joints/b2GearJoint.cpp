@@ -130,10 +130,10 @@ b2GearJoint::b2GearJoint(const b2GearJointDef* def)
 
 void b2GearJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexA = m_bodyA->m_islandIndex;
-	m_indexB = m_bodyB->m_islandIndex;
-	m_indexC = m_bodyC->m_islandIndex;
-	m_indexD = m_bodyD->m_islandIndex;
+	m_indexA = m_bodyA->GetIslandIndex(data.sharedSlots);
+	m_indexB = m_bodyB->GetIslandIndex(data.sharedSlots);
+	m_indexC = m_bodyC->GetIslandIndex(data.sharedSlots);
+	m_indexD = m_bodyD->GetIslandIndex(data.sharedSlots);
 	m_lcA = m_bodyA->m_sweep.localCenter;
 	m_lcB = m_bodyB->m_sweep.localCenter;
 	m_lcC = m_bodyC->m_sweep.localCenter;
@@ -147,21 +147,21 @@ void b2GearJoint::InitVelocityConstraints(const b2SolverData& data)
 	m_iC = m_bodyC->m_invI;
 	m_iD = m_bodyD->m_invI;
 
-	float32 aA = data.positions[m_indexA].a;
-	b2Vec2 vA = data.velocities[m_indexA].v;
-	float32 wA = data.velocities[m_indexA].w;
+	float32 aA = data.positions.a[m_indexA];
+	b2Vec2 vA = data.velocities.GetLinear(m_indexA);
+	float32 wA = data.velocities.w[m_indexA];
 
-	float32 aB = data.positions[m_indexB].a;
-	b2Vec2 vB = data.velocities[m_indexB].v;
-	float32 wB = data.velocities[m_indexB].w;
+	float32 aB = data.positions.a[m_indexB];
+	b2Vec2 vB = data.velocities.GetLinear(m_indexB);
+	float32 wB = data.velocities.w[m_indexB];
 
-	float32 aC = data.positions[m_indexC].a;
-	b2Vec2 vC = data.velocities[m_indexC].v;
-	float32 wC = data.velocities[m_indexC].w;
+	float32 aC = data.positions.a[m_indexC];
+	b2Vec2 vC = data.velocities.GetLinear(m_indexC);
+	float32 wC = data.velocities.w[m_indexC];
 
-	float32 aD = data.positions[m_indexD].a;
-	b2Vec2 vD = data.velocities[m_indexD].v;
-	float32 wD = data.velocities[m_indexD].w;
+	float32 aD = data.positions.a[m_indexD];
+	b2Vec2 vD = data.velocities.GetLinear(m_indexD);
+	float32 wD = data.velocities.w[m_indexD];
 
 	b2Rot qA(aA), qB(aB), qC(aC), qD(aD);
 
@@ -222,26 +222,26 @@ void b2GearJoint::InitVelocityConstraints(const b2SolverData& data)
 		m_impulse = 0.0f;
 	}
 
-	data.velocities[m_indexA].v = vA;
-	data.velocities[m_indexA].w = wA;
-	data.velocities[m_indexB].v = vB;
-	data.velocities[m_indexB].w = wB;
-	data.velocities[m_indexC].v = vC;
-	data.velocities[m_indexC].w = wC;
-	data.velocities[m_indexD].v = vD;
-	data.velocities[m_indexD].w = wD;
+	data.velocities.SetLinear(m_indexA, vA);
+	data.velocities.w[m_indexA] = wA;
+	data.velocities.SetLinear(m_indexB, vB);
+	data.velocities.w[m_indexB] = wB;
+	data.velocities.SetLinear(m_indexC, vC);
+	data.velocities.w[m_indexC] = wC;
+	data.velocities.SetLinear(m_indexD, vD);
+	data.velocities.w[m_indexD] = wD;
 }
 
 void b2GearJoint::SolveVelocityConstraints(const b2SolverData& data)
 {
-	b2Vec2 vA = data.velocities[m_indexA].v;
-	float32 wA = data.velocities[m_indexA].w;
-	b2Vec2 vB = data.velocities[m_indexB].v;
-	float32 wB = data.velocities[m_indexB].w;
-	b2Vec2 vC = data.velocities[m_indexC].v;
-	float32 wC = data.velocities[m_indexC].w;
-	b2Vec2 vD = data.velocities[m_indexD].v;
-	float32 wD = data.velocities[m_indexD].w;
+	b2Vec2 vA = data.velocities.GetLinear(m_indexA);
+	float32 wA = data.velocities.w[m_indexA];
+	b2Vec2 vB = data.velocities.GetLinear(m_indexB);
+	float32 wB = data.velocities.w[m_indexB];
+	b2Vec2 vC = data.velocities.GetLinear(m_indexC);
+	float32 wC = data.velocities.w[m_indexC];
+	b2Vec2 vD = data.velocities.GetLinear(m_indexD);
+	float32 wD = data.velocities.w[m_indexD];
 
 	float32 Cdot = b2Dot(m_JvAC, vA - vC) + b2Dot(m_JvBD, vB - vD);
 	Cdot += (m_JwA * wA - m_JwC * wC) + (m_JwB * wB - m_JwD * wD);
@@ -258,26 +258,26 @@ void b2GearJoint::SolveVelocityConstraints(const b2SolverData& data)
 	vD -= (m_mD * impulse) * m_JvBD;
 	wD -= m_iD * impulse * m_JwD;
 
-	data.velocities[m_indexA].v = vA;
-	data.velocities[m_indexA].w = wA;
-	data.velocities[m_indexB].v = vB;
-	data.velocities[m_indexB].w = wB;
-	data.velocities[m_indexC].v = vC;
-	data.velocities[m_indexC].w = wC;
-	data.velocities[m_indexD].v = vD;
-	data.velocities[m_indexD].w = wD;
+	data.velocities.SetLinear(m_indexA, vA);
+	data.velocities.w[m_indexA] = wA;
+	data.velocities.SetLinear(m_indexB, vB);
+	data.velocities.w[m_indexB] = wB;
+	data.velocities.SetLinear(m_indexC, vC);
+	data.velocities.w[m_indexC] = wC;
+	data.velocities.SetLinear(m_indexD, vD);
+	data.velocities.w[m_indexD] = wD;
 }
 
 bool b2GearJoint::SolvePositionConstraints(const b2SolverData& data)
 {
-	b2Vec2 cA = data.positions[m_indexA].c;
-	float32 aA = data.positions[m_indexA].a;
-	b2Vec2 cB = data.positions[m_indexB].c;
-	float32 aB = data.positions[m_indexB].a;
-	b2Vec2 cC = data.positions[m_indexC].c;
-	float32 aC = data.positions[m_indexC].a;
-	b2Vec2 cD = data.positions[m_indexD].c;
-	float32 aD = data.positions[m_indexD].a;
+	b2Vec2 cA = data.positions.GetCenter(m_indexA);
+	float32 aA = data.positions.a[m_indexA];
+	b2Vec2 cB = data.positions.GetCenter(m_indexB);
+	float32 aB = data.positions.a[m_indexB];
+	b2Vec2 cC = data.positions.GetCenter(m_indexC);
+	float32 aC = data.positions.a[m_indexC];
+	b2Vec2 cD = data.positions.GetCenter(m_indexD);
+	float32 aD = data.positions.a[m_indexD];
 
 	b2Rot qA(aA), qB(aB), qC(aC), qD(aD);
 
@@ -354,14 +354,14 @@ bool b2GearJoint::SolvePositionConstraints(const b2SolverData& data)
 	cD -= m_mD * impulse * JvBD;
 	aD -= m_iD * impulse * JwD;
 
-	data.positions[m_indexA].c = cA;
-	data.positions[m_indexA].a = aA;
-	data.positions[m_indexB].c = cB;
-	data.positions[m_indexB].a = aB;
-	data.positions[m_indexC].c = cC;
-	data.positions[m_indexC].a = aC;
-	data.positions[m_indexD].c = cD;
-	data.positions[m_indexD].a = aD;
+	data.positions.SetCenter(m_indexA, cA);
+	data.positions.a[m_indexA] = aA;
+	data.positions.SetCenter(m_indexB, cB);
+	data.positions.a[m_indexB] = aB;
+	data.positions.SetCenter(m_indexC, cC);
+	data.positions.a[m_indexC] = aC;
+	data.positions.SetCenter(m_indexD, cD);
+	data.positions.a[m_indexD] = aD;
 
 	// TODO_ERIN not implemented
 	return linearError < b2_linearSlop;
@@ -192,6 +192,10 @@ b2Joint::b2Joint(const b2JointDef* def)
 	m_index = 0;
 	m_collideConnected = def->collideConnected;
 	m_islandFlag = false;
+	m_chained = false;
+	m_island = NULL;
+	m_islandPrev = NULL;
+	m_islandNext = NULL;
 	m_userData = def->userData;
 
 	m_edgeA.joint = NULL;
@@ -25,6 +25,7 @@ class b2Body;
 class b2Joint;
 struct b2SolverData;
 class b2BlockAllocator;
+struct b2PersistentIsland;
 
 enum b2JointType
 {
@@ -153,7 +154,9 @@ protected:
 	friend class b2World;
 	friend class b2Body;
 	friend class b2Island;
+	friend class b2IslandManager;
 	friend class b2GearJoint;
+	friend class b2JointChainSolver;
 
 	static b2Joint* Create(const b2JointDef* def, b2BlockAllocator* allocator);
 	static void Destroy(b2Joint* joint, b2BlockAllocator* allocator);
@@ -175,10 +178,16 @@ protected:
 	b2Body* m_bodyA;
 	b2Body* m_bodyB;
 
+	// The persistent island of a joint between active bodies.
+	b2PersistentIsland* m_island;
+	b2Joint* m_islandPrev;
+	b2Joint* m_islandNext;
+
 	int32 m_index;
 
 	bool m_islandFlag;
 	bool m_collideConnected;
+	bool m_chained;		// b2JointChainSolver solves the point or length velocity rows this step
 
 	void* m_userData;
 };
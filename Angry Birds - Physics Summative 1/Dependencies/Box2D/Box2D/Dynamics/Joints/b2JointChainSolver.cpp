@@ -0,0 +1,413 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/Joints/b2JointChainSolver.h>
+#include <Box2D/Dynamics/Joints/b2DistanceJoint.h>
+#include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Common/b2StackAllocator.h>
+
+// A chain of m joints couples its bodies only through the bodies shared by neighbouring
+// joints, so the effective mass J * invM * JT is block tridiagonal:
+//
+// A = [D0 U0          ]
+//     [U0' D1 U1      ]
+//     [    U1' D2 ... ]
+//
+// Dk is the 2x2 effective mass of joint k and Uk = Jk,s * invMs * Jk+1,s' couples joints k
+// and k + 1 through their shared body s. A is symmetric positive definite, so block Gaussian
+// elimination without pivoting (the Thomas algorithm) is stable:
+//
+// D'0 = D0, D'k = Dk - Uk-1' * Ck-1, Ck = inv(D'k) * Uk
+// dk = inv(D'k) * (bk - Uk-1' * dk-1)
+// lambda_m-1 = d_m-1, lambda_k = dk - Ck * lambda_k+1
+
+// Revolute joints with a limit solve the limit and the point constraint as one block, and
+// soft distance joints carry a spring term in their velocity row, so those stay with their own solvers.
+static bool b2IsChainJoint(b2Joint* joint)
+{
+	if (joint->GetBodyA() == joint->GetBodyB())
+	{
+		return false;
+	}
+
+	switch (joint->GetType())
+	{
+	case e_revoluteJoint:
+		return ((b2RevoluteJoint*)joint)->IsLimitEnabled() == false;
+
+	case e_distanceJoint:
+		return ((b2DistanceJoint*)joint)->GetFrequency() == 0.0f;
+
+	default:
+		return false;
+	}
+}
+
+static int32 b2OtherChainJoint(const int32* adjacency, int32 bodyIndex, int32 jointIndex)
+{
+	int32 first = adjacency[2 * bodyIndex + 0];
+	return first == jointIndex ? adjacency[2 * bodyIndex + 1] : first;
+}
+
+static b2Body* b2OtherBody(b2Joint* joint, b2Body* body)
+{
+	return joint->GetBodyA() == body ? joint->GetBodyB() : joint->GetBodyA();
+}
+
+// Only a dynamic body with exactly two chain joints continues a chain. Static bodies always
+// end one, so their degree is never counted. That keeps the lookups to the island's own
+// bodies, whose island index is their slot even when the statics are shared.
+bool b2JointChainSolver::ContinuesChain(const b2Body* body, const int32* degrees)
+{
+	return body->GetType() == b2_dynamicBody && degrees[body->m_islandIndex] == 2;
+}
+
+b2JointChainSolver::b2JointChainSolver(b2Joint** joints, int32 jointCount, int32 bodyCount, b2StackAllocator* allocator)
+{
+	m_allocator = allocator;
+	m_links = (b2JointChainLink*)m_allocator->Allocate(jointCount * sizeof(b2JointChainLink));
+	m_chainStarts = (int32*)m_allocator->Allocate((jointCount + 1) * sizeof(int32));
+	m_rhs = (b2Vec2*)m_allocator->Allocate(jointCount * sizeof(b2Vec2));
+	m_linkCount = 0;
+	m_chainCount = 0;
+
+	// Count the chain joints at each body and keep the first two.
+	int32* degrees = (int32*)m_allocator->Allocate(bodyCount * sizeof(int32));
+	int32* adjacency = (int32*)m_allocator->Allocate(2 * bodyCount * sizeof(int32));
+	bool* visited = (bool*)m_allocator->Allocate(jointCount * sizeof(bool));
+
+	// Only the dynamic bodies of chain joints are looked up, so only their degrees are cleared.
+	for (int32 i = 0; i < jointCount; ++i)
+	{
+		b2Joint* joint = joints[i];
+		joint->m_chained = false;
+		visited[i] = b2IsChainJoint(joint) == false;
+		if (visited[i])
+		{
+			continue;
+		}
+
+		b2Body* bodies[2] = { joint->GetBodyA(), joint->GetBodyB() };
+		for (int32 j = 0; j < 2; ++j)
+		{
+			if (bodies[j]->GetType() == b2_dynamicBody)
+			{
+				degrees[bodies[j]->m_islandIndex] = 0;
+			}
+		}
+	}
+
+	for (int32 i = 0; i < jointCount; ++i)
+	{
+		if (visited[i])
+		{
+			continue;
+		}
+
+		b2Joint* joint = joints[i];
+		b2Body* bodies[2] = { joint->GetBodyA(), joint->GetBodyB() };
+		for (int32 j = 0; j < 2; ++j)
+		{
+			if (bodies[j]->GetType() != b2_dynamicBody)
+			{
+				continue;
+			}
+
+			int32 index = bodies[j]->m_islandIndex;
+			if (degrees[index] < 2)
+			{
+				adjacency[2 * index + degrees[index]] = i;
+			}
+			++degrees[index];
+		}
+	}
+
+	for (int32 i = 0; i < jointCount; ++i)
+	{
+		if (visited[i])
+		{
+			continue;
+		}
+
+		// Walk back to the head of the chain.
+		int32 head = i;
+		b2Body* outer = joints[i]->GetBodyA();
+		bool closed = false;
+		while (ContinuesChain(outer, degrees))
+		{
+			int32 previous = b2OtherChainJoint(adjacency, outer->m_islandIndex, head);
+			if (previous == i)
+			{
+				closed = true;
+				break;
+			}
+
+			head = previous;
+			outer = b2OtherBody(joints[head], outer);
+		}
+
+		// Walk forward and collect the links in order.
+		int32 start = m_linkCount;
+		int32 current = head;
+		b2Body* body = b2OtherBody(joints[head], outer);
+		visited[head] = true;
+		m_links[m_linkCount++].joint = joints[head];
+		while (ContinuesChain(body, degrees))
+		{
+			int32 next = b2OtherChainJoint(adjacency, body->m_islandIndex, current);
+			if (visited[next])
+			{
+				break;
+			}
+
+			visited[next] = true;
+			m_links[m_linkCount - 1].nextSharesB = joints[current]->GetBodyB() == body;
+			m_links[m_linkCount++].joint = joints[next];
+			current = next;
+			body = b2OtherBody(joints[next], body);
+		}
+
+		// A closed loop couples its last joint to its first one, which the tridiagonal
+		// solve cannot express. The last joint is left to its own solver.
+		if (closed)
+		{
+			--m_linkCount;
+		}
+
+		if (m_linkCount - start < b2_minChainLinks)
+		{
+			m_linkCount = start;
+			continue;
+		}
+
+		m_chainStarts[m_chainCount++] = start;
+		for (int32 j = start; j < m_linkCount; ++j)
+		{
+			m_links[j].joint->m_chained = true;
+		}
+	}
+
+	m_chainStarts[m_chainCount] = m_linkCount;
+
+	m_allocator->Free(visited);
+	m_allocator->Free(adjacency);
+	m_allocator->Free(degrees);
+}
+
+b2JointChainSolver::~b2JointChainSolver()
+{
+	for (int32 i = 0; i < m_linkCount; ++i)
+	{
+		m_links[i].joint->m_chained = false;
+	}
+
+	m_allocator->Free(m_rhs);
+	m_allocator->Free(m_chainStarts);
+	m_allocator->Free(m_links);
+}
+
+// Point constraint rows: Cdot = vB + cross(wB, rB) - vA - cross(wA, rA)
+static void b2SetPointRows(b2JointChainLink* link, const b2Vec2& rA, const b2Vec2& rB)
+{
+	link->JA[0].Set(-1.0f, 0.0f, rA.y);
+	link->JA[1].Set(0.0f, -1.0f, -rA.x);
+	link->JB[0].Set(1.0f, 0.0f, -rB.y);
+	link->JB[1].Set(0.0f, 1.0f, rB.x);
+	link->rowCount = 2;
+}
+
+// Length constraint row: Cdot = dot(u, vB + cross(wB, rB) - vA - cross(wA, rA))
+static void b2SetLengthRow(b2JointChainLink* link, const b2Vec2& rA, const b2Vec2& rB, const b2Vec2& u)
+{
+	link->JA[0].Set(-u.x, -u.y, -b2Cross(rA, u));
+	link->JA[1].SetZero();
+	link->JB[0].Set(u.x, u.y, b2Cross(rB, u));
+	link->JB[1].SetZero();
+	link->rowCount = 1;
+}
+
+// Row a times the inverse mass times row b.
+inline float32 b2MassDot(const b2Vec3& a, float32 invMass, float32 invI, const b2Vec3& b)
+{
+	return invMass * (a.x * b.x + a.y * b.y) + invI * a.z * b.z;
+}
+
+void b2JointChainSolver::InitVelocityConstraints(const b2SolverData& data)
+{
+	B2_NOT_USED(data);
+
+	for (int32 i = 0; i < m_linkCount; ++i)
+	{
+		b2JointChainLink* link = m_links + i;
+		b2Joint* joint = link->joint;
+
+		if (joint->GetType() == e_revoluteJoint)
+		{
+			b2RevoluteJoint* revolute = (b2RevoluteJoint*)joint;
+			link->indexA = revolute->m_indexA;
+			link->indexB = revolute->m_indexB;
+			link->invMassA = revolute->m_invMassA;
+			link->invMassB = revolute->m_invMassB;
+			link->invIA = revolute->m_invIA;
+			link->invIB = revolute->m_invIB;
+			b2SetPointRows(link, revolute->m_rA, revolute->m_rB);
+		}
+		else
+		{
+			b2DistanceJoint* distance = (b2DistanceJoint*)joint;
+			link->indexA = distance->m_indexA;
+			link->indexB = distance->m_indexB;
+			link->invMassA = distance->m_invMassA;
+			link->invMassB = distance->m_invMassB;
+			link->invIA = distance->m_invIA;
+			link->invIB = distance->m_invIB;
+			b2SetLengthRow(link, distance->m_rA, distance->m_rB, distance->m_u);
+		}
+	}
+
+	// The effective masses do not change during the velocity iterations.
+	for (int32 i = 0; i < m_chainCount; ++i)
+	{
+		int32 start = m_chainStarts[i];
+		FactorChain(m_links + start, m_chainStarts[i + 1] - start);
+	}
+}
+
+void b2JointChainSolver::FactorChain(b2JointChainLink* links, int32 count)
+{
+	for (int32 k = 0; k < count; ++k)
+	{
+		b2JointChainLink* link = links + k;
+		float32 mA = link->invMassA, mB = link->invMassB;
+		float32 iA = link->invIA, iB = link->invIB;
+
+		b2Mat22 D;
+		D.ex.x = b2MassDot(link->JA[0], mA, iA, link->JA[0]) + b2MassDot(link->JB[0], mB, iB, link->JB[0]);
+		D.ex.y = b2MassDot(link->JA[1], mA, iA, link->JA[0]) + b2MassDot(link->JB[1], mB, iB, link->JB[0]);
+		D.ey.x = D.ex.y;
+		D.ey.y = b2MassDot(link->JA[1], mA, iA, link->JA[1]) + b2MassDot(link->JB[1], mB, iB, link->JB[1]);
+
+		// Empty rows solve to zero.
+		if (D.ex.x == 0.0f)
+		{
+			D.ex.x = 1.0f;
+		}
+
+		if (link->rowCount == 1)
+		{
+			D.ey.y = 1.0f;
+		}
+
+		if (k > 0)
+		{
+			const b2JointChainLink* previous = links + k - 1;
+			b2Mat22 P = b2MulT(previous->U, previous->C);
+			D.ex -= P.ex;
+			D.ey -= P.ey;
+		}
+
+		link->invD = D.GetInverse();
+
+		if (k == count - 1)
+		{
+			break;
+		}
+
+		// Couple with the next link through the shared body.
+		const b2JointChainLink* next = links + k + 1;
+		int32 shared = link->nextSharesB ? link->indexB : link->indexA;
+		const b2Vec3* J1 = link->nextSharesB ? link->JB : link->JA;
+		float32 m = link->nextSharesB ? mB : mA;
+		float32 I = link->nextSharesB ? iB : iA;
+		const b2Vec3* J2 = next->indexB == shared ? next->JB : next->JA;
+
+		link->U.ex.x = b2MassDot(J1[0], m, I, J2[0]);
+		link->U.ex.y = b2MassDot(J1[1], m, I, J2[0]);
+		link->U.ey.x = b2MassDot(J1[0], m, I, J2[1]);
+		link->U.ey.y = b2MassDot(J1[1], m, I, J2[1]);
+		link->C = b2Mul(link->invD, link->U);
+	}
+}
+
+void b2JointChainSolver::SolveChain(b2JointChainLink* links, int32 count, const b2Vec2* rhs)
+{
+	// Forward elimination, the lambdas hold the intermediate solution.
+	links[0].lambda = b2Mul(links[0].invD, rhs[0]);
+	for (int32 k = 1; k < count; ++k)
+	{
+		const b2JointChainLink* previous = links + k - 1;
+		links[k].lambda = b2Mul(links[k].invD, rhs[k] - b2MulT(previous->U, previous->lambda));
+	}
+
+	// Back substitution.
+	for (int32 k = count - 2; k >= 0; --k)
+	{
+		links[k].lambda -= b2Mul(links[k].C, links[k + 1].lambda);
+	}
+}
+
+void b2JointChainSolver::SolveVelocityConstraints(const b2SolverData& data)
+{
+	for (int32 i = 0; i < m_chainCount; ++i)
+	{
+		int32 start = m_chainStarts[i];
+		int32 count = m_chainStarts[i + 1] - start;
+		b2JointChainLink* links = m_links + start;
+
+		for (int32 k = 0; k < count; ++k)
+		{
+			const b2JointChainLink* link = links + k;
+			b2Vec3 vA(data.velocities.vx[link->indexA], data.velocities.vy[link->indexA], data.velocities.w[link->indexA]);
+			b2Vec3 vB(data.velocities.vx[link->indexB], data.velocities.vy[link->indexB], data.velocities.w[link->indexB]);
+			m_rhs[k].x = -b2Dot(link->JA[0], vA) - b2Dot(link->JB[0], vB);
+			m_rhs[k].y = -b2Dot(link->JA[1], vA) - b2Dot(link->JB[1], vB);
+		}
+
+		SolveChain(links, count, m_rhs);
+
+		for (int32 k = 0; k < count; ++k)
+		{
+			const b2JointChainLink* link = links + k;
+			b2Vec2 lambda = link->lambda;
+
+			b2Vec3 PA = lambda.x * link->JA[0] + lambda.y * link->JA[1];
+			b2Vec3 PB = lambda.x * link->JB[0] + lambda.y * link->JB[1];
+
+			b2Vec2 vA = data.velocities.GetLinear(link->indexA);
+			b2Vec2 vB = data.velocities.GetLinear(link->indexB);
+			data.velocities.SetLinear(link->indexA, vA + link->invMassA * b2Vec2(PA.x, PA.y));
+			data.velocities.w[link->indexA] += link->invIA * PA.z;
+			data.velocities.SetLinear(link->indexB, vB + link->invMassB * b2Vec2(PB.x, PB.y));
+			data.velocities.w[link->indexB] += link->invIB * PB.z;
+
+			// Keep the accumulated impulse in the joint for warm starting and reaction forces.
+			if (link->joint->GetType() == e_revoluteJoint)
+			{
+				b2RevoluteJoint* revolute = (b2RevoluteJoint*)link->joint;
+				revolute->m_impulse.x += lambda.x;
+				revolute->m_impulse.y += lambda.y;
+			}
+			else
+			{
+				b2DistanceJoint* distance = (b2DistanceJoint*)link->joint;
+				distance->m_impulse += lambda.x;
+			}
+		}
+	}
+}
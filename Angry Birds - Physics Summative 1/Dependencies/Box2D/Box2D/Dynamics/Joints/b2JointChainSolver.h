@@ -0,0 +1,83 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_JOINT_CHAIN_SOLVER_H
+#define B2_JOINT_CHAIN_SOLVER_H
+
+#include <Box2D/Common/b2Math.h>
+#include <Box2D/Dynamics/b2TimeStep.h>
+
+class b2Body;
+class b2Joint;
+class b2StackAllocator;
+
+/// Chains shorter than this are left to the joints' own solvers.
+#define b2_minChainLinks	2
+
+/// One joint of a chain. Joint k of a chain shares one dynamic body with joint k + 1. The
+/// joint's equality rows are stored as Jacobian rows (x, y, angular) for both of its bodies,
+/// a distance joint uses one row and leaves the second one empty.
+struct b2JointChainLink
+{
+	b2Joint* joint;
+	int32 indexA;
+	int32 indexB;
+	float32 invMassA, invMassB;
+	float32 invIA, invIB;
+	b2Vec3 JA[2];
+	b2Vec3 JB[2];
+	int32 rowCount;
+	bool nextSharesB;		// the body shared with the next link is this joint's body B
+	b2Mat22 invD;			// inverse of the eliminated diagonal block
+	b2Mat22 U;				// coupling with the next link
+	b2Mat22 C;				// invD * U
+	b2Vec2 lambda;
+};
+
+/// Solves chains of revolute joints without limits and rigid distance joints directly, with
+/// a block tridiagonal (Thomas) solve that is linear in the chain length. A sequential solver
+/// moves a correction along a chain one joint per iteration, so long chains such as ropes
+/// stretch unless the iteration count is high. Only the velocity constraints are solved
+/// here: the chained joints still solve their motors and their own position correction,
+/// since a full linearized position step overshoots on fast swinging chains.
+class b2JointChainSolver
+{
+public:
+	b2JointChainSolver(b2Joint** joints, int32 jointCount, int32 bodyCount, b2StackAllocator* allocator);
+	~b2JointChainSolver();
+
+	/// Build the chain matrices. Call after the joints initialized their velocity constraints.
+	void InitVelocityConstraints(const b2SolverData& data);
+	void SolveVelocityConstraints(const b2SolverData& data);
+
+	int32 GetChainCount() const { return m_chainCount; }
+
+private:
+	static bool ContinuesChain(const b2Body* body, const int32* degrees);
+	static void FactorChain(b2JointChainLink* links, int32 count);
+	static void SolveChain(b2JointChainLink* links, int32 count, const b2Vec2* rhs);
+
+	b2StackAllocator* m_allocator;
+	b2JointChainLink* m_links;
+	int32* m_chainStarts;
+	b2Vec2* m_rhs;
+	int32 m_linkCount;
+	int32 m_chainCount;
+};
+
+#endif
@@ -60,8 +60,8 @@ b2MotorJoint::b2MotorJoint(const b2MotorJointDef* def)
 
 void b2MotorJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexA = m_bodyA->m_islandIndex;
-	m_indexB = m_bodyB->m_islandIndex;
+	m_indexA = m_bodyA->GetIslandIndex(data.sharedSlots);
+	m_indexB = m_bodyB->GetIslandIndex(data.sharedSlots);
 	m_localCenterA = m_bodyA->m_sweep.localCenter;
 	m_localCenterB = m_bodyB->m_sweep.localCenter;
 	m_invMassA = m_bodyA->m_invMass;
@@ -69,15 +69,15 @@ void b2MotorJoint::InitVelocityConstraints(const b2SolverData& data)
 	m_invIA = m_bodyA->m_invI;
 	m_invIB = m_bodyB->m_invI;
 
-	b2Vec2 cA = data.positions[m_indexA].c;
-	float32 aA = data.positions[m_indexA].a;
-	b2Vec2 vA = data.velocities[m_indexA].v;
-	float32 wA = data.velocities[m_indexA].w;
+	b2Vec2 cA = data.positions.GetCenter(m_indexA);
+	float32 aA = data.positions.a[m_indexA];
+	b2Vec2 vA = data.velocities.GetLinear(m_indexA);
+	float32 wA = data.velocities.w[m_indexA];
 
-	b2Vec2 cB = data.positions[m_indexB].c;
-	float32 aB = data.positions[m_indexB].a;
-	b2Vec2 vB = data.velocities[m_indexB].v;
-	float32 wB = data.velocities[m_indexB].w;
+	b2Vec2 cB = data.positions.GetCenter(m_indexB);
+	float32 aB = data.positions.a[m_indexB];
+	b2Vec2 vB = data.velocities.GetLinear(m_indexB);
+	float32 wB = data.velocities.w[m_indexB];
 
 	b2Rot qA(aA), qB(aB);
 
@@ -132,18 +132,18 @@ void b2MotorJoint::InitVelocityConstraints(const b2SolverData& data)
 		m_angularImpulse = 0.0f;
 	}
 
-	data.velocities[m_indexA].v = vA;
-	data.velocities[m_indexA].w = wA;
-	data.velocities[m_indexB].v = vB;
-	data.velocities[m_indexB].w = wB;
+	data.velocities.SetLinear(m_indexA, vA);
+	data.velocities.w[m_indexA] = wA;
+	data.velocities.SetLinear(m_indexB, vB);
+	data.velocities.w[m_indexB] = wB;
 }
 
 void b2MotorJoint::SolveVelocityConstraints(const b2SolverData& data)
 {
-	b2Vec2 vA = data.velocities[m_indexA].v;
-	float32 wA = data.velocities[m_indexA].w;
-	b2Vec2 vB = data.velocities[m_indexB].v;
-	float32 wB = data.velocities[m_indexB].w;
+	b2Vec2 vA = data.velocities.GetLinear(m_indexA);
+	float32 wA = data.velocities.w[m_indexA];
+	b2Vec2 vB = data.velocities.GetLinear(m_indexB);
+	float32 wB = data.velocities.w[m_indexB];
 
 	float32 mA = m_invMassA, mB = m_invMassB;
 	float32 iA = m_invIA, iB = m_invIB;
@@ -190,10 +190,10 @@ void b2MotorJoint::SolveVelocityConstraints(const b2SolverData& data)
 		wB += iB * b2Cross(m_rB, impulse);
 	}
 
-	data.velocities[m_indexA].v = vA;
-	data.velocities[m_indexA].w = wA;
-	data.velocities[m_indexB].v = vB;
-	data.velocities[m_indexB].w = wB;
+	data.velocities.SetLinear(m_indexA, vA);
+	data.velocities.w[m_indexA] = wA;
+	data.velocities.SetLinear(m_indexB, vB);
+	data.velocities.w[m_indexB] = wB;
 }
 
 bool b2MotorJoint::SolvePositionConstraints(const b2SolverData& data)
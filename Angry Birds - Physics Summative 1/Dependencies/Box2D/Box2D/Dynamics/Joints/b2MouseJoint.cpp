@@ -95,15 +95,15 @@ float32 b2MouseJoint::GetDampingRatio() const
 
 void b2MouseJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-	m_indexB = m_bodyB->m_islandIndex;
+	m_indexB = m_bodyB->GetIslandIndex(data.sharedSlots);
 	m_localCenterB = m_bodyB->m_sweep.localCenter;
 	m_invMassB = m_bodyB->m_invMass;
 	m_invIB = m_bodyB->m_invI;
 
-	b2Vec2 cB = data.positions[m_indexB].c;
-	float32 aB = data.positions[m_indexB].a;
-	b2Vec2 vB = data.velocities[m_indexB].v;
-	float32 wB = data.velocities[m_indexB].w;
+	b2Vec2 cB = data.positions.GetCenter(m_indexB);
+	float32 aB = data.positions.a[m_indexB];
+	b2Vec2 vB = data.velocities.GetLinear(m_indexB);
+	float32 wB = data.velocities.w[m_indexB];
 
 	b2Rot qB(aB);
 
@@ -161,14 +161,14 @@ void b2MouseJoint::InitVelocityConstraints(const b2SolverData& data)
 		m_impulse.SetZero();
 	}
 
-	data.velocities[m_indexB].v = vB;
-	data.velocities[m_indexB].w = wB;
+	data.velocities.SetLinear(m_indexB, vB);
+	data.velocities.w[m_indexB] = wB;
 }
 
 void b2MouseJoint::SolveVelocityConstraints(const b2SolverData& data)
 {
-	b2Vec2 vB = data.velocities[m_indexB].v;
-	float32 wB = data.velocities[m_indexB].w;
+	b2Vec2 vB = data.velocities.GetLinear(m_indexB);
+	float32 wB = data.velocities.w[m_indexB];
 
 	// Cdot = v + cross(w, r)
 	b2Vec2 Cdot = vB + b2Cross(wB, m_rB);
@@ -186,8 +186,8 @@ void b2MouseJoint::SolveVelocityConstraints(const b2SolverData& data)
 	vB += m_invMassB * impulse;
 	wB += m_invIB * b2Cross(m_rB, impulse);
 
-	data.velocities[m_indexB].v = vB;
-	data.velocities[m_indexB].w = wB;
+	data.velocities.SetLinear(m_indexB, vB);
+	data.velocities.w[m_indexB] = wB;
 }
 
 bool b2MouseJoint::SolvePositionConstraints(const b2SolverData& data)
@@ -68,6 +68,9 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 
 	m_jointList = NULL;
 	m_contactList = NULL;
+	m_island = NULL;
+	m_islandPrev = NULL;
+	m_islandNext = NULL;
 	m_prev = NULL;
 	m_next = NULL;
 
@@ -123,6 +126,8 @@ void b2Body::SetType(b2BodyType type)
 		return;
 	}
 
+	m_world->m_islandManager.RemoveBody(this);
+
 	m_type = type;
 
 	ResetMassData();
@@ -161,6 +166,8 @@ void b2Body::SetType(b2BodyType type)
 			broadPhase->TouchProxy(f->m_proxies[i].proxyId);
 		}
 	}
+
+	m_world->m_islandManager.AddBody(this);
 }
 
 b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
@@ -189,6 +196,11 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
 
 	fixture->m_body = this;
 
+	if (fixture->GetType() == b2Shape::e_chain)
+	{
+		++m_world->m_chainFixtureCount;
+	}
+
 	// Adjust mass properties if needed.
 	if (fixture->m_density > 0.0f)
 	{
@@ -273,6 +285,11 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 
 	fixture->m_body = NULL;
 	fixture->m_next = NULL;
+	if (fixture->GetType() == b2Shape::e_chain)
+	{
+		--m_world->m_chainFixtureCount;
+	}
+
 	fixture->Destroy(allocator);
 	fixture->~b2Fixture();
 	allocator->Free(fixture, sizeof(b2Fixture));
@@ -456,6 +473,21 @@ void b2Body::SynchronizeFixtures()
 	}
 }
 
+// Cover the motion from the current transform to where the current velocity takes the
+// body in another step, so speculative contacts exist before the bodies get there.
+void b2Body::SynchronizePredictedFixtures(float32 dt)
+{
+	b2Transform xf2;
+	xf2.q.Set(m_sweep.a + dt * m_angularVelocity);
+	xf2.p = m_sweep.c + dt * m_linearVelocity - b2Mul(xf2.q, m_sweep.localCenter);
+
+	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+	{
+		f->Synchronize(broadPhase, m_xf, xf2);
+	}
+}
+
 void b2Body::SetActive(bool flag)
 {
 	b2Assert(m_world->IsLocked() == false);
@@ -477,9 +509,13 @@ void b2Body::SetActive(bool flag)
 		}
 
 		// Contacts are created the next time step.
+
+		m_world->m_islandManager.AddBody(this);
 	}
 	else
 	{
+		m_world->m_islandManager.RemoveBody(this);
+
 		m_flags &= ~e_activeFlag;
 
 		// Destroy all proxies.
@@ -523,6 +559,11 @@ void b2Body::SetFixedRotation(bool flag)
 	ResetMassData();
 }
 
+void b2Body::WakeIsland()
+{
+	m_world->m_islandManager.WakeIsland(m_island);
+}
+
 void b2Body::Dump()
 {
 	int32 bodyIndex = m_islandIndex;
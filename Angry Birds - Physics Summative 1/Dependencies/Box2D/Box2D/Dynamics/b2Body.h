@@ -29,6 +29,7 @@ class b2Contact;
 class b2Controller;
 class b2World;
 struct b2FixtureDef;
+struct b2PersistentIsland;
 struct b2JointEdge;
 struct b2ContactEdge;
 
@@ -391,8 +392,10 @@ private:
 
 	friend class b2World;
 	friend class b2Island;
+	friend class b2IslandManager;
 	friend class b2ContactManager;
 	friend class b2ContactSolver;
+	friend class b2JointChainSolver;
 	friend class b2Contact;
 	
 	friend class b2DistanceJoint;
@@ -423,6 +426,7 @@ private:
 	~b2Body();
 
 	void SynchronizeFixtures();
+	void SynchronizePredictedFixtures(float32 dt);
 	void SynchronizeTransform();
 
 	// This is used to prevent connected bodies from colliding.
@@ -431,6 +435,13 @@ private:
 
 	void Advance(float32 t);
 
+	// Index of this body in the island being solved. Static bodies shared
+	// between parallel islands are remapped through the island's slot table.
+	int32 GetIslandIndex(const int32* sharedSlots) const;
+
+	// Let the island manager know a body of a sleeping island was woken.
+	void WakeIsland();
+
 	b2BodyType m_type;
 
 	uint16 m_flags;
@@ -456,6 +467,11 @@ private:
 	b2JointEdge* m_jointList;
 	b2ContactEdge* m_contactList;
 
+	// The persistent island of an active dynamic or kinematic body.
+	b2PersistentIsland* m_island;
+	b2Body* m_islandPrev;
+	b2Body* m_islandNext;
+
 	float32 m_mass, m_invMass;
 
 	// Rotational inertia about the center of mass.
@@ -642,6 +658,11 @@ inline void b2Body::SetAwake(bool flag)
 		{
 			m_flags |= e_awakeFlag;
 			m_sleepTime = 0.0f;
+
+			if (m_island)
+			{
+				WakeIsland();
+			}
 		}
 	}
 	else
@@ -860,6 +881,15 @@ inline void b2Body::SynchronizeTransform()
 	m_xf.p = m_sweep.c - b2Mul(m_xf.q, m_sweep.localCenter);
 }
 
+inline int32 b2Body::GetIslandIndex(const int32* sharedSlots) const
+{
+	if (sharedSlots && m_type == b2_staticBody)
+	{
+		return sharedSlots[m_islandIndex];
+	}
+	return m_islandIndex;
+}
+
 inline void b2Body::Advance(float32 alpha)
 {
 	// Advance to the new safe time. This doesn't sync the broad-phase.
@@ -19,12 +19,102 @@
 #include <Box2D/Dynamics/b2ContactManager.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/b2IslandManager.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Dynamics/Contacts/b2CircleContact.h>
+#include <Box2D/Dynamics/Contacts/b2PolygonAndCircleContact.h>
+#include <Box2D/Dynamics/Contacts/b2PolygonContact.h>
+#include <Box2D/Dynamics/Contacts/b2EdgeAndCircleContact.h>
+#include <Box2D/Dynamics/Contacts/b2EdgeAndPolygonContact.h>
+#include <Box2D/Dynamics/Contacts/b2ChainAndCircleContact.h>
+#include <Box2D/Dynamics/Contacts/b2ChainAndPolygonContact.h>
+#include <Box2D/Common/b2TaskScheduler.h>
 
 b2ContactFilter b2_defaultFilter;
 b2ContactListener b2_defaultListener;
 
+// The fewest contacts worth handing to another thread.
+const int32 b2_minNarrowPhaseRange = 64;
+
+// A persisting contact and what it was before its manifold was updated.
+struct b2ContactUpdate
+{
+	b2Contact* contact;
+	b2Manifold oldManifold;
+	bool wasTouching;
+};
+
+// Updates contact manifolds. Each contact is only written by the thread updating it and
+// the bodies are only read, so ranges can run on any thread. The updates are sorted by
+// contact type, so each type is updated in its own loop with its manifold function called
+// directly.
+class b2NarrowPhaseTask : public b2Task
+{
+public:
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		B2_NOT_USED(threadIndex);
+
+		// Split the range at the bucket boundaries.
+		for (int32 type = 0; type < e_contactTypeCount; ++type)
+		{
+			int32 lower = b2Max(begin, bucketStarts[type]);
+			int32 upper = b2Min(end, bucketStarts[type + 1]);
+			if (lower >= upper)
+			{
+				continue;
+			}
+
+			switch (type)
+			{
+			case e_circleContact:
+				UpdateBucket<b2CircleContact>(lower, upper);
+				break;
+
+			case e_polygonAndCircleContact:
+				UpdateBucket<b2PolygonAndCircleContact>(lower, upper);
+				break;
+
+			case e_polygonContact:
+				UpdateBucket<b2PolygonContact>(lower, upper);
+				break;
+
+			case e_edgeAndCircleContact:
+				UpdateBucket<b2EdgeAndCircleContact>(lower, upper);
+				break;
+
+			case e_edgeAndPolygonContact:
+				UpdateBucket<b2EdgeAndPolygonContact>(lower, upper);
+				break;
+
+			case e_chainAndCircleContact:
+				UpdateBucket<b2ChainAndCircleContact>(lower, upper);
+				break;
+
+			case e_chainAndPolygonContact:
+				UpdateBucket<b2ChainAndPolygonContact>(lower, upper);
+				break;
+			}
+		}
+	}
+
+	template <typename T>
+	void UpdateBucket(int32 begin, int32 end)
+	{
+		for (int32 i = begin; i < end; ++i)
+		{
+			b2ContactUpdate* update = updates + i;
+			T* contact = (T*)update->contact;
+			contact->template UpdateManifold<T>(&update->oldManifold, &update->wasTouching, speculativeTime);
+		}
+	}
+
+	b2ContactUpdate* updates;
+	int32 bucketStarts[e_contactTypeCount + 1];
+	float32 speculativeTime;
+};
+
 b2ContactManager::b2ContactManager()
 {
 	m_contactList = NULL;
@@ -32,6 +122,19 @@ b2ContactManager::b2ContactManager()
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
 	m_allocator = NULL;
+	m_taskScheduler = NULL;
+	m_islandManager = NULL;
+	m_updates = NULL;
+	m_contacts = NULL;
+	m_updateIndices = NULL;
+	m_updateCapacity = 0;
+}
+
+b2ContactManager::~b2ContactManager()
+{
+	b2Free(m_updateIndices);
+	b2Free(m_contacts);
+	b2Free(m_updates);
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -46,6 +149,8 @@ void b2ContactManager::Destroy(b2Contact* c)
 		m_contactListener->EndContact(c);
 	}
 
+	m_islandManager->RemoveContact(c);
+
 	// Remove from the world.
 	if (c->m_prev)
 	{
@@ -102,9 +207,32 @@ void b2ContactManager::Destroy(b2Contact* c)
 // This is the top level collision call for the time step. Here
 // all the narrow phase collision is processed for the world
 // contact list.
-void b2ContactManager::Collide()
+// This is the narrow phase. Filtering and destroying contacts call the user and change the
+// contact list, so they run first on this thread. The manifolds of the remaining contacts are
+// then updated on the task scheduler one contact type at a time, and finally bodies are woken
+// and the listener is called on this thread in contact list order, which is also where
+// contacts that started or stopped touching are linked to or unlinked from their islands.
+void b2ContactManager::Collide(float32 speculativeTime)
 {
-	// Update awake contacts.
+	if (m_updateCapacity < m_contactCount)
+	{
+		b2Free(m_updateIndices);
+		b2Free(m_contacts);
+		b2Free(m_updates);
+		m_updateCapacity = b2Max(m_contactCount, 2 * m_updateCapacity);
+		m_updates = (b2ContactUpdate*)b2Alloc(m_updateCapacity * sizeof(b2ContactUpdate));
+		m_contacts = (b2Contact**)b2Alloc(m_updateCapacity * sizeof(b2Contact*));
+		m_updateIndices = (int32*)b2Alloc(m_updateCapacity * sizeof(int32));
+	}
+
+	b2NarrowPhaseTask task;
+	for (int32 i = 0; i <= e_contactTypeCount; ++i)
+	{
+		task.bucketStarts[i] = 0;
+	}
+
+	// Find the awake contacts that persist.
+	int32 updateCount = 0;
 	b2Contact* c = m_contactList;
 	while (c)
 	{
@@ -163,10 +291,54 @@ void b2ContactManager::Collide()
 			continue;
 		}
 
-		// The contact persists.
-		c->Update(m_contactListener);
+		// The contact persists. Its type is kept until the sort so the sort does not have to
+		// touch the contact again.
+		m_contacts[updateCount] = c;
+		m_updateIndices[updateCount] = c->m_type;
+		++updateCount;
+		++task.bucketStarts[c->m_type + 1];
 		c = c->GetNext();
 	}
+
+	// Sort the updates by contact type, keeping list order within a type, and remember
+	// where each contact went.
+	for (int32 i = 0; i < e_contactTypeCount; ++i)
+	{
+		task.bucketStarts[i + 1] += task.bucketStarts[i];
+	}
+
+	int32 bucketEnds[e_contactTypeCount];
+	for (int32 i = 0; i < e_contactTypeCount; ++i)
+	{
+		bucketEnds[i] = task.bucketStarts[i];
+	}
+
+	for (int32 i = 0; i < updateCount; ++i)
+	{
+		int32 index = bucketEnds[m_updateIndices[i]]++;
+		m_updates[index].contact = m_contacts[i];
+		m_updateIndices[i] = index;
+	}
+
+	// Update the manifolds.
+	task.updates = m_updates;
+	task.speculativeTime = speculativeTime;
+	if (m_taskScheduler)
+	{
+		m_taskScheduler->ParallelFor(&task, updateCount, b2_minNarrowPhaseRange);
+	}
+	else
+	{
+		task.Execute(0, updateCount, 0);
+	}
+
+	// Wake bodies, call the listener and link or unlink islands in contact list order.
+	for (int32 i = 0; i < updateCount; ++i)
+	{
+		b2ContactUpdate* update = m_updates + m_updateIndices[i];
+		update->contact->ReportUpdate(&update->oldManifold, update->wasTouching, m_contactListener);
+		m_islandManager->UpdateContact(update->contact);
+	}
 }
 
 void b2ContactManager::FindNewContacts()
@@ -25,12 +25,16 @@ class b2Contact;
 class b2ContactFilter;
 class b2ContactListener;
 class b2BlockAllocator;
+class b2TaskScheduler;
+class b2IslandManager;
+struct b2ContactUpdate;
 
 // Delegate of b2World.
 class b2ContactManager
 {
 public:
 	b2ContactManager();
+	~b2ContactManager();
 
 	// Broad-phase callback.
 	void AddPair(void* proxyUserDataA, void* proxyUserDataB);
@@ -39,7 +43,8 @@ public:
 
 	void Destroy(b2Contact* c);
 
-	void Collide();
+	// A positive speculativeTime keeps contact points the bodies can close on within that time.
+	void Collide(float32 speculativeTime);
             
 	b2BroadPhase m_broadPhase;
 	b2Contact* m_contactList;
@@ -47,6 +52,15 @@ public:
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
 	b2BlockAllocator* m_allocator;
+	b2TaskScheduler* m_taskScheduler;
+	b2IslandManager* m_islandManager;
+
+	// The contacts Collide updates in list order, their updates sorted by contact type and
+	// the update index of each contact. Kept between steps so the buffers only grow.
+	b2Contact** m_contacts;
+	b2ContactUpdate* m_updates;
+	int32* m_updateIndices;
+	int32 m_updateCapacity;
 };
 
 #endif
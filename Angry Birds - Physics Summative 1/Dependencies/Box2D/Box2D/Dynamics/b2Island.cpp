@@ -24,8 +24,10 @@
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 #include <Box2D/Dynamics/Joints/b2Joint.h>
+#include <Box2D/Dynamics/Joints/b2JointChainSolver.h>
 #include <Box2D/Common/b2StackAllocator.h>
 #include <Box2D/Common/b2Timer.h>
+#include <Box2D/Common/b2WideFloat.h>
 
 /*
 Position Correction Notes
@@ -156,73 +158,296 @@ b2Island::b2Island(
 	m_contactCapacity = contactCapacity;
 	m_jointCapacity	 = jointCapacity;
 	m_bodyCount = 0;
+	m_sharedBodyCount = 0;
 	m_contactCount = 0;
 	m_jointCount = 0;
 
 	m_allocator = allocator;
 	m_listener = listener;
+	m_impulses = NULL;
+	m_sharedSlots = NULL;
 
 	m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
 	m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(b2Contact*));
 	m_joints = (b2Joint**)m_allocator->Allocate(jointCapacity * sizeof(b2Joint*));
 
-	m_velocities = (b2Velocity*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Velocity));
-	m_positions = (b2Position*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Position));
+	// The body state and sleep streams share one allocation.
+	float32* state = (float32*)m_allocator->Allocate(8 * m_bodyCapacity * sizeof(float32));
+	m_velocities.vx = state;
+	m_velocities.vy = state + m_bodyCapacity;
+	m_velocities.w = state + 2 * m_bodyCapacity;
+	m_positions.x = state + 3 * m_bodyCapacity;
+	m_positions.y = state + 4 * m_bodyCapacity;
+	m_positions.a = state + 5 * m_bodyCapacity;
+	m_sleepTimes = state + 6 * m_bodyCapacity;
+	m_sleepModes = state + 7 * m_bodyCapacity;
 }
 
 b2Island::~b2Island()
 {
 	// Warning: the order should reverse the constructor order.
-	m_allocator->Free(m_positions);
-	m_allocator->Free(m_velocities);
+	m_allocator->Free(m_velocities.vx);
 	m_allocator->Free(m_joints);
 	m_allocator->Free(m_contacts);
 	m_allocator->Free(m_bodies);
 }
 
+// Per body inputs of velocity integration, gathered from the bodies so the integration can
+// run on several bodies at a time.
+struct b2IntegrationInputs
+{
+	float32* accelerationX;		// gravityScale * gravity + invMass * force
+	float32* accelerationY;
+	float32* angularImpulse;	// h * invI * torque
+	float32* linearDamping;
+	float32* angularDamping;
+	float32* dynamic;			// 1 for dynamic bodies, 0 for bodies that are not integrated
+};
+
+// Sleep modes of the island bodies.
+#define b2_sleepModeAuto	0.0f
+#define b2_sleepModeNever	1.0f
+#define b2_sleepModeStatic	2.0f
+
+// The integration loops are templates over the lane type, see b2WideFloat.h. They follow the
+// scalar expressions of the Box2D solver exactly, so the one and four lane versions agree.
+
+template <typename F, int32 W>
+static void b2IntegrateVelocities(const b2Velocity& velocities, const b2IntegrationInputs& inputs,
+	float32 h, int32 begin, int32 end)
+{
+	typedef typename F::Mask M;
+	const F hW = F::Splat(h);
+	const F one = F::Splat(1.0f);
+
+	for (int32 i = begin; i < end; i += W)
+	{
+		F vx = F::Load(velocities.vx + i);
+		F vy = F::Load(velocities.vy + i);
+		F w = F::Load(velocities.w + i);
+
+		// Integrate velocities.
+		F newVx = vx + hW * F::Load(inputs.accelerationX + i);
+		F newVy = vy + hW * F::Load(inputs.accelerationY + i);
+		F newW = w + F::Load(inputs.angularImpulse + i);
+
+		// Apply damping.
+		// ODE: dv/dt + c * v = 0
+		// Solution: v(t) = v0 * exp(-c * t)
+		// Time step: v(t + dt) = v0 * exp(-c * (t + dt)) = v0 * exp(-c * t) * exp(-c * dt) = v * exp(-c * dt)
+		// v2 = exp(-c * dt) * v1
+		// Pade approximation:
+		// v2 = v1 * 1 / (1 + c * dt)
+		F linearScale = one / (one + hW * F::Load(inputs.linearDamping + i));
+		F angularScale = one / (one + hW * F::Load(inputs.angularDamping + i));
+		newVx = newVx * linearScale;
+		newVy = newVy * linearScale;
+		newW = newW * angularScale;
+
+		M dynamic = b2GreaterEqualW(F::Load(inputs.dynamic + i), one);
+		b2StoreW(b2SelectW(dynamic, newVx, vx), velocities.vx + i);
+		b2StoreW(b2SelectW(dynamic, newVy, vy), velocities.vy + i);
+		b2StoreW(b2SelectW(dynamic, newW, w), velocities.w + i);
+	}
+}
+
+template <typename F, int32 W>
+static void b2IntegratePositions(const b2Position& positions, const b2Velocity& velocities,
+	float32 h, int32 begin, int32 end)
+{
+	typedef typename F::Mask M;
+	const F hW = F::Splat(h);
+	const F maxTranslation = F::Splat(b2_maxTranslation);
+	const F maxTranslationSquared = F::Splat(b2_maxTranslationSquared);
+	const F maxRotation = F::Splat(b2_maxRotation);
+	const F maxRotationSquared = F::Splat(b2_maxRotationSquared);
+
+	for (int32 i = begin; i < end; i += W)
+	{
+		F vx = F::Load(velocities.vx + i);
+		F vy = F::Load(velocities.vy + i);
+		F w = F::Load(velocities.w + i);
+
+		// Check for large velocities
+		F translationX = hW * vx;
+		F translationY = hW * vy;
+		F translationSquared = translationX * translationX + translationY * translationY;
+		M clampTranslation = b2GreaterW(translationSquared, maxTranslationSquared);
+		F translationRatio = maxTranslation / b2SqrtW(translationSquared);
+		vx = b2SelectW(clampTranslation, vx * translationRatio, vx);
+		vy = b2SelectW(clampTranslation, vy * translationRatio, vy);
+
+		F rotation = hW * w;
+		M clampRotation = b2GreaterW(rotation * rotation, maxRotationSquared);
+		F rotationRatio = maxRotation / b2MaxW(rotation, -rotation);
+		w = b2SelectW(clampRotation, w * rotationRatio, w);
+
+		// Integrate
+		b2StoreW(F::Load(positions.x + i) + hW * vx, positions.x + i);
+		b2StoreW(F::Load(positions.y + i) + hW * vy, positions.y + i);
+		b2StoreW(F::Load(positions.a + i) + hW * w, positions.a + i);
+		b2StoreW(vx, velocities.vx + i);
+		b2StoreW(vy, velocities.vy + i);
+		b2StoreW(w, velocities.w + i);
+	}
+}
+
+// Advance the sleep timers of bodies below the sleep tolerances and reset the others.
+// Returns the smallest sleep time of the non-static bodies.
+template <typename F, int32 W>
+static float32 b2UpdateSleepTimes(const b2Velocity& velocities, float32* sleepTimes, const float32* sleepModes,
+	float32 h, int32 begin, int32 end)
+{
+	typedef typename F::Mask M;
+	const F hW = F::Splat(h);
+	const F zero = F::Splat(0.0f);
+	const F maxFloat = F::Splat(b2_maxFloat);
+	const F never = F::Splat(b2_sleepModeNever);
+	const F isStatic = F::Splat(b2_sleepModeStatic);
+	const F linTolSqr = F::Splat(b2_linearSleepTolerance * b2_linearSleepTolerance);
+	const F angTolSqr = F::Splat(b2_angularSleepTolerance * b2_angularSleepTolerance);
+
+	F minSleepTime = maxFloat;
+	for (int32 i = begin; i < end; i += W)
+	{
+		F vx = F::Load(velocities.vx + i);
+		F vy = F::Load(velocities.vy + i);
+		F w = F::Load(velocities.w + i);
+		F mode = F::Load(sleepModes + i);
+
+		M awake = b2OrW(b2GreaterW(w * w, angTolSqr), b2GreaterW(vx * vx + vy * vy, linTolSqr));
+		awake = b2OrW(awake, b2GreaterEqualW(mode, never));
+		F sleepTime = b2SelectW(awake, zero, F::Load(sleepTimes + i) + hW);
+		b2StoreW(sleepTime, sleepTimes + i);
+
+		minSleepTime = b2MinW(minSleepTime, b2SelectW(b2GreaterEqualW(mode, isStatic), maxFloat, sleepTime));
+	}
+
+	float32 lanes[W];
+	b2StoreW(minSleepTime, lanes);
+	float32 result = b2_maxFloat;
+	for (int32 l = 0; l < W; ++l)
+	{
+		result = b2Min(result, lanes[l]);
+	}
+	return result;
+}
+
+// The number of bodies the four lane loops handle, the one lane loops do the rest.
+inline int32 b2GetWideBodyCount(int32 count)
+{
+#if B2_WIDE_SSE2
+	return count & ~3;
+#else
+	B2_NOT_USED(count);
+	return 0;
+#endif
+}
+
+static void b2IntegrateVelocities(const b2Velocity& velocities, const b2IntegrationInputs& inputs, float32 h, int32 count)
+{
+	int32 wideCount = b2GetWideBodyCount(count);
+#if B2_WIDE_SSE2
+	b2IntegrateVelocities<b2FloatW4, 4>(velocities, inputs, h, 0, wideCount);
+#endif
+	b2IntegrateVelocities<b2FloatW1, 1>(velocities, inputs, h, wideCount, count);
+}
+
+static void b2IntegratePositions(const b2Position& positions, const b2Velocity& velocities, float32 h, int32 count)
+{
+	int32 wideCount = b2GetWideBodyCount(count);
+#if B2_WIDE_SSE2
+	b2IntegratePositions<b2FloatW4, 4>(positions, velocities, h, 0, wideCount);
+#endif
+	b2IntegratePositions<b2FloatW1, 1>(positions, velocities, h, wideCount, count);
+}
+
 void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
 {
 	b2Timer timer;
 
 	float32 h = step.dt;
 
-	// Integrate velocities and apply damping. Initialize the body state.
+	// The soft step solver integrates velocities once per sub-step.
+	float32 hv = step.softSubSteps > 0 ? h / step.softSubSteps : h;
+
+	// Initialize the body state and gather the inputs of velocity integration.
+	float32* inputMemory = (float32*)m_allocator->Allocate(6 * m_bodyCount * sizeof(float32));
+	b2IntegrationInputs inputs;
+	inputs.accelerationX = inputMemory;
+	inputs.accelerationY = inputMemory + m_bodyCount;
+	inputs.angularImpulse = inputMemory + 2 * m_bodyCount;
+	inputs.linearDamping = inputMemory + 3 * m_bodyCount;
+	inputs.angularDamping = inputMemory + 4 * m_bodyCount;
+	inputs.dynamic = inputMemory + 5 * m_bodyCount;
+
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* b = m_bodies[i];
 
-		b2Vec2 c = b->m_sweep.c;
-		float32 a = b->m_sweep.a;
-		b2Vec2 v = b->m_linearVelocity;
-		float32 w = b->m_angularVelocity;
+		// Store positions for continuous collision. Shared bodies are static, so
+		// they already match and other islands may be reading them.
+		if (i >= m_sharedBodyCount)
+		{
+			b->m_sweep.c0 = b->m_sweep.c;
+			b->m_sweep.a0 = b->m_sweep.a;
+		}
 
-		// Store positions for continuous collision.
-		b->m_sweep.c0 = b->m_sweep.c;
-		b->m_sweep.a0 = b->m_sweep.a;
+		m_positions.SetCenter(i, b->m_sweep.c);
+		m_positions.a[i] = b->m_sweep.a;
+		m_velocities.SetLinear(i, b->m_linearVelocity);
+		m_velocities.w[i] = b->m_angularVelocity;
 
 		if (b->m_type == b2_dynamicBody)
 		{
-			// Integrate velocities.
-			v += h * (b->m_gravityScale * gravity + b->m_invMass * b->m_force);
-			w += h * b->m_invI * b->m_torque;
-
-			// Apply damping.
-			// ODE: dv/dt + c * v = 0
-			// Solution: v(t) = v0 * exp(-c * t)
-			// Time step: v(t + dt) = v0 * exp(-c * (t + dt)) = v0 * exp(-c * t) * exp(-c * dt) = v * exp(-c * dt)
-			// v2 = exp(-c * dt) * v1
-			// Pade approximation:
-			// v2 = v1 * 1 / (1 + c * dt)
-			v *= 1.0f / (1.0f + h * b->m_linearDamping);
-			w *= 1.0f / (1.0f + h * b->m_angularDamping);
+			b2Vec2 acceleration = b->m_gravityScale * gravity + b->m_invMass * b->m_force;
+			inputs.accelerationX[i] = acceleration.x;
+			inputs.accelerationY[i] = acceleration.y;
+			inputs.angularImpulse[i] = hv * b->m_invI * b->m_torque;
+			inputs.linearDamping[i] = b->m_linearDamping;
+			inputs.angularDamping[i] = b->m_angularDamping;
+			inputs.dynamic[i] = 1.0f;
+		}
+		else
+		{
+			inputs.accelerationX[i] = 0.0f;
+			inputs.accelerationY[i] = 0.0f;
+			inputs.angularImpulse[i] = 0.0f;
+			inputs.linearDamping[i] = 0.0f;
+			inputs.angularDamping[i] = 0.0f;
+			inputs.dynamic[i] = 0.0f;
+		}
+
+		if (allowSleep)
+		{
+			m_sleepTimes[i] = b->m_sleepTime;
+			if (b->m_type == b2_staticBody)
+			{
+				m_sleepModes[i] = b2_sleepModeStatic;
+			}
+			else if ((b->m_flags & b2Body::e_autoSleepFlag) == 0)
+			{
+				m_sleepModes[i] = b2_sleepModeNever;
+			}
+			else
+			{
+				m_sleepModes[i] = b2_sleepModeAuto;
+			}
 		}
+	}
 
-		m_positions[i].c = c;
-		m_positions[i].a = a;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
+	if (step.softSubSteps > 0)
+	{
+		SolveSoft(profile, step, inputs, allowSleep);
+		m_allocator->Free(inputMemory);
+		return;
 	}
 
+	// Integrate velocities and apply damping.
+	b2IntegrateVelocities(m_velocities, inputs, h, m_bodyCount);
+
+	m_allocator->Free(inputMemory);
+
 	timer.Reset();
 
 	// Solver data
@@ -230,6 +455,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	solverData.step = step;
 	solverData.positions = m_positions;
 	solverData.velocities = m_velocities;
+	solverData.sharedSlots = m_sharedSlots;
 
 	// Initialize velocity constraints.
 	b2ContactSolverDef contactSolverDef;
@@ -238,6 +464,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	contactSolverDef.count = m_contactCount;
 	contactSolverDef.positions = m_positions;
 	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.sharedSlots = m_sharedSlots;
 	contactSolverDef.allocator = m_allocator;
 
 	b2ContactSolver contactSolver(&contactSolverDef);
@@ -253,6 +480,9 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		m_joints[i]->InitVelocityConstraints(solverData);
 	}
 
+	b2JointChainSolver chainSolver(m_joints, step.jointChains ? m_jointCount : 0, m_bodyCount, m_allocator);
+	chainSolver.InitVelocityConstraints(solverData);
+
 	profile->solveInit = timer.GetMilliseconds();
 
 	// Solve velocity constraints
@@ -264,6 +494,8 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 			m_joints[j]->SolveVelocityConstraints(solverData);
 		}
 
+		chainSolver.SolveVelocityConstraints(solverData);
+
 		contactSolver.SolveVelocityConstraints();
 	}
 
@@ -272,37 +504,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	profile->solveVelocity = timer.GetMilliseconds();
 
 	// Integrate positions
-	for (int32 i = 0; i < m_bodyCount; ++i)
-	{
-		b2Vec2 c = m_positions[i].c;
-		float32 a = m_positions[i].a;
-		b2Vec2 v = m_velocities[i].v;
-		float32 w = m_velocities[i].w;
-
-		// Check for large velocities
-		b2Vec2 translation = h * v;
-		if (b2Dot(translation, translation) > b2_maxTranslationSquared)
-		{
-			float32 ratio = b2_maxTranslation / translation.Length();
-			v *= ratio;
-		}
-
-		float32 rotation = h * w;
-		if (rotation * rotation > b2_maxRotationSquared)
-		{
-			float32 ratio = b2_maxRotation / b2Abs(rotation);
-			w *= ratio;
-		}
-
-		// Integrate
-		c += h * v;
-		a += h * w;
-
-		m_positions[i].c = c;
-		m_positions[i].a = a;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
-	}
+	b2IntegratePositions(m_positions, m_velocities, h, m_bodyCount);
 
 	// Solve position constraints
 	timer.Reset();
@@ -326,59 +528,186 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		}
 	}
 
-	// Copy state buffers back to the bodies
-	for (int32 i = 0; i < m_bodyCount; ++i)
-	{
-		b2Body* body = m_bodies[i];
-		body->m_sweep.c = m_positions[i].c;
-		body->m_sweep.a = m_positions[i].a;
-		body->m_linearVelocity = m_velocities[i].v;
-		body->m_angularVelocity = m_velocities[i].w;
-		body->SynchronizeTransform();
-	}
+	float32 minSleepTime = StoreBodies(h, allowSleep);
 
 	profile->solvePosition = timer.GetMilliseconds();
 
 	Report(contactSolver.m_velocityConstraints);
 
-	if (allowSleep)
+	if (allowSleep && minSleepTime >= b2_timeToSleep && positionSolved)
+	{
+		Sleep();
+	}
+}
+
+// Soft constraint coefficients of a spring with the given stiffness and damping ratio, for a
+// time step of h.
+static b2ContactSoftness b2MakeContactSoftness(float32 hertz, float32 zeta, float32 h)
+{
+	float32 omega = 2.0f * b2_pi * hertz;
+	float32 a1 = 2.0f * zeta + h * omega;
+	float32 a2 = h * omega * a1;
+	float32 a3 = 1.0f / (1.0f + a2);
+
+	b2ContactSoftness softness;
+	softness.biasRate = omega / a1;
+	softness.massScale = a2 * a3;
+	softness.impulseScale = a3;
+	return softness;
+}
+
+// Each sub-step integrates velocities, warm starts, solves once with the soft push out,
+// integrates positions and solves once more without it to remove the velocity the push out
+// added. Joints keep their rigid solver with one velocity and one position iteration per
+// sub-step, their stored impulses are per sub-step.
+void b2Island::SolveSoft(b2Profile* profile, const b2TimeStep& step, const b2IntegrationInputs& inputs, bool allowSleep)
+{
+	b2Timer timer;
+
+	int32 subStepCount = step.softSubSteps;
+	float32 h = step.dt / subStepCount;
+	float32 inv_h = subStepCount * step.inv_dt;
+
+	// Stiffer contacts than the sub-step can resolve would overshoot.
+	float32 contactHertz = b2Min(b2_contactHertz, 0.25f * inv_h);
+	b2ContactSoftness softness = b2MakeContactSoftness(contactHertz, b2_contactDampingRatio, h);
+
+	b2TimeStep subStep = step;
+	subStep.dt = h;
+	subStep.inv_dt = inv_h;
+	subStep.wideContactLanes = 0;
+
+	b2SolverData solverData;
+	solverData.step = subStep;
+	solverData.positions = m_positions;
+	solverData.velocities = m_velocities;
+	solverData.sharedSlots = m_sharedSlots;
+
+	b2ContactSolverDef contactSolverDef;
+	contactSolverDef.step = subStep;
+	contactSolverDef.contacts = m_contacts;
+	contactSolverDef.count = m_contactCount;
+	contactSolverDef.positions = m_positions;
+	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.sharedSlots = m_sharedSlots;
+	contactSolverDef.allocator = m_allocator;
+
+	b2ContactSolver contactSolver(&contactSolverDef);
+	contactSolver.InitializeSoftConstraints();
+
+	b2JointChainSolver chainSolver(m_joints, step.jointChains ? m_jointCount : 0, m_bodyCount, m_allocator);
+
+	profile->solveInit = timer.GetMilliseconds();
+
+	timer.Reset();
+	bool jointsOkay = false;
+	for (int32 i = 0; i < subStepCount; ++i)
 	{
-		float32 minSleepTime = b2_maxFloat;
+		b2IntegrateVelocities(m_velocities, inputs, h, m_bodyCount);
+
+		// Warm start with the impulses of the previous sub-step. Only the first sub-step
+		// follows a step that may have had a different length.
+		solverData.step.dtRatio = i == 0 ? step.dtRatio : 1.0f;
+		for (int32 j = 0; j < m_jointCount; ++j)
+		{
+			m_joints[j]->InitVelocityConstraints(solverData);
+		}
 
-		const float32 linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
-		const float32 angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
+		chainSolver.InitVelocityConstraints(solverData);
 
-		for (int32 i = 0; i < m_bodyCount; ++i)
+		if (step.warmStarting)
 		{
-			b2Body* b = m_bodies[i];
-			if (b->GetType() == b2_staticBody)
-			{
-				continue;
-			}
+			contactSolver.WarmStart();
+		}
 
-			if ((b->m_flags & b2Body::e_autoSleepFlag) == 0 ||
-				b->m_angularVelocity * b->m_angularVelocity > angTolSqr ||
-				b2Dot(b->m_linearVelocity, b->m_linearVelocity) > linTolSqr)
-			{
-				b->m_sleepTime = 0.0f;
-				minSleepTime = 0.0f;
-			}
-			else
-			{
-				b->m_sleepTime += h;
-				minSleepTime = b2Min(minSleepTime, b->m_sleepTime);
-			}
+		for (int32 j = 0; j < m_jointCount; ++j)
+		{
+			m_joints[j]->SolveVelocityConstraints(solverData);
 		}
 
-		if (minSleepTime >= b2_timeToSleep && positionSolved)
+		chainSolver.SolveVelocityConstraints(solverData);
+
+		contactSolver.SolveSoftConstraints(softness, inv_h, true);
+
+		b2IntegratePositions(m_positions, m_velocities, h, m_bodyCount);
+
+		jointsOkay = true;
+		for (int32 j = 0; j < m_jointCount; ++j)
 		{
-			for (int32 i = 0; i < m_bodyCount; ++i)
-			{
-				b2Body* b = m_bodies[i];
-				b->SetAwake(false);
-			}
+			bool jointOkay = m_joints[j]->SolvePositionConstraints(solverData);
+			jointsOkay = jointsOkay && jointOkay;
+		}
+
+		// Relax.
+		for (int32 j = 0; j < m_jointCount; ++j)
+		{
+			m_joints[j]->SolveVelocityConstraints(solverData);
+		}
+
+		chainSolver.SolveVelocityConstraints(solverData);
+
+		contactSolver.SolveSoftConstraints(softness, inv_h, false);
+	}
+
+	contactSolver.ApplySoftRestitution();
+	contactSolver.StoreSoftImpulses();
+
+	profile->solveVelocity = timer.GetMilliseconds();
+
+	timer.Reset();
+	float32 minSleepTime = StoreBodies(step.dt, allowSleep);
+	profile->solvePosition = timer.GetMilliseconds();
+
+	Report(contactSolver.m_velocityConstraints);
+
+	// Soft contacts rest with a small overlap that depends on the load, so only the joints
+	// have to be solved for the island to sleep.
+	if (allowSleep && minSleepTime >= b2_timeToSleep && jointsOkay)
+	{
+		Sleep();
+	}
+}
+
+float32 b2Island::StoreBodies(float32 h, bool allowSleep)
+{
+	// Update the sleep timers. Position solving doesn't change the velocities, so they are final.
+	float32 minSleepTime = b2_maxFloat;
+	if (allowSleep)
+	{
+		int32 wideCount = b2GetWideBodyCount(m_bodyCount);
+#if B2_WIDE_SSE2
+		minSleepTime = b2UpdateSleepTimes<b2FloatW4, 4>(m_velocities, m_sleepTimes, m_sleepModes, h, 0, wideCount);
+#endif
+		float32 tailSleepTime = b2UpdateSleepTimes<b2FloatW1, 1>(m_velocities, m_sleepTimes, m_sleepModes, h, wideCount, m_bodyCount);
+		minSleepTime = b2Min(minSleepTime, tailSleepTime);
+	}
+
+	// Copy state buffers back to the bodies
+	for (int32 i = m_sharedBodyCount; i < m_bodyCount; ++i)
+	{
+		b2Body* body = m_bodies[i];
+		body->m_sweep.c = m_positions.GetCenter(i);
+		body->m_sweep.a = m_positions.a[i];
+		body->m_linearVelocity = m_velocities.GetLinear(i);
+		body->m_angularVelocity = m_velocities.w[i];
+		body->SynchronizeTransform();
+
+		if (allowSleep && body->m_type != b2_staticBody)
+		{
+			body->m_sleepTime = m_sleepTimes[i];
 		}
 	}
+
+	return minSleepTime;
+}
+
+void b2Island::Sleep()
+{
+	for (int32 i = m_sharedBodyCount; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+		b->SetAwake(false);
+	}
 }
 
 void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB)
@@ -390,10 +719,10 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* b = m_bodies[i];
-		m_positions[i].c = b->m_sweep.c;
-		m_positions[i].a = b->m_sweep.a;
-		m_velocities[i].v = b->m_linearVelocity;
-		m_velocities[i].w = b->m_angularVelocity;
+		m_positions.SetCenter(i, b->m_sweep.c);
+		m_positions.a[i] = b->m_sweep.a;
+		m_velocities.SetLinear(i, b->m_linearVelocity);
+		m_velocities.w[i] = b->m_angularVelocity;
 	}
 
 	b2ContactSolverDef contactSolverDef;
@@ -403,6 +732,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 	contactSolverDef.step = subStep;
 	contactSolverDef.positions = m_positions;
 	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.sharedSlots = NULL;
 	b2ContactSolver contactSolver(&contactSolverDef);
 
 	// Solve position constraints.
@@ -449,10 +779,10 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 #endif
 
 	// Leap of faith to new safe state.
-	m_bodies[toiIndexA]->m_sweep.c0 = m_positions[toiIndexA].c;
-	m_bodies[toiIndexA]->m_sweep.a0 = m_positions[toiIndexA].a;
-	m_bodies[toiIndexB]->m_sweep.c0 = m_positions[toiIndexB].c;
-	m_bodies[toiIndexB]->m_sweep.a0 = m_positions[toiIndexB].a;
+	m_bodies[toiIndexA]->m_sweep.c0 = m_positions.GetCenter(toiIndexA);
+	m_bodies[toiIndexA]->m_sweep.a0 = m_positions.a[toiIndexA];
+	m_bodies[toiIndexB]->m_sweep.c0 = m_positions.GetCenter(toiIndexB);
+	m_bodies[toiIndexB]->m_sweep.a0 = m_positions.a[toiIndexB];
 
 	// No warm starting is needed for TOI events because warm
 	// starting impulses were applied in the discrete solver.
@@ -470,43 +800,16 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 	float32 h = subStep.dt;
 
 	// Integrate positions
+	b2IntegratePositions(m_positions, m_velocities, h, m_bodyCount);
+
+	// Sync bodies
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
-		b2Vec2 c = m_positions[i].c;
-		float32 a = m_positions[i].a;
-		b2Vec2 v = m_velocities[i].v;
-		float32 w = m_velocities[i].w;
-
-		// Check for large velocities
-		b2Vec2 translation = h * v;
-		if (b2Dot(translation, translation) > b2_maxTranslationSquared)
-		{
-			float32 ratio = b2_maxTranslation / translation.Length();
-			v *= ratio;
-		}
-
-		float32 rotation = h * w;
-		if (rotation * rotation > b2_maxRotationSquared)
-		{
-			float32 ratio = b2_maxRotation / b2Abs(rotation);
-			w *= ratio;
-		}
-
-		// Integrate
-		c += h * v;
-		a += h * w;
-
-		m_positions[i].c = c;
-		m_positions[i].a = a;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
-
-		// Sync bodies
 		b2Body* body = m_bodies[i];
-		body->m_sweep.c = c;
-		body->m_sweep.a = a;
-		body->m_linearVelocity = v;
-		body->m_angularVelocity = w;
+		body->m_sweep.c = m_positions.GetCenter(i);
+		body->m_sweep.a = m_positions.a[i];
+		body->m_linearVelocity = m_velocities.GetLinear(i);
+		body->m_angularVelocity = m_velocities.w[i];
 		body->SynchronizeTransform();
 	}
 
@@ -515,7 +818,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 
 void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 {
-	if (m_listener == NULL)
+	if (m_listener == NULL && m_impulses == NULL)
 	{
 		return;
 	}
@@ -534,6 +837,13 @@ void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 			impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
 		}
 
-		m_listener->PostSolve(c, &impulse);
+		if (m_impulses)
+		{
+			m_impulses[i] = impulse;
+		}
+		else
+		{
+			m_listener->PostSolve(c, &impulse);
+		}
 	}
 }
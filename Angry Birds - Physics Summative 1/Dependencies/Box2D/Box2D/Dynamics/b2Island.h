@@ -27,8 +27,10 @@ class b2Contact;
 class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
+struct b2ContactImpulse;
 struct b2ContactVelocityConstraint;
 struct b2Profile;
+struct b2IntegrationInputs;
 
 /// This is an internal class.
 class b2Island
@@ -41,12 +43,22 @@ public:
 	void Clear()
 	{
 		m_bodyCount = 0;
+		m_sharedBodyCount = 0;
 		m_contactCount = 0;
 		m_jointCount = 0;
 	}
 
 	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
 
+	// Solve with sub-steps of soft contacts, called by Solve once the body state is initialized.
+	void SolveSoft(b2Profile* profile, const b2TimeStep& step, const b2IntegrationInputs& inputs, bool allowSleep);
+
+	// Copy the solved state back to the bodies and update their sleep timers. Returns the
+	// smallest sleep time of the non-static bodies.
+	float32 StoreBodies(float32 h, bool allowSleep);
+
+	void Sleep();
+
 	void SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB);
 
 	void Add(b2Body* body)
@@ -57,6 +69,18 @@ public:
 		++m_bodyCount;
 	}
 
+	/// Add a static body that other islands are being solved with at the same time. These come
+	/// before all other bodies and are only read. Their island index is set by the world and
+	/// m_sharedSlots maps it to the body's slot in this island.
+	void AddShared(b2Body* body)
+	{
+		b2Assert(m_bodyCount == m_sharedBodyCount && m_bodyCount < m_bodyCapacity);
+		b2Assert(m_sharedSlots && m_sharedSlots[body->m_islandIndex] == m_bodyCount);
+		m_bodies[m_bodyCount] = body;
+		++m_bodyCount;
+		++m_sharedBodyCount;
+	}
+
 	void Add(b2Contact* contact)
 	{
 		b2Assert(m_contactCount < m_contactCapacity);
@@ -74,14 +98,25 @@ public:
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
 
+	// When set, Report stores one impulse per contact here instead of calling the listener.
+	b2ContactImpulse* m_impulses;
+
+	// Island slot of each shared static body, indexed by the body's island index.
+	const int32* m_sharedSlots;
+
 	b2Body** m_bodies;
 	b2Contact** m_contacts;
 	b2Joint** m_joints;
 
-	b2Position* m_positions;
-	b2Velocity* m_velocities;
+	b2Position m_positions;
+	b2Velocity m_velocities;
+
+	// Sleep timers of the bodies and whether they can fall asleep, used by Solve.
+	float32* m_sleepTimes;
+	float32* m_sleepModes;
 
 	int32 m_bodyCount;
+	int32 m_sharedBodyCount;
 	int32 m_jointCount;
 	int32 m_contactCount;
 
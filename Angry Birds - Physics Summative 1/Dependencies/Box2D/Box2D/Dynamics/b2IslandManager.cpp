@@ -0,0 +1,599 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2IslandManager.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Dynamics/Joints/b2Joint.h>
+#include <Box2D/Common/b2BlockAllocator.h>
+#include <Box2D/Common/b2StackAllocator.h>
+
+// Find the island an island was merged into, pointing every island on the way straight
+// at it.
+static b2PersistentIsland* b2FindRoot(b2PersistentIsland* island)
+{
+	b2PersistentIsland* root = island;
+	while (root->parent)
+	{
+		root = root->parent;
+	}
+
+	while (island != root)
+	{
+		b2PersistentIsland* parent = island->parent;
+		island->parent = root;
+		island = parent;
+	}
+
+	return root;
+}
+
+static void b2PushIsland(b2PersistentIsland** list, b2PersistentIsland* island)
+{
+	island->prev = NULL;
+	island->next = *list;
+	if (*list)
+	{
+		(*list)->prev = island;
+	}
+	*list = island;
+}
+
+static void b2RemoveIsland(b2PersistentIsland** list, b2PersistentIsland* island)
+{
+	if (island->prev)
+	{
+		island->prev->next = island->next;
+	}
+
+	if (island->next)
+	{
+		island->next->prev = island->prev;
+	}
+
+	if (island == *list)
+	{
+		*list = island->next;
+	}
+}
+
+template <typename T>
+void b2IslandManager::PushItem(T** list, T* item)
+{
+	item->m_islandPrev = NULL;
+	item->m_islandNext = *list;
+	if (*list)
+	{
+		(*list)->m_islandPrev = item;
+	}
+	*list = item;
+}
+
+template <typename T>
+void b2IslandManager::RemoveItem(T** list, T* item)
+{
+	if (item->m_islandPrev)
+	{
+		item->m_islandPrev->m_islandNext = item->m_islandNext;
+	}
+
+	if (item->m_islandNext)
+	{
+		item->m_islandNext->m_islandPrev = item->m_islandPrev;
+	}
+
+	if (item == *list)
+	{
+		*list = item->m_islandNext;
+	}
+
+	item->m_islandPrev = NULL;
+	item->m_islandNext = NULL;
+}
+
+b2IslandManager::b2IslandManager()
+{
+	m_awakeList = NULL;
+	m_sleepingList = NULL;
+	m_mergeList = NULL;
+	m_islandCount = 0;
+	m_allocator = NULL;
+}
+
+b2PersistentIsland* b2IslandManager::CreateIsland(bool awake)
+{
+	void* mem = m_allocator->Allocate(sizeof(b2PersistentIsland));
+	b2PersistentIsland* island = (b2PersistentIsland*)mem;
+	island->parent = NULL;
+	island->nextMerge = NULL;
+	island->bodyList = NULL;
+	island->contactList = NULL;
+	island->jointList = NULL;
+	island->bodyCount = 0;
+	island->contactCount = 0;
+	island->jointCount = 0;
+	island->constraintRemoveCount = 0;
+	island->awake = awake;
+
+	b2PushIsland(awake ? &m_awakeList : &m_sleepingList, island);
+	++m_islandCount;
+	return island;
+}
+
+void b2IslandManager::DestroyIsland(b2PersistentIsland* island)
+{
+	b2RemoveIsland(island->awake ? &m_awakeList : &m_sleepingList, island);
+	m_allocator->Free(island, sizeof(b2PersistentIsland));
+	--m_islandCount;
+}
+
+void b2IslandManager::AddBody(b2Body* body)
+{
+	b2Assert(body->m_island == NULL);
+
+	if (body->m_type != b2_staticBody && body->IsActive())
+	{
+		b2PersistentIsland* island = CreateIsland(body->IsAwake());
+		PushItem(&island->bodyList, body);
+		island->bodyCount = 1;
+		body->m_island = island;
+	}
+
+	// Joints to this body may only now join islands.
+	for (b2JointEdge* je = body->m_jointList; je; je = je->next)
+	{
+		AddJoint(je->joint);
+	}
+
+	for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
+	{
+		UpdateContact(ce->contact);
+	}
+}
+
+void b2IslandManager::RemoveBody(b2Body* body)
+{
+	// The island may be emptied, so it must not be waiting for a merge.
+	MergeIslands();
+
+	for (b2JointEdge* je = body->m_jointList; je; je = je->next)
+	{
+		RemoveJoint(je->joint);
+	}
+
+	for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
+	{
+		RemoveContact(ce->contact);
+	}
+
+	b2PersistentIsland* island = body->m_island;
+	if (island == NULL)
+	{
+		return;
+	}
+
+	RemoveItem(&island->bodyList, body);
+	--island->bodyCount;
+	++island->constraintRemoveCount;
+	body->m_island = NULL;
+
+	// Every constraint left in the island has a body in it.
+	if (island->bodyCount == 0)
+	{
+		b2Assert(island->contactCount == 0 && island->jointCount == 0);
+		DestroyIsland(island);
+	}
+}
+
+void b2IslandManager::UpdateContact(b2Contact* contact)
+{
+	bool touching = (contact->m_flags & b2Contact::e_touchingFlag) == b2Contact::e_touchingFlag;
+	bool sensor = contact->m_fixtureA->IsSensor() || contact->m_fixtureB->IsSensor();
+	bool linked = contact->m_island != NULL;
+
+	// A contact disabled by the user doesn't join islands. It is enabled again by every
+	// update, which is followed by a call to this, so it links again once it is re-enabled.
+	bool enabled = (contact->m_flags & b2Contact::e_enabledFlag) == b2Contact::e_enabledFlag;
+
+	if (touching && enabled && sensor == false)
+	{
+		if (linked == false)
+		{
+			LinkContact(contact);
+		}
+	}
+	else if (linked)
+	{
+		UnlinkContact(contact);
+	}
+}
+
+void b2IslandManager::RemoveContact(b2Contact* contact)
+{
+	if (contact->m_island)
+	{
+		UnlinkContact(contact);
+	}
+}
+
+void b2IslandManager::AddJoint(b2Joint* joint)
+{
+	if (joint->m_island)
+	{
+		return;
+	}
+
+	b2Body* bodyA = joint->m_bodyA;
+	b2Body* bodyB = joint->m_bodyB;
+
+	// Joints to inactive bodies are not simulated.
+	if (bodyA->IsActive() == false || bodyB->IsActive() == false)
+	{
+		return;
+	}
+
+	if (bodyA->m_island == NULL && bodyB->m_island == NULL)
+	{
+		return;
+	}
+
+	LinkJoint(joint);
+}
+
+void b2IslandManager::RemoveJoint(b2Joint* joint)
+{
+	if (joint->m_island)
+	{
+		UnlinkJoint(joint);
+	}
+}
+
+void b2IslandManager::WakeIsland(b2PersistentIsland* island)
+{
+	if (island->awake)
+	{
+		return;
+	}
+
+	b2RemoveIsland(&m_sleepingList, island);
+	b2PushIsland(&m_awakeList, island);
+	island->awake = true;
+}
+
+void b2IslandManager::SleepIsland(b2PersistentIsland* island)
+{
+	if (island->awake == false)
+	{
+		return;
+	}
+
+	b2RemoveIsland(&m_awakeList, island);
+	b2PushIsland(&m_sleepingList, island);
+	island->awake = false;
+}
+
+b2PersistentIsland* b2IslandManager::LinkIslands(b2PersistentIsland* islandA, b2PersistentIsland* islandB)
+{
+	if (islandA == NULL)
+	{
+		return b2FindRoot(islandB);
+	}
+
+	b2PersistentIsland* rootA = b2FindRoot(islandA);
+	if (islandB == NULL)
+	{
+		return rootA;
+	}
+
+	b2PersistentIsland* rootB = b2FindRoot(islandB);
+	if (rootA == rootB)
+	{
+		return rootA;
+	}
+
+	// Move the smaller island, merging is linear in its size.
+	b2PersistentIsland* root = rootA;
+	b2PersistentIsland* child = rootB;
+	if (rootA->bodyCount < rootB->bodyCount)
+	{
+		root = rootB;
+		child = rootA;
+	}
+
+	child->parent = root;
+	child->nextMerge = m_mergeList;
+	m_mergeList = child;
+	return root;
+}
+
+void b2IslandManager::LinkContact(b2Contact* contact)
+{
+	b2Body* bodyA = contact->m_fixtureA->GetBody();
+	b2Body* bodyB = contact->m_fixtureB->GetBody();
+	b2Assert(bodyA->m_island != NULL || bodyB->m_island != NULL);
+
+	b2PersistentIsland* island = LinkIslands(bodyA->m_island, bodyB->m_island);
+	PushItem(&island->contactList, contact);
+	++island->contactCount;
+	contact->m_island = island;
+}
+
+void b2IslandManager::UnlinkContact(b2Contact* contact)
+{
+	b2PersistentIsland* island = contact->m_island;
+	RemoveItem(&island->contactList, contact);
+	--island->contactCount;
+	++island->constraintRemoveCount;
+	contact->m_island = NULL;
+}
+
+void b2IslandManager::LinkJoint(b2Joint* joint)
+{
+	b2PersistentIsland* island = LinkIslands(joint->m_bodyA->m_island, joint->m_bodyB->m_island);
+	PushItem(&island->jointList, joint);
+	++island->jointCount;
+	joint->m_island = island;
+}
+
+void b2IslandManager::UnlinkJoint(b2Joint* joint)
+{
+	b2PersistentIsland* island = joint->m_island;
+	RemoveItem(&island->jointList, joint);
+	--island->jointCount;
+	++island->constraintRemoveCount;
+	joint->m_island = NULL;
+}
+
+void b2IslandManager::MergeIslands()
+{
+	if (m_mergeList == NULL)
+	{
+		return;
+	}
+
+	// Point every merged island straight at its root first, so islands can be freed
+	// below while others still have to be merged.
+	for (b2PersistentIsland* island = m_mergeList; island; island = island->nextMerge)
+	{
+		b2FindRoot(island);
+	}
+
+	b2PersistentIsland* island = m_mergeList;
+	m_mergeList = NULL;
+	while (island)
+	{
+		b2PersistentIsland* next = island->nextMerge;
+		b2PersistentIsland* root = island->parent;
+		b2Assert(root != NULL && root->parent == NULL);
+
+		// Move the bodies, contacts and joints to the front of the root's lists.
+		if (island->bodyList)
+		{
+			b2Body* last = NULL;
+			for (b2Body* b = island->bodyList; b; b = b->m_islandNext)
+			{
+				b->m_island = root;
+				last = b;
+			}
+
+			last->m_islandNext = root->bodyList;
+			if (root->bodyList)
+			{
+				root->bodyList->m_islandPrev = last;
+			}
+			root->bodyList = island->bodyList;
+		}
+
+		if (island->contactList)
+		{
+			b2Contact* last = NULL;
+			for (b2Contact* c = island->contactList; c; c = c->m_islandNext)
+			{
+				c->m_island = root;
+				last = c;
+			}
+
+			last->m_islandNext = root->contactList;
+			if (root->contactList)
+			{
+				root->contactList->m_islandPrev = last;
+			}
+			root->contactList = island->contactList;
+		}
+
+		if (island->jointList)
+		{
+			b2Joint* last = NULL;
+			for (b2Joint* j = island->jointList; j; j = j->m_islandNext)
+			{
+				j->m_island = root;
+				last = j;
+			}
+
+			last->m_islandNext = root->jointList;
+			if (root->jointList)
+			{
+				root->jointList->m_islandPrev = last;
+			}
+			root->jointList = island->jointList;
+		}
+
+		root->bodyCount += island->bodyCount;
+		root->contactCount += island->contactCount;
+		root->jointCount += island->jointCount;
+		root->constraintRemoveCount += island->constraintRemoveCount;
+
+		// The merged island is simulated when either part was.
+		if (island->awake)
+		{
+			WakeIsland(root);
+		}
+
+		DestroyIsland(island);
+		island = next;
+	}
+}
+
+void b2IslandManager::UpdateIslands(b2StackAllocator* allocator)
+{
+	b2PersistentIsland* next;
+	for (b2PersistentIsland* island = m_awakeList; island; island = next)
+	{
+		next = island->next;
+
+		// Islands are put to sleep as a whole.
+		bool sleeping = island->bodyList->IsAwake() == false;
+		if (sleeping)
+		{
+			SleepIsland(island);
+		}
+
+		if (island->constraintRemoveCount == 0)
+		{
+			continue;
+		}
+
+		// Split when the island fell asleep or part of it could, so the parts can sleep
+		// and wake on their own.
+		bool split = sleeping;
+		for (b2Body* b = island->bodyList; b && split == false; b = b->m_islandNext)
+		{
+			split = b->m_sleepTime >= b2_timeToSleep;
+		}
+
+		if (split)
+		{
+			SplitIsland(island, allocator);
+		}
+	}
+}
+
+// Perform a depth first search (DFS) on the island's constraints, moving each connected
+// part to a new island.
+void b2IslandManager::SplitIsland(b2PersistentIsland* island, b2StackAllocator* allocator)
+{
+	int32 bodyCount = island->bodyCount;
+	b2Body** bodies = (b2Body**)allocator->Allocate(bodyCount * sizeof(b2Body*));
+	b2Body** stack = (b2Body**)allocator->Allocate(bodyCount * sizeof(b2Body*));
+
+	int32 index = 0;
+	for (b2Body* b = island->bodyList; b; b = b->m_islandNext)
+	{
+		b->m_flags &= ~b2Body::e_islandFlag;
+		bodies[index++] = b;
+	}
+	b2Assert(index == bodyCount);
+
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* seed = bodies[i];
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
+
+		b2PersistentIsland* part = CreateIsland(island->awake);
+
+		int32 stackCount = 0;
+		stack[stackCount++] = seed;
+		seed->m_flags |= b2Body::e_islandFlag;
+
+		while (stackCount > 0)
+		{
+			b2Body* b = stack[--stackCount];
+			PushItem(&part->bodyList, b);
+			++part->bodyCount;
+			b->m_island = part;
+
+			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+			{
+				b2Contact* contact = ce->contact;
+
+				// Is this contact part of the island and not yet moved?
+				if (contact->m_island == NULL || (contact->m_flags & b2Contact::e_islandFlag))
+				{
+					continue;
+				}
+
+				PushItem(&part->contactList, contact);
+				++part->contactCount;
+				contact->m_island = part;
+				contact->m_flags |= b2Contact::e_islandFlag;
+
+				// Static bodies are in no island and don't connect others.
+				b2Body* other = ce->other;
+				if (other->m_island == NULL || (other->m_flags & b2Body::e_islandFlag))
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < bodyCount);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
+
+			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			{
+				b2Joint* joint = je->joint;
+				if (joint->m_island == NULL || joint->m_islandFlag)
+				{
+					continue;
+				}
+
+				PushItem(&part->jointList, joint);
+				++part->jointCount;
+				joint->m_island = part;
+				joint->m_islandFlag = true;
+
+				b2Body* other = je->other;
+				if (other->m_island == NULL || (other->m_flags & b2Body::e_islandFlag))
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < bodyCount);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
+		}
+	}
+
+	// Clear the search flags.
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* b = bodies[i];
+		b->m_flags &= ~b2Body::e_islandFlag;
+
+		for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+		{
+			ce->contact->m_flags &= ~b2Contact::e_islandFlag;
+		}
+
+		for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+		{
+			je->joint->m_islandFlag = false;
+		}
+	}
+
+	allocator->Free(stack);
+	allocator->Free(bodies);
+
+	// Everything was moved to the new islands.
+	DestroyIsland(island);
+}
@@ -0,0 +1,119 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_ISLAND_MANAGER_H
+#define B2_ISLAND_MANAGER_H
+
+#include <Box2D/Common/b2Settings.h>
+
+class b2Body;
+class b2Contact;
+class b2Joint;
+class b2BlockAllocator;
+class b2StackAllocator;
+
+/// A group of bodies connected by touching contacts and joints that is kept from one
+/// time step to the next. Static bodies are not part of any island, constraints to them
+/// belong to the island of the other body.
+struct b2PersistentIsland
+{
+	b2PersistentIsland* prev;
+	b2PersistentIsland* next;
+
+	// Set when a new contact or joint joined this island to another one. The islands
+	// are merged at the start of the next step.
+	b2PersistentIsland* parent;
+	b2PersistentIsland* nextMerge;
+
+	b2Body* bodyList;
+	b2Contact* contactList;
+	b2Joint* jointList;
+
+	int32 bodyCount;
+	int32 contactCount;
+	int32 jointCount;
+
+	// Contacts and joints removed since the island was built. When this is not zero the
+	// island may have come apart.
+	int32 constraintRemoveCount;
+
+	bool awake;
+};
+
+// Delegate of b2World. Keeps the islands up to date as contacts start and stop touching
+// and joints come and go, so a step only visits the islands that are awake. Linking a
+// contact or joint joins islands with a union-find. Islands are only split, with a search
+// over their own constraints, once they lost constraints and are going to sleep.
+class b2IslandManager
+{
+public:
+	b2IslandManager();
+
+	// A body was created, changed type or was activated.
+	void AddBody(b2Body* body);
+
+	// A body is about to be destroyed, change type or be deactivated.
+	void RemoveBody(b2Body* body);
+
+	// Link or unlink a contact after its touching or enabled state may have changed.
+	void UpdateContact(b2Contact* contact);
+
+	// A contact is about to be destroyed.
+	void RemoveContact(b2Contact* contact);
+
+	void AddJoint(b2Joint* joint);
+	void RemoveJoint(b2Joint* joint);
+
+	// Move a sleeping island to the awake list. Its bodies are woken when it is solved.
+	void WakeIsland(b2PersistentIsland* island);
+
+	// Move an island whose bodies are all asleep to the sleeping list.
+	void SleepIsland(b2PersistentIsland* island);
+
+	// Merge the islands joined since the last call.
+	void MergeIslands();
+
+	// Called after the awake islands were solved. Islands that fell asleep go to the
+	// sleeping list. Islands that lost constraints are split when they fell asleep or
+	// one of their bodies is ready to sleep.
+	void UpdateIslands(b2StackAllocator* allocator);
+
+	b2PersistentIsland* m_awakeList;
+	b2PersistentIsland* m_sleepingList;
+	b2PersistentIsland* m_mergeList;
+	int32 m_islandCount;
+	b2BlockAllocator* m_allocator;
+
+private:
+
+	b2PersistentIsland* CreateIsland(bool awake);
+	void DestroyIsland(b2PersistentIsland* island);
+	void LinkContact(b2Contact* contact);
+	void UnlinkContact(b2Contact* contact);
+	void LinkJoint(b2Joint* joint);
+	void UnlinkJoint(b2Joint* joint);
+	b2PersistentIsland* LinkIslands(b2PersistentIsland* islandA, b2PersistentIsland* islandB);
+	void SplitIsland(b2PersistentIsland* island, b2StackAllocator* allocator);
+
+	// Bodies, contacts and joints are kept in intrusive lists through their m_islandPrev
+	// and m_islandNext members.
+	template <typename T> static void PushItem(T** list, T* item);
+	template <typename T> static void RemoveItem(T** list, T* item);
+};
+
+#endif
@@ -0,0 +1,136 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2TOIQueue.h>
+#include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <string.h>
+
+b2TOIQueue::b2TOIQueue()
+{
+	m_capacity = 16;
+	m_count = 0;
+	m_contacts = (b2Contact**)b2Alloc(m_capacity * sizeof(b2Contact*));
+}
+
+b2TOIQueue::~b2TOIQueue()
+{
+	b2Free(m_contacts);
+}
+
+void b2TOIQueue::Set(int32 index, b2Contact* contact)
+{
+	m_contacts[index] = contact;
+	contact->m_toiIndex = index;
+}
+
+void b2TOIQueue::Update(b2Contact* contact)
+{
+	int32 index = contact->m_toiIndex;
+	if (index == b2_nullTOIIndex)
+	{
+		if (m_count == m_capacity)
+		{
+			b2Contact** old = m_contacts;
+			m_capacity *= 2;
+			m_contacts = (b2Contact**)b2Alloc(m_capacity * sizeof(b2Contact*));
+			memcpy(m_contacts, old, m_count * sizeof(b2Contact*));
+			b2Free(old);
+		}
+
+		index = m_count++;
+		Set(index, contact);
+	}
+
+	b2Assert(m_contacts[index] == contact);
+	SiftUp(index);
+	SiftDown(contact->m_toiIndex);
+}
+
+void b2TOIQueue::Remove(b2Contact* contact)
+{
+	int32 index = contact->m_toiIndex;
+	if (index == b2_nullTOIIndex)
+	{
+		return;
+	}
+
+	b2Assert(m_contacts[index] == contact);
+	contact->m_toiIndex = b2_nullTOIIndex;
+
+	// Fill the hole with the last contact and move that to where it belongs.
+	--m_count;
+	if (index < m_count)
+	{
+		Set(index, m_contacts[m_count]);
+		SiftUp(index);
+		SiftDown(m_contacts[index]->m_toiIndex);
+	}
+}
+
+void b2TOIQueue::Clear()
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		m_contacts[i]->m_toiIndex = b2_nullTOIIndex;
+	}
+	m_count = 0;
+}
+
+void b2TOIQueue::SiftUp(int32 index)
+{
+	b2Contact* contact = m_contacts[index];
+	while (index > 0)
+	{
+		int32 parent = (index - 1) / 2;
+		if (m_contacts[parent]->m_toi <= contact->m_toi)
+		{
+			break;
+		}
+
+		Set(index, m_contacts[parent]);
+		index = parent;
+	}
+	Set(index, contact);
+}
+
+void b2TOIQueue::SiftDown(int32 index)
+{
+	b2Contact* contact = m_contacts[index];
+	for (;;)
+	{
+		int32 child = 2 * index + 1;
+		if (child >= m_count)
+		{
+			break;
+		}
+
+		if (child + 1 < m_count && m_contacts[child + 1]->m_toi < m_contacts[child]->m_toi)
+		{
+			++child;
+		}
+
+		if (contact->m_toi <= m_contacts[child]->m_toi)
+		{
+			break;
+		}
+
+		Set(index, m_contacts[child]);
+		index = child;
+	}
+	Set(index, contact);
+}
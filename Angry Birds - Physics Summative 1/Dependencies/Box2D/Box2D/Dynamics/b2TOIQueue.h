@@ -0,0 +1,72 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_TOI_QUEUE_H
+#define B2_TOI_QUEUE_H
+
+#include <Box2D/Common/b2Settings.h>
+
+#define b2_nullTOIIndex (-1)
+
+class b2Contact;
+
+// Delegate of b2World. A min-heap of the contacts that have a time of impact in the
+// current step, ordered by b2Contact::m_toi. Each queued contact keeps its heap index,
+// so its TOI can be changed or removed in place when a sub-step moves its bodies.
+class b2TOIQueue
+{
+public:
+	b2TOIQueue();
+	~b2TOIQueue();
+
+	// Add a contact, or move it after its m_toi changed.
+	void Update(b2Contact* contact);
+
+	// Remove a contact if it is queued.
+	void Remove(b2Contact* contact);
+
+	// Remove every contact. The buffer is kept for the next step.
+	void Clear();
+
+	// The contact with the earliest TOI, or NULL if the queue is empty.
+	b2Contact* GetMin() const;
+
+	int32 GetCount() const;
+
+private:
+
+	void SiftUp(int32 index);
+	void SiftDown(int32 index);
+	void Set(int32 index, b2Contact* contact);
+
+	b2Contact** m_contacts;
+	int32 m_count;
+	int32 m_capacity;
+};
+
+inline b2Contact* b2TOIQueue::GetMin() const
+{
+	return m_count > 0 ? m_contacts[0] : NULL;
+}
+
+inline int32 b2TOIQueue::GetCount() const
+{
+	return m_count;
+}
+
+#endif
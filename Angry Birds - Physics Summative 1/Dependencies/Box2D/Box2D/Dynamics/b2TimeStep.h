@@ -32,6 +32,12 @@ struct b2Profile
 	float32 solvePosition;
 	float32 broadphase;
 	float32 solveTOI;
+
+	// Stack allocations of the step that didn't fit in the arenas and went to b2Alloc,
+	// and the size of all arenas after the step.
+	int32 stackSpillCount;
+	int32 stackSpillSize;
+	int32 stackCapacity;
 };
 
 /// This is an internal structure.
@@ -43,28 +49,43 @@ struct b2TimeStep
 	int32 velocityIterations;
 	int32 positionIterations;
 	bool warmStarting;
+	int32 wideContactLanes;	// 0 for the scalar contact solver
+	bool speculativeContacts;	// contact points may be apart, by up to a step of motion
+	int32 softSubSteps;		// 0 for velocity and position iterations
+	bool jointChains;		// solve chains of joints directly
 };
 
-/// This is an internal structure.
+/// This is an internal structure. The positions of an island's bodies, stored as one
+/// stream per coordinate so the island can integrate several bodies at a time. It only
+/// points at the island's streams, so a const b2Position can still change them.
 struct b2Position
 {
-	b2Vec2 c;
-	float32 a;
+	b2Vec2 GetCenter(int32 index) const { return b2Vec2(x[index], y[index]); }
+	void SetCenter(int32 index, const b2Vec2& c) const { x[index] = c.x; y[index] = c.y; }
+
+	float32* x;
+	float32* y;
+	float32* a;
 };
 
-/// This is an internal structure.
+/// This is an internal structure. The velocities of an island's bodies, one stream per component.
 struct b2Velocity
 {
-	b2Vec2 v;
-	float32 w;
+	b2Vec2 GetLinear(int32 index) const { return b2Vec2(vx[index], vy[index]); }
+	void SetLinear(int32 index, const b2Vec2& v) const { vx[index] = v.x; vy[index] = v.y; }
+
+	float32* vx;
+	float32* vy;
+	float32* w;
 };
 
 /// Solver Data
 struct b2SolverData
 {
 	b2TimeStep step;
-	b2Position* positions;
-	b2Velocity* velocities;
+	b2Position positions;
+	b2Velocity velocities;
+	const int32* sharedSlots;	// island slot of each shared static body, or NULL
 };
 
 #endif
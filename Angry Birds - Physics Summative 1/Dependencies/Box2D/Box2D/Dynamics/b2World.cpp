@@ -23,6 +23,7 @@
 #include <Box2D/Dynamics/Joints/b2PulleyJoint.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
+#include <Box2D/Dynamics/Contacts/b2WideContactSolver.h>
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Collision/b2BroadPhase.h>
 #include <Box2D/Collision/Shapes/b2CircleShape.h>
@@ -31,10 +32,94 @@
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 #include <Box2D/Collision/b2TimeOfImpact.h>
 #include <Box2D/Common/b2Draw.h>
+#include <Box2D/Common/b2TaskScheduler.h>
 #include <Box2D/Common/b2Timer.h>
 #include <new>
 
-b2World::b2World(const b2Vec2& gravity)
+// The slice of the world's island arrays that belongs to one island of a parallel solve.
+struct b2IslandRange
+{
+	int32 bodyStart, bodyCount;
+	int32 contactStart, contactCount;
+	int32 jointStart, jointCount;
+	int32 sharedStart, sharedCount;
+	b2Profile profile;
+};
+
+// The static bodies of a parallel solve. Static bodies are only read by the solver, so each
+// one is solved as part of every island that touches it.
+struct b2SharedBodies
+{
+	b2Body** bodies;		// every shared body once, its island index is its index here
+	int32* lastIslands;		// the last island that touched each shared body
+	int32 count;
+	int32* islandIndices;	// the shared bodies each island touches, one island after another
+	int32 islandCount;
+	int32 island;			// the island being built
+};
+
+// Solves islands on the task scheduler's threads. Every island gets the shared static
+// bodies it touches first, followed by its own bodies, which no other island touches.
+class b2IslandSolveTask : public b2Task
+{
+public:
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		b2StackAllocator* allocator = allocators[threadIndex];
+
+		for (int32 i = begin; i < end; ++i)
+		{
+			b2IslandRange* range = ranges + i;
+
+			// The listener isn't called here, post solve is reported in island order once all
+			// islands are solved.
+			b2Island island(range->sharedCount + range->bodyCount, range->contactCount, range->jointCount, allocator, NULL);
+			if (impulses)
+			{
+				island.m_impulses = impulses + range->contactStart;
+			}
+
+			// Only the slots of the shared bodies this island touches are written and read.
+			int32* sharedSlots = (int32*)allocator->Allocate(shared->count * sizeof(int32));
+			island.m_sharedSlots = sharedSlots;
+
+			for (int32 j = 0; j < range->sharedCount; ++j)
+			{
+				int32 index = shared->islandIndices[range->sharedStart + j];
+				sharedSlots[index] = j;
+				island.AddShared(shared->bodies[index]);
+			}
+			for (int32 j = 0; j < range->bodyCount; ++j)
+			{
+				island.Add(islands->m_bodies[range->bodyStart + j]);
+			}
+			for (int32 j = 0; j < range->contactCount; ++j)
+			{
+				island.Add(islands->m_contacts[range->contactStart + j]);
+			}
+			for (int32 j = 0; j < range->jointCount; ++j)
+			{
+				island.Add(islands->m_joints[range->jointStart + j]);
+			}
+
+			island.Solve(&range->profile, *step, gravity, allowSleep);
+
+			allocator->Free(sharedSlots);
+		}
+	}
+
+	const b2Island* islands;
+	b2IslandRange* ranges;
+	b2ContactImpulse* impulses;
+	const b2SharedBodies* shared;
+	b2StackAllocator** allocators;
+	const b2TimeStep* step;
+	b2Vec2 gravity;
+	bool allowSleep;
+};
+
+b2World::b2World(const b2Vec2& gravity, int32 stackSize)
+	: m_stackAllocator(stackSize)
 {
 	m_destructionListener = NULL;
 	g_debugDraw = NULL;
@@ -44,10 +129,15 @@ b2World::b2World(const b2Vec2& gravity)
 
 	m_bodyCount = 0;
 	m_jointCount = 0;
+	m_chainFixtureCount = 0;
 
 	m_warmStarting = true;
 	m_continuousPhysics = true;
+	m_speculativeContacts = false;
+	m_softSubSteps = 0;
+	m_jointChains = false;
 	m_subStepping = false;
+	m_wideContactLanes = 0;
 
 	m_stepComplete = true;
 
@@ -59,6 +149,13 @@ b2World::b2World(const b2Vec2& gravity)
 	m_inv_dt0 = 0.0f;
 
 	m_contactManager.m_allocator = &m_blockAllocator;
+	m_contactManager.m_islandManager = &m_islandManager;
+	m_islandManager.m_allocator = &m_blockAllocator;
+
+	m_taskScheduler = NULL;
+	m_threadAllocators = NULL;
+	m_threadAllocatorCount = 0;
+	m_stackSize = stackSize;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
 }
@@ -82,6 +179,8 @@ b2World::~b2World()
 
 		b = bNext;
 	}
+
+	SetTaskScheduler(NULL);
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -104,6 +203,42 @@ void b2World::SetDebugDraw(b2Draw* debugDraw)
 	g_debugDraw = debugDraw;
 }
 
+void b2World::SetTaskScheduler(b2TaskScheduler* scheduler)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < m_threadAllocatorCount; ++i)
+	{
+		m_threadAllocators[i].~b2StackAllocator();
+	}
+	b2Free(m_threadAllocators);
+	m_threadAllocators = NULL;
+	m_threadAllocatorCount = 0;
+
+	m_taskScheduler = scheduler;
+	m_contactManager.m_taskScheduler = scheduler;
+	m_contactManager.m_broadPhase.SetTaskScheduler(scheduler);
+	if (scheduler == NULL)
+	{
+		return;
+	}
+
+	b2Assert(0 < scheduler->GetThreadCount() && scheduler->GetThreadCount() <= b2_maxTaskThreads);
+	m_threadAllocatorCount = scheduler->GetThreadCount() - 1;
+	if (m_threadAllocatorCount > 0)
+	{
+		m_threadAllocators = (b2StackAllocator*)b2Alloc(m_threadAllocatorCount * sizeof(b2StackAllocator));
+		for (int32 i = 0; i < m_threadAllocatorCount; ++i)
+		{
+			new (m_threadAllocators + i) b2StackAllocator(m_stackSize);
+		}
+	}
+}
+
 b2Body* b2World::CreateBody(const b2BodyDef* def)
 {
 	b2Assert(IsLocked() == false);
@@ -125,6 +260,8 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 	m_bodyList = b;
 	++m_bodyCount;
 
+	m_islandManager.AddBody(b);
+
 	return b;
 }
 
@@ -177,6 +314,11 @@ void b2World::DestroyBody(b2Body* b)
 			m_destructionListener->SayGoodbye(f0);
 		}
 
+		if (f0->GetType() == b2Shape::e_chain)
+		{
+			--m_chainFixtureCount;
+		}
+
 		f0->DestroyProxies(&m_contactManager.m_broadPhase);
 		f0->Destroy(&m_blockAllocator);
 		f0->~b2Fixture();
@@ -188,6 +330,8 @@ void b2World::DestroyBody(b2Body* b)
 	b->m_fixtureList = NULL;
 	b->m_fixtureCount = 0;
 
+	m_islandManager.RemoveBody(b);
+
 	// Remove world body list.
 	if (b->m_prev)
 	{
@@ -264,7 +408,9 @@ b2Joint* b2World::CreateJoint(const b2JointDef* def)
 		}
 	}
 
-	// Note: creating a joint doesn't wake the bodies.
+	// Note: creating a joint doesn't wake the bodies. Joining an awake island wakes the
+	// other island at the next step.
+	m_islandManager.AddJoint(j);
 
 	return j;
 }
@@ -296,6 +442,8 @@ void b2World::DestroyJoint(b2Joint* j)
 	}
 
 	// Disconnect from island graph.
+	m_islandManager.RemoveJoint(j);
+
 	b2Body* bodyA = j->m_bodyA;
 	b2Body* bodyB = j->m_bodyB;
 
@@ -364,6 +512,52 @@ void b2World::DestroyJoint(b2Joint* j)
 	}
 }
 
+void b2World::Clear()
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	// Free what chain shapes allocated with b2Alloc.
+	for (b2Body* b = m_bodyList; b && m_chainFixtureCount > 0; b = b->m_next)
+	{
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			if (f->GetType() == b2Shape::e_chain)
+			{
+				f->m_proxyCount = 0;
+				f->Destroy(&m_blockAllocator);
+				--m_chainFixtureCount;
+			}
+		}
+	}
+	b2Assert(m_chainFixtureCount == 0);
+
+	m_bodyList = NULL;
+	m_jointList = NULL;
+	m_bodyCount = 0;
+	m_jointCount = 0;
+
+	m_contactManager.m_contactList = NULL;
+	m_contactManager.m_contactCount = 0;
+	m_contactManager.m_broadPhase.Clear();
+
+	m_islandManager.m_awakeList = NULL;
+	m_islandManager.m_sleepingList = NULL;
+	m_islandManager.m_mergeList = NULL;
+	m_islandManager.m_islandCount = 0;
+
+	// Bodies, fixtures, shapes, joints, contacts and islands all live in the block
+	// allocator.
+	m_blockAllocator.Reset();
+
+	m_flags &= ~e_newFixture;
+	m_stepComplete = true;
+	m_inv_dt0 = 0.0f;
+}
+
 //
 void b2World::SetAllowSleeping(bool flag)
 {
@@ -382,335 +576,465 @@ void b2World::SetAllowSleeping(bool flag)
 	}
 }
 
-// Find islands, integrate and solve constraints, solve position constraints
-void b2World::Solve(const b2TimeStep& step)
+void b2World::SetWideContactSolver(bool flag)
 {
-	m_profile.solveInit = 0.0f;
-	m_profile.solveVelocity = 0.0f;
-	m_profile.solvePosition = 0.0f;
-
-	// Size the island for the worst case.
-	b2Island island(m_bodyCount,
-					m_contactManager.m_contactCount,
-					m_jointCount,
-					&m_stackAllocator,
-					m_contactManager.m_contactListener);
+	SetWideContactLanes(flag ? b2GetWideContactLanes() : 0);
+}
 
-	// Clear all the island flags.
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
+void b2World::SetWideContactLanes(int32 lanes)
+{
+	int32 supported = b2GetWideContactLanes();
+	if (lanes >= 8 && supported >= 8)
 	{
-		b->m_flags &= ~b2Body::e_islandFlag;
+		m_wideContactLanes = 8;
 	}
-	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	else if (lanes >= 4 && supported >= 4)
 	{
-		c->m_flags &= ~b2Contact::e_islandFlag;
+		m_wideContactLanes = 4;
 	}
-	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	else if (lanes >= 1)
 	{
-		j->m_islandFlag = false;
+		m_wideContactLanes = 1;
 	}
-
-	// Build and simulate all awake islands.
-	int32 stackSize = m_bodyCount;
-	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
-	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	else
 	{
-		if (seed->m_flags & b2Body::e_islandFlag)
-		{
-			continue;
-		}
+		m_wideContactLanes = 0;
+	}
+}
 
-		if (seed->IsAwake() == false || seed->IsActive() == false)
-		{
-			continue;
-		}
+void b2World::SetSoftSubSteps(int32 count)
+{
+	m_softSubSteps = b2Max(count, 0);
+}
 
-		// The seed can be dynamic or kinematic.
-		if (seed->GetType() == b2_staticBody)
-		{
-			continue;
-		}
+// Integrate and solve constraints, solve position constraints for the awake islands
+void b2World::Solve(const b2TimeStep& step)
+{
+	m_profile.solveInit = 0.0f;
+	m_profile.solveVelocity = 0.0f;
+	m_profile.solvePosition = 0.0f;
 
-		// Reset island and stack.
-		island.Clear();
-		int32 stackCount = 0;
-		stack[stackCount++] = seed;
-		seed->m_flags |= b2Body::e_islandFlag;
+	// Join the islands that new contacts and joints connected since the last step.
+	m_islandManager.MergeIslands();
 
-		// Perform a depth first search (DFS) on the constraint graph.
-		while (stackCount > 0)
+	if (m_taskScheduler)
+	{
+		SolveParallel(step);
+	}
+	else
+	{
+		// Size the island for the worst case.
+		b2Island island(m_bodyCount,
+						m_contactManager.m_contactCount,
+						m_jointCount,
+						&m_stackAllocator,
+						m_contactManager.m_contactListener);
+
+		// Simulate all awake islands.
+		b2PersistentIsland* next;
+		for (b2PersistentIsland* source = m_islandManager.m_awakeList; source; source = next)
 		{
-			// Grab the next body off the stack and add it to the island.
-			b2Body* b = stack[--stackCount];
-			b2Assert(b->IsActive() == true);
-			island.Add(b);
-
-			// Make sure the body is awake.
-			b->SetAwake(true);
+			next = source->next;
 
-			// To keep islands as small as possible, we don't
-			// propagate islands across static bodies.
-			if (b->GetType() == b2_staticBody)
+			island.Clear();
+			if (BuildIsland(source, &island, NULL) == false)
 			{
+				m_islandManager.SleepIsland(source);
 				continue;
 			}
 
-			// Search all contacts connected to this body.
-			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
-			{
-				b2Contact* contact = ce->contact;
+			b2Profile profile;
+			island.Solve(&profile, step, m_gravity, m_allowSleep);
+			m_profile.solveInit += profile.solveInit;
+			m_profile.solveVelocity += profile.solveVelocity;
+			m_profile.solvePosition += profile.solvePosition;
 
-				// Has this contact already been added to an island?
-				if (contact->m_flags & b2Contact::e_islandFlag)
+			// Post solve cleanup.
+			for (int32 i = 0; i < island.m_bodyCount; ++i)
+			{
+				// Allow static bodies to participate in other islands.
+				b2Body* b = island.m_bodies[i];
+				if (b->GetType() == b2_staticBody)
 				{
-					continue;
+					b->m_flags &= ~b2Body::e_islandFlag;
 				}
+			}
+		}
+	}
 
-				// Is this contact solid and touching?
-				if (contact->IsEnabled() == false ||
-					contact->IsTouching() == false)
+	{
+		b2Timer timer;
+		// Synchronize fixtures, check for out of range bodies. Only the bodies of the
+		// islands that were solved moved.
+		for (b2PersistentIsland* source = m_islandManager.m_awakeList; source; source = source->next)
+		{
+			for (b2Body* b = source->bodyList; b; b = b->m_islandNext)
+			{
+				// Update fixtures (for broad-phase).
+				if (step.speculativeContacts)
 				{
-					continue;
+					b->SynchronizePredictedFixtures(step.dt);
 				}
-
-				// Skip sensors.
-				bool sensorA = contact->m_fixtureA->m_isSensor;
-				bool sensorB = contact->m_fixtureB->m_isSensor;
-				if (sensorA || sensorB)
+				else
 				{
-					continue;
+					b->SynchronizeFixtures();
 				}
+			}
+		}
 
-				island.Add(contact);
-				contact->m_flags |= b2Contact::e_islandFlag;
+		// Put islands that fell asleep aside and split the ones that came apart, before
+		// new contacts can wake any of their bodies.
+		m_islandManager.UpdateIslands(&m_stackAllocator);
 
-				b2Body* other = ce->other;
+		// Look for new contacts.
+		m_contactManager.FindNewContacts();
+		m_profile.broadphase = timer.GetMilliseconds();
+	}
+}
 
-				// Was the other body already added to this island?
-				if (other->m_flags & b2Body::e_islandFlag)
-				{
-					continue;
-				}
+// Gather all awake islands first, then solve them on the task scheduler. Islands share no
+// dynamic bodies, contacts or joints, so each island's result is the same as when they are
+// solved one after another, whichever thread solves it.
+void b2World::SolveParallel(const b2TimeStep& step)
+{
+	// Every island's bodies, contacts and joints, one island after another. No listener,
+	// this island is never solved.
+	b2Island islands(m_bodyCount,
+					 m_contactManager.m_contactCount,
+					 m_jointCount,
+					 &m_stackAllocator,
+					 NULL);
+
+	// There can't be more islands than bodies.
+	b2IslandRange* ranges = (b2IslandRange*)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2IslandRange));
+	int32 islandCount = 0;
+
+	// A contact or a joint touches at most two static bodies.
+	b2SharedBodies shared;
+	shared.bodies = (b2Body**)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2Body*));
+	shared.lastIslands = (int32*)m_stackAllocator.Allocate(m_bodyCount * sizeof(int32));
+	shared.count = 0;
+	shared.islandIndices = (int32*)m_stackAllocator.Allocate(2 * (m_contactManager.m_contactCount + m_jointCount) * sizeof(int32));
+	shared.islandCount = 0;
+
+	b2PersistentIsland* next;
+	for (b2PersistentIsland* source = m_islandManager.m_awakeList; source; source = next)
+	{
+		next = source->next;
 
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
-			}
+		b2IslandRange* range = ranges + islandCount;
+		range->bodyStart = islands.m_bodyCount;
+		range->contactStart = islands.m_contactCount;
+		range->jointStart = islands.m_jointCount;
+		range->sharedStart = shared.islandCount;
 
-			// Search all joints connect to this body.
-			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
-			{
-				if (je->joint->m_islandFlag == true)
-				{
-					continue;
-				}
+		shared.island = islandCount;
+		if (BuildIsland(source, &islands, &shared) == false)
+		{
+			m_islandManager.SleepIsland(source);
+			continue;
+		}
 
-				b2Body* other = je->other;
+		range->bodyCount = islands.m_bodyCount - range->bodyStart;
+		range->contactCount = islands.m_contactCount - range->contactStart;
+		range->jointCount = islands.m_jointCount - range->jointStart;
+		range->sharedCount = shared.islandCount - range->sharedStart;
+		++islandCount;
+	}
 
-				// Don't simulate joints connected to inactive bodies.
-				if (other->IsActive() == false)
-				{
-					continue;
-				}
+	b2ContactListener* listener = m_contactManager.m_contactListener;
+	b2ContactImpulse* impulses = NULL;
+	if (listener)
+	{
+		impulses = (b2ContactImpulse*)m_stackAllocator.Allocate(islands.m_contactCount * sizeof(b2ContactImpulse));
+	}
 
-				island.Add(je->joint);
-				je->joint->m_islandFlag = true;
+	b2StackAllocator* allocators[b2_maxTaskThreads];
+	allocators[0] = &m_stackAllocator;
+	for (int32 i = 0; i < m_threadAllocatorCount; ++i)
+	{
+		allocators[i + 1] = m_threadAllocators + i;
+	}
 
-				if (other->m_flags & b2Body::e_islandFlag)
-				{
-					continue;
-				}
+	b2IslandSolveTask task;
+	task.islands = &islands;
+	task.ranges = ranges;
+	task.impulses = impulses;
+	task.shared = &shared;
+	task.allocators = allocators;
+	task.step = &step;
+	task.gravity = m_gravity;
+	task.allowSleep = m_allowSleep;
+	m_taskScheduler->ParallelFor(&task, islandCount, 1);
+
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		m_profile.solveInit += ranges[i].profile.solveInit;
+		m_profile.solveVelocity += ranges[i].profile.solveVelocity;
+		m_profile.solvePosition += ranges[i].profile.solvePosition;
+	}
 
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
-			}
+	// Report on this thread, in the same order as solving the islands one by one would.
+	if (listener)
+	{
+		for (int32 i = 0; i < islands.m_contactCount; ++i)
+		{
+			listener->PostSolve(islands.m_contacts[i], impulses + i);
 		}
+		m_stackAllocator.Free(impulses);
+	}
 
-		b2Profile profile;
-		island.Solve(&profile, step, m_gravity, m_allowSleep);
-		m_profile.solveInit += profile.solveInit;
-		m_profile.solveVelocity += profile.solveVelocity;
-		m_profile.solvePosition += profile.solvePosition;
+	// Static bodies are in no island once the step is done.
+	for (int32 i = 0; i < shared.count; ++i)
+	{
+		shared.bodies[i]->m_flags &= ~b2Body::e_islandFlag;
+	}
 
-		// Post solve cleanup.
-		for (int32 i = 0; i < island.m_bodyCount; ++i)
-		{
-			// Allow static bodies to participate in other islands.
-			b2Body* b = island.m_bodies[i];
-			if (b->GetType() == b2_staticBody)
-			{
-				b->m_flags &= ~b2Body::e_islandFlag;
-			}
-		}
+	m_stackAllocator.Free(shared.islandIndices);
+	m_stackAllocator.Free(shared.lastIslands);
+	m_stackAllocator.Free(shared.bodies);
+	m_stackAllocator.Free(ranges);
+}
+
+// Add the bodies, contacts and joints of a persistent island to the island that is
+// solved. Static bodies belong to no persistent island, they are added once for each island
+// they touch or, when shared is given, recorded in the shared bodies of the island. Returns
+// false without adding anything when every body of the island has been put to sleep.
+bool b2World::BuildIsland(b2PersistentIsland* source, b2Island* island, b2SharedBodies* shared)
+{
+	// An island is simulated while any of its bodies is awake.
+	b2Body* awakeBody = source->bodyList;
+	while (awakeBody && awakeBody->IsAwake() == false)
+	{
+		awakeBody = awakeBody->m_islandNext;
 	}
 
-	m_stackAllocator.Free(stack);
+	if (awakeBody == NULL)
+	{
+		return false;
+	}
 
+	for (b2Body* b = source->bodyList; b; b = b->m_islandNext)
 	{
-		b2Timer timer;
-		// Synchronize fixtures, check for out of range bodies.
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
-		{
-			// If a body was not in an island then it did not move.
-			if ((b->m_flags & b2Body::e_islandFlag) == 0)
-			{
-				continue;
-			}
+		b2Assert(b->IsActive() == true);
+		island->Add(b);
 
-			if (b->GetType() == b2_staticBody)
-			{
-				continue;
-			}
+		// Make sure the body is awake.
+		b->SetAwake(true);
+	}
 
-			// Update fixtures (for broad-phase).
-			b->SynchronizeFixtures();
+	// Contacts in the island are solid and touching.
+	for (b2Contact* contact = source->contactList; contact; contact = contact->m_islandNext)
+	{
+		// Was the contact disabled by the user?
+		if (contact->IsEnabled() == false)
+		{
+			continue;
 		}
 
-		// Look for new contacts.
-		m_contactManager.FindNewContacts();
-		m_profile.broadphase = timer.GetMilliseconds();
+		island->Add(contact);
+		AddStaticBody(contact->m_fixtureA->m_body, island, shared);
+		AddStaticBody(contact->m_fixtureB->m_body, island, shared);
+	}
+
+	// Joints in the island only connect active bodies.
+	for (b2Joint* joint = source->jointList; joint; joint = joint->m_islandNext)
+	{
+		island->Add(joint);
+		AddStaticBody(joint->m_bodyA, island, shared);
+		AddStaticBody(joint->m_bodyB, island, shared);
 	}
+
+	return true;
 }
 
-// Find TOI contacts and solve them.
-void b2World::SolveTOI(const b2TimeStep& step)
+void b2World::AddStaticBody(b2Body* body, b2Island* island, b2SharedBodies* shared)
 {
-	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
+	if (body->GetType() != b2_staticBody)
+	{
+		return;
+	}
 
-	if (m_stepComplete)
+	if (shared)
 	{
-		for (b2Body* b = m_bodyList; b; b = b->m_next)
+		// A shared body keeps its island flag and index until the end of the step.
+		if ((body->m_flags & b2Body::e_islandFlag) == 0)
 		{
-			b->m_flags &= ~b2Body::e_islandFlag;
-			b->m_sweep.alpha0 = 0.0f;
+			body->m_flags |= b2Body::e_islandFlag;
+			body->m_islandIndex = shared->count;
+			shared->bodies[shared->count] = body;
+			shared->lastIslands[shared->count] = -1;
+			++shared->count;
 		}
 
-		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		int32 index = body->m_islandIndex;
+		if (shared->lastIslands[index] != shared->island)
 		{
-			// Invalidate TOI
-			c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
-			c->m_toiCount = 0;
-			c->m_toi = 1.0f;
+			shared->lastIslands[index] = shared->island;
+			shared->islandIndices[shared->islandCount++] = index;
 		}
+		return;
 	}
 
-	// Find TOI events and solve them.
-	for (;;)
+	if (body->m_flags & b2Body::e_islandFlag)
 	{
-		// Find the first TOI.
-		b2Contact* minContact = NULL;
-		float32 minAlpha = 1.0f;
+		return;
+	}
 
-		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	body->m_flags |= b2Body::e_islandFlag;
+	island->Add(body);
+	body->SetAwake(true);
+}
+
+// Compute the TOI of a contact unless it has a valid cached one, and queue it if it is
+// before the end of the step.
+void b2World::UpdateTOIEvent(b2Contact* c)
+{
+	// Is this contact disabled?
+	if (c->IsEnabled() == false)
+	{
+		m_toiQueue.Remove(c);
+		return;
+	}
+
+	// Prevent excessive sub-stepping.
+	if (c->m_toiCount > b2_maxSubSteps)
+	{
+		m_toiQueue.Remove(c);
+		return;
+	}
+
+	if ((c->m_flags & b2Contact::e_toiFlag) == 0)
+	{
+		b2Fixture* fA = c->GetFixtureA();
+		b2Fixture* fB = c->GetFixtureB();
+
+		// Is there a sensor?
+		if (fA->IsSensor() || fB->IsSensor())
 		{
-			// Is this contact disabled?
-			if (c->IsEnabled() == false)
-			{
-				continue;
-			}
+			m_toiQueue.Remove(c);
+			return;
+		}
 
-			// Prevent excessive sub-stepping.
-			if (c->m_toiCount > b2_maxSubSteps)
-			{
-				continue;
-			}
+		b2Body* bA = fA->GetBody();
+		b2Body* bB = fB->GetBody();
 
-			float32 alpha = 1.0f;
-			if (c->m_flags & b2Contact::e_toiFlag)
-			{
-				// This contact has a valid cached TOI.
-				alpha = c->m_toi;
-			}
-			else
-			{
-				b2Fixture* fA = c->GetFixtureA();
-				b2Fixture* fB = c->GetFixtureB();
+		b2BodyType typeA = bA->m_type;
+		b2BodyType typeB = bB->m_type;
+		b2Assert(typeA == b2_dynamicBody || typeB == b2_dynamicBody);
 
-				// Is there a sensor?
-				if (fA->IsSensor() || fB->IsSensor())
-				{
-					continue;
-				}
+		bool activeA = bA->IsAwake() && typeA != b2_staticBody;
+		bool activeB = bB->IsAwake() && typeB != b2_staticBody;
 
-				b2Body* bA = fA->GetBody();
-				b2Body* bB = fB->GetBody();
+		// Is at least one body active (awake and dynamic or kinematic)?
+		if (activeA == false && activeB == false)
+		{
+			m_toiQueue.Remove(c);
+			return;
+		}
 
-				b2BodyType typeA = bA->m_type;
-				b2BodyType typeB = bB->m_type;
-				b2Assert(typeA == b2_dynamicBody || typeB == b2_dynamicBody);
+		bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
+		bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
 
-				bool activeA = bA->IsAwake() && typeA != b2_staticBody;
-				bool activeB = bB->IsAwake() && typeB != b2_staticBody;
+		// Are these two non-bullet dynamic bodies?
+		if (collideA == false && collideB == false)
+		{
+			m_toiQueue.Remove(c);
+			return;
+		}
 
-				// Is at least one body active (awake and dynamic or kinematic)?
-				if (activeA == false && activeB == false)
-				{
-					continue;
-				}
+		// Compute the TOI for this contact.
+		// Put the sweeps onto the same time interval.
+		float32 alpha0 = bA->m_sweep.alpha0;
 
-				bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
-				bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
+		if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
+		{
+			alpha0 = bB->m_sweep.alpha0;
+			bA->m_sweep.Advance(alpha0);
+		}
+		else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
+		{
+			alpha0 = bA->m_sweep.alpha0;
+			bB->m_sweep.Advance(alpha0);
+		}
 
-				// Are these two non-bullet dynamic bodies?
-				if (collideA == false && collideB == false)
-				{
-					continue;
-				}
+		b2Assert(alpha0 < 1.0f);
 
-				// Compute the TOI for this contact.
-				// Put the sweeps onto the same time interval.
-				float32 alpha0 = bA->m_sweep.alpha0;
+		int32 indexA = c->GetChildIndexA();
+		int32 indexB = c->GetChildIndexB();
 
-				if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
-				{
-					alpha0 = bB->m_sweep.alpha0;
-					bA->m_sweep.Advance(alpha0);
-				}
-				else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
-				{
-					alpha0 = bA->m_sweep.alpha0;
-					bB->m_sweep.Advance(alpha0);
-				}
+		// Compute the time of impact in interval [0, minTOI]
+		b2TOIInput input;
+		input.proxyA.Set(fA->GetShape(), indexA);
+		input.proxyB.Set(fB->GetShape(), indexB);
+		input.sweepA = bA->m_sweep;
+		input.sweepB = bB->m_sweep;
+		input.tMax = 1.0f;
 
-				b2Assert(alpha0 < 1.0f);
+		b2TOIOutput output;
+		b2TimeOfImpact(&output, &input);
 
-				int32 indexA = c->GetChildIndexA();
-				int32 indexB = c->GetChildIndexB();
+		// Beta is the fraction of the remaining portion of the .
+		float32 beta = output.t;
+		float32 alpha;
+		if (output.state == b2TOIOutput::e_touching)
+		{
+			alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
+		}
+		else
+		{
+			alpha = 1.0f;
+		}
 
-				// Compute the time of impact in interval [0, minTOI]
-				b2TOIInput input;
-				input.proxyA.Set(fA->GetShape(), indexA);
-				input.proxyB.Set(fB->GetShape(), indexB);
-				input.sweepA = bA->m_sweep;
-				input.sweepB = bB->m_sweep;
-				input.tMax = 1.0f;
+		c->m_toi = alpha;
+		c->m_flags |= b2Contact::e_toiFlag;
+	}
 
-				b2TOIOutput output;
-				b2TimeOfImpact(&output, &input);
+	if (c->m_toi < 1.0f)
+	{
+		m_toiQueue.Update(c);
+	}
+	else
+	{
+		m_toiQueue.Remove(c);
+	}
+}
 
-				// Beta is the fraction of the remaining portion of the .
-				float32 beta = output.t;
-				if (output.state == b2TOIOutput::e_touching)
-				{
-					alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
-				}
-				else
-				{
-					alpha = 1.0f;
-				}
+// Find TOI contacts and solve them.
+void b2World::SolveTOI(const b2TimeStep& step)
+{
+	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
 
-				c->m_toi = alpha;
-				c->m_flags |= b2Contact::e_toiFlag;
-			}
+	if (m_stepComplete)
+	{
+		for (b2Body* b = m_bodyList; b; b = b->m_next)
+		{
+			b->m_flags &= ~b2Body::e_islandFlag;
+			b->m_sweep.alpha0 = 0.0f;
+		}
 
-			if (alpha < minAlpha)
-			{
-				// This is the minimum TOI found so far.
-				minContact = c;
-				minAlpha = alpha;
-			}
+		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		{
+			// Invalidate TOI
+			c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
+			c->m_toiCount = 0;
+			c->m_toi = 1.0f;
 		}
+	}
+
+	// Queue the TOI events of all contacts once. After that only the contacts of the bodies
+	// moved by a sub-step change, so the queue is updated for those alone.
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		UpdateTOIEvent(c);
+	}
+
+	// Find TOI events and solve them.
+	for (;;)
+	{
+		// Find the first TOI.
+		b2Contact* minContact = m_toiQueue.GetMin();
+		float32 minAlpha = minContact ? minContact->m_toi : 1.0f;
 
 		if (minContact == NULL || 1.0f - 10.0f * b2_epsilon < minAlpha)
 		{
@@ -719,6 +1043,8 @@ void b2World::SolveTOI(const b2TimeStep& step)
 			break;
 		}
 
+		m_toiQueue.Remove(minContact);
+
 		// Advance the bodies to the TOI.
 		b2Fixture* fA = minContact->GetFixtureA();
 		b2Fixture* fB = minContact->GetFixtureB();
@@ -733,6 +1059,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 
 		// The TOI contact likely has some new contact points.
 		minContact->Update(m_contactManager.m_contactListener);
+		m_islandManager.UpdateContact(minContact);
 		minContact->m_flags &= ~b2Contact::e_toiFlag;
 		++minContact->m_toiCount;
 
@@ -813,6 +1140,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 
 					// Update the contact points
 					contact->Update(m_contactManager.m_contactListener);
+					m_islandManager.UpdateContact(contact);
 
 					// Was the contact disabled by the user?
 					if (contact->IsEnabled() == false)
@@ -860,6 +1188,10 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		subStep.positionIterations = 20;
 		subStep.velocityIterations = step.velocityIterations;
 		subStep.warmStarting = false;
+		subStep.wideContactLanes = 0;
+		subStep.speculativeContacts = false;
+		subStep.softSubSteps = 0;
+		subStep.jointChains = false;
 		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
 
 		// Reset island flags and synchronize broad-phase proxies.
@@ -883,15 +1215,38 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		}
 
 		// Commit fixture proxy movements to the broad-phase so that new contacts are created.
-		// Also, some contacts can be destroyed.
+		// Contacts are only destroyed in Collide, so the queued ones stay valid.
 		m_contactManager.FindNewContacts();
 
+		// Update the TOI events of the displaced bodies. The new contacts all have one of these
+		// bodies, as only their proxies moved. Other contacts keep their TOI, except ones that
+		// became active because the sub-step woke their bodies. Those bodies have not moved in
+		// this step and can't have a TOI event.
+		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			b2Body* body = island.m_bodies[i];
+			if (body->m_type != b2_dynamicBody)
+			{
+				continue;
+			}
+
+			for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
+			{
+				if ((ce->contact->m_flags & b2Contact::e_toiFlag) == 0)
+				{
+					UpdateTOIEvent(ce->contact);
+				}
+			}
+		}
+
 		if (m_subStepping)
 		{
 			m_stepComplete = false;
 			break;
 		}
 	}
+
+	m_toiQueue.Clear();
 }
 
 void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIterations)
@@ -923,11 +1278,16 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	step.dtRatio = m_inv_dt0 * dt;
 
 	step.warmStarting = m_warmStarting;
+	step.wideContactLanes = m_wideContactLanes;
+	// The soft step solver handles separated points, so it always uses speculative contacts.
+	step.speculativeContacts = m_speculativeContacts || m_softSubSteps > 0;
+	step.softSubSteps = m_softSubSteps;
+	step.jointChains = m_jointChains;
 	
 	// Update contacts. This is where some contacts are destroyed.
 	{
 		b2Timer timer;
-		m_contactManager.Collide();
+		m_contactManager.Collide(step.speculativeContacts ? step.dt : 0.0f);
 		m_profile.collide = timer.GetMilliseconds();
 	}
 
@@ -939,8 +1299,8 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 		m_profile.solve = timer.GetMilliseconds();
 	}
 
-	// Handle TOI events.
-	if (m_continuousPhysics && step.dt > 0.0f)
+	// Handle TOI events. Speculative contacts already kept the bodies from tunnelling.
+	if (m_continuousPhysics && step.speculativeContacts == false && step.dt > 0.0f)
 	{
 		b2Timer timer;
 		SolveTOI(step);
@@ -959,6 +1319,20 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 
 	m_flags &= ~e_locked;
 
+	// Report and reset the spills of all threads.
+	m_profile.stackSpillCount = m_stackAllocator.GetSpillCount();
+	m_profile.stackSpillSize = m_stackAllocator.GetSpillSize();
+	m_profile.stackCapacity = m_stackAllocator.GetCapacity();
+	m_stackAllocator.ResetSpillStats();
+	for (int32 i = 0; i < m_threadAllocatorCount; ++i)
+	{
+		b2StackAllocator* allocator = m_threadAllocators + i;
+		m_profile.stackSpillCount += allocator->GetSpillCount();
+		m_profile.stackSpillSize += allocator->GetSpillSize();
+		m_profile.stackCapacity += allocator->GetCapacity();
+		allocator->ResetSpillStats();
+	}
+
 	m_profile.step = stepTimer.GetMilliseconds();
 }
 
@@ -1028,6 +1402,97 @@ void b2World::RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b
 	m_contactManager.m_broadPhase.RayCast(&wrapper, input);
 }
 
+struct b2WorldQueryBatchWrapper
+{
+	bool QueryCallback(int32 proxyId, int32 index)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		if ((proxy->fixture->GetFilterData().categoryBits & maskBits) == 0)
+		{
+			return true;
+		}
+
+		if (count < capacity)
+		{
+			hits[count].fixture = proxy->fixture;
+			hits[count].index = index;
+		}
+		++count;
+		return true;
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2QueryHit* hits;
+	int32 count;
+	int32 capacity;
+	uint16 maskBits;
+};
+
+int32 b2World::QueryAABBs(const b2AABB* aabbs, int32 count, b2QueryHit* hits, int32 capacity, uint16 maskBits) const
+{
+	b2WorldQueryBatchWrapper wrapper;
+	wrapper.broadPhase = &m_contactManager.m_broadPhase;
+	wrapper.hits = hits;
+	wrapper.count = 0;
+	wrapper.capacity = capacity;
+	wrapper.maskBits = maskBits;
+	m_contactManager.m_broadPhase.QueryBatch(&wrapper, aabbs, count);
+	return wrapper.count;
+}
+
+// Keeps the closest hit of each ray by clipping the ray to every hit.
+struct b2WorldRayCastBatchWrapper
+{
+	float32 RayCastCallback(const b2RayCastInput& input, int32 proxyId, int32 index)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		b2Fixture* fixture = proxy->fixture;
+		if ((fixture->GetFilterData().categoryBits & maskBits) == 0)
+		{
+			return -1.0f;
+		}
+
+		b2RayCastOutput output;
+		bool hit = fixture->RayCast(&output, input, proxy->childIndex);
+		if (hit == false)
+		{
+			return -1.0f;
+		}
+
+		b2RayCastHit& result = hits[index];
+		result.fixture = fixture;
+		result.childIndex = proxy->childIndex;
+		result.point = (1.0f - output.fraction) * input.p1 + output.fraction * input.p2;
+		result.normal = output.normal;
+		result.fraction = output.fraction;
+
+		// A hit at the very start would terminate the ray, which keeps the hit either way.
+		return output.fraction;
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2RayCastHit* hits;
+	uint16 maskBits;
+};
+
+void b2World::RayCastClosest(const b2RayCastInput* inputs, b2RayCastHit* hits, int32 count, uint16 maskBits) const
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		hits[i].fixture = NULL;
+		hits[i].childIndex = 0;
+		hits[i].point = inputs[i].p1 + inputs[i].maxFraction * (inputs[i].p2 - inputs[i].p1);
+		hits[i].normal.SetZero();
+		hits[i].fraction = inputs[i].maxFraction;
+	}
+
+	b2WorldRayCastBatchWrapper wrapper;
+	wrapper.broadPhase = &m_contactManager.m_broadPhase;
+	wrapper.hits = hits;
+	wrapper.maskBits = maskBits;
+	m_contactManager.m_broadPhase.RayCastBatch(&wrapper, inputs, count);
+}
+
 void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color& color)
 {
 	switch (fixture->GetType())
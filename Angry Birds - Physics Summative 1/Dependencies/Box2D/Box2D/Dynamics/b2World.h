@@ -23,6 +23,8 @@
 #include <Box2D/Common/b2BlockAllocator.h>
 #include <Box2D/Common/b2StackAllocator.h>
 #include <Box2D/Dynamics/b2ContactManager.h>
+#include <Box2D/Dynamics/b2IslandManager.h>
+#include <Box2D/Dynamics/b2TOIQueue.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 
@@ -30,10 +32,33 @@ struct b2AABB;
 struct b2BodyDef;
 struct b2Color;
 struct b2JointDef;
+struct b2SharedBodies;
 class b2Body;
 class b2Draw;
 class b2Fixture;
+class b2Island;
 class b2Joint;
+class b2TaskScheduler;
+
+/// The closest fixture hit by one ray of b2World::RayCastClosest.
+struct b2RayCastHit
+{
+	/// The fixture hit, or NULL if the ray hit nothing.
+	b2Fixture* fixture;
+	int32 childIndex;
+	b2Vec2 point;
+	b2Vec2 normal;
+	float32 fraction;
+};
+
+/// A fixture found by b2World::QueryAABBs.
+struct b2QueryHit
+{
+	b2Fixture* fixture;
+
+	/// The index of the query AABB the fixture potentially overlaps.
+	int32 index;
+};
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -43,7 +68,9 @@ class b2World
 public:
 	/// Construct a world object.
 	/// @param gravity the world gravity vector.
-	b2World(const b2Vec2& gravity);
+	/// @param stackSize the initial size in bytes of the per step allocator of each thread.
+	/// It grows to what the simulation needs.
+	b2World(const b2Vec2& gravity, int32 stackSize = b2_stackSize);
 
 	/// Destruct the world. All physics entities are destroyed and all heap memory is released.
 	~b2World();
@@ -66,6 +93,15 @@ public:
 	/// by you and must remain in scope.
 	void SetDebugDraw(b2Draw* debugDraw);
 
+	/// Register a task scheduler to update contacts and solve islands on several threads.
+	/// The scheduler is owned by you and must remain in scope. Pass NULL to do all the work
+	/// on the calling thread. The result of a step is the same for any thread count.
+	/// @warning This function is locked during callbacks.
+	void SetTaskScheduler(b2TaskScheduler* scheduler);
+
+	/// Get the registered task scheduler, if any.
+	b2TaskScheduler* GetTaskScheduler() const { return m_taskScheduler; }
+
 	/// Create a rigid body given a definition. No reference to the definition
 	/// is retained.
 	/// @warning This function is locked during callbacks.
@@ -86,6 +122,12 @@ public:
 	/// @warning This function is locked during callbacks.
 	void DestroyJoint(b2Joint* joint);
 
+	/// Destroy all bodies, joints and contacts at once, for example to load another level.
+	/// Their memory is reset in bulk, so this doesn't take time for each object. Nothing
+	/// is reported to the destruction or contact listener.
+	/// @warning This function is locked during callbacks.
+	void Clear();
+
 	/// Take a time step. This performs collision detection, integration,
 	/// and constraint solution.
 	/// @param timeStep the amount of time to simulate, this should not vary.
@@ -121,6 +163,26 @@ public:
 	/// @param point2 the ray ending point
 	void RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const;
 
+	/// Query the world with a batch of AABBs for all fixtures that potentially overlap them.
+	/// The tree is traversed once for several AABBs at a time and no callback is made.
+	/// @param aabbs the query boxes.
+	/// @param count the number of query boxes.
+	/// @param hits receives a fixture and the index of the box for each overlap, in no particular order.
+	/// @param capacity the size of the hits array.
+	/// @param maskBits only fixtures with a category bit in the mask are reported.
+	/// @return the number of overlaps found. It can be more than capacity, then only capacity are written.
+	int32 QueryAABBs(const b2AABB* aabbs, int32 count, b2QueryHit* hits, int32 capacity, uint16 maskBits = 0xFFFF) const;
+
+	/// Ray-cast the world with a batch of rays for the closest fixture in the path of each.
+	/// The tree is traversed once for several rays at a time and no callback is made, so keep
+	/// rays that start close together and point the same way next to each other.
+	/// The ray-cast ignores shapes that contain the starting point.
+	/// @param inputs the rays. Each extends from p1 to p1 + maxFraction * (p2 - p1).
+	/// @param hits receives the closest hit of each ray, the fraction is along p2 - p1.
+	/// @param count the number of rays.
+	/// @param maskBits only fixtures with a category bit in the mask are hit.
+	void RayCastClosest(const b2RayCastInput* inputs, b2RayCastHit* hits, int32 count, uint16 maskBits = 0xFFFF) const;
+
 	/// Get the world body list. With the returned body, use b2Body::GetNext to get
 	/// the next body in the world list. A NULL body indicates the end of the list.
 	/// @return the head of the world body list.
@@ -149,10 +211,53 @@ public:
 	void SetWarmStarting(bool flag) { m_warmStarting = flag; }
 	bool GetWarmStarting() const { return m_warmStarting; }
 
+	/// Enable/disable the wide contact solver. It solves the contacts of large islands in SIMD
+	/// lanes, 8 at a time with AVX2 or 4 with SSE2, as detected at runtime.
+	void SetWideContactSolver(bool flag);
+	bool GetWideContactSolver() const { return m_wideContactLanes > 0; }
+
+	/// Force the lane count of the wide contact solver, 0 turns it off. The count is clamped to
+	/// what the CPU supports. Every lane count gives the same results. For testing.
+	void SetWideContactLanes(int32 lanes);
+	int32 GetWideContactLanes() const { return m_wideContactLanes; }
+
+	/// Enable/disable the wide layout of the broad-phase tree. Queries then test four children
+	/// per node visit with SIMD. The layout is rebuilt from the binary tree when the step looks
+	/// for new contacts. Queries made after a proxy moved and before the next step use the
+	/// binary tree.
+	void SetWideTreeLayout(bool flag) { m_contactManager.m_broadPhase.SetWideTreeLayout(flag); }
+	bool GetWideTreeLayout() const { return m_contactManager.m_broadPhase.GetWideTreeLayout(); }
+
 	/// Enable/disable continuous physics. For testing.
 	void SetContinuousPhysics(bool flag) { m_continuousPhysics = flag; }
 	bool GetContinuousPhysics() const { return m_continuousPhysics; }
 
+	/// Enable/disable speculative contacts. Contact points are kept for shapes that could
+	/// touch within the next step, and the regular contact solver only lets the bodies close
+	/// the gap, so fast bodies of any type do not tunnel and there is no time of impact phase.
+	/// Such a contact begins up to a step of motion before the shapes touch, and a bounce
+	/// starts from where the bodies are when the impact is seen.
+	void SetSpeculativeContacts(bool flag) { m_speculativeContacts = flag; }
+	bool GetSpeculativeContacts() const { return m_speculativeContacts; }
+
+	/// Set the number of sub-steps of the soft step solver, 0 uses velocity and position
+	/// iterations. Each sub-step integrates, solves contacts once with a soft push out and
+	/// relaxes once more, and the iteration counts passed to Step are ignored. Stacks settle
+	/// better than with the same cost in iterations. Contacts are speculative in this mode,
+	/// see SetSpeculativeContacts. The wide contact solver is not used.
+	/// Joint impulses are per sub-step, so pass the sub-step's inverse time step to
+	/// GetReactionForce and GetReactionTorque.
+	void SetSoftSubSteps(int32 count);
+	int32 GetSoftSubSteps() const { return m_softSubSteps; }
+
+	/// Enable/disable the direct solver of joint chains. Chains of revolute joints without
+	/// limits and rigid distance joints, such as ropes, have their velocity constraints solved
+	/// exactly in time linear in their length instead of one joint at a time, so they stretch
+	/// far less at low iteration counts. Position correction, motors and other joints keep
+	/// their own solvers.
+	void SetJointChainSolver(bool flag) { m_jointChains = flag; }
+	bool GetJointChainSolver() const { return m_jointChains; }
+
 	/// Enable/disable single stepped continuous physics. For testing.
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 	bool GetSubStepping() const { return m_subStepping; }
@@ -225,7 +330,11 @@ private:
 	friend class b2Controller;
 
 	void Solve(const b2TimeStep& step);
+	void SolveParallel(const b2TimeStep& step);
+	bool BuildIsland(b2PersistentIsland* source, b2Island* island, b2SharedBodies* shared);
+	void AddStaticBody(b2Body* body, b2Island* island, b2SharedBodies* shared);
 	void SolveTOI(const b2TimeStep& step);
+	void UpdateTOIEvent(b2Contact* contact);
 
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
@@ -233,9 +342,17 @@ private:
 	b2BlockAllocator m_blockAllocator;
 	b2StackAllocator m_stackAllocator;
 
+	// Stack allocators for task scheduler threads 1 to n - 1, thread 0 uses m_stackAllocator.
+	b2TaskScheduler* m_taskScheduler;
+	b2StackAllocator* m_threadAllocators;
+	int32 m_threadAllocatorCount;
+	int32 m_stackSize;
+
 	int32 m_flags;
 
 	b2ContactManager m_contactManager;
+	b2IslandManager m_islandManager;
+	b2TOIQueue m_toiQueue;
 
 	b2Body* m_bodyList;
 	b2Joint* m_jointList;
@@ -243,6 +360,9 @@ private:
 	int32 m_bodyCount;
 	int32 m_jointCount;
 
+	// Chain shapes allocate with b2Alloc, Clear has to free them one by one.
+	int32 m_chainFixtureCount;
+
 	b2Vec2 m_gravity;
 	bool m_allowSleep;
 
@@ -256,7 +376,11 @@ private:
 	// These are for debugging the solver.
 	bool m_warmStarting;
 	bool m_continuousPhysics;
+	bool m_speculativeContacts;
+	int32 m_softSubSteps;
+	bool m_jointChains;
 	bool m_subStepping;
+	int32 m_wideContactLanes;
 
 	bool m_stepComplete;
 
@@ -0,0 +1,693 @@
+/*
+* Copyright (c) 2006-2016 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Box2D.h>
+#include <Box2D/Common/b2WideFloat.h>
+
+#include <stdio.h>
+#include <string.h>
+
+// Regression checks of the optional modes of b2World. Each check steps a scene with a mode
+// enabled and compares the result with the default solver: modes that only change how the
+// work is scheduled must give bit identical results, modes that change the solver must stay
+// close to it or pass a physical check. The exit code is the number of failed checks.
+
+static const float32 k_timeStep = 1.0f / 60.0f;
+static const int32 k_velocityIterations = 8;
+static const int32 k_positionIterations = 3;
+
+static int32 s_failureCount = 0;
+
+static void Check(const char* name, bool passed)
+{
+	printf("%-44s %s\n", name, passed ? "ok" : "FAILED");
+	if (passed == false)
+	{
+		++s_failureCount;
+	}
+}
+
+static void CheckError(const char* name, float32 error, float32 tolerance)
+{
+	printf("%-44s %s  error %g, tolerance %g\n", name, error <= tolerance ? "ok" : "FAILED", error, tolerance);
+	if (error > tolerance)
+	{
+		++s_failureCount;
+	}
+}
+
+// Sums the post solve impulses, so the listener path of a mode is compared as well.
+class ImpulseListener : public b2ContactListener
+{
+public:
+	ImpulseListener() : m_sum(0.0f), m_count(0) {}
+
+	void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse)
+	{
+		B2_NOT_USED(contact);
+		for (int32 i = 0; i < impulse->count; ++i)
+		{
+			m_sum += impulse->normalImpulses[i] + impulse->tangentImpulses[i];
+		}
+		++m_count;
+	}
+
+	float64 m_sum;
+	int32 m_count;
+};
+
+static b2Body* CreateBox(b2World* world, b2BodyType type, const b2Vec2& position, float32 hx, float32 hy)
+{
+	b2BodyDef bd;
+	bd.type = type;
+	bd.position = position;
+	b2Body* body = world->CreateBody(&bd);
+
+	b2PolygonShape shape;
+	shape.SetAsBox(hx, hy);
+	body->CreateFixture(&shape, 1.0f);
+	return body;
+}
+
+static b2Body* CreateCircle(b2World* world, const b2Vec2& position, float32 radius)
+{
+	b2BodyDef bd;
+	bd.type = b2_dynamicBody;
+	bd.position = position;
+	b2Body* body = world->CreateBody(&bd);
+
+	b2CircleShape shape;
+	shape.m_radius = radius;
+	body->CreateFixture(&shape, 1.0f);
+	return body;
+}
+
+// Two pyramids on a ground box. They settle into a stable state, so the solver modes can be
+// compared by position.
+static void CreatePyramids(b2World* world)
+{
+	CreateBox(world, b2_staticBody, b2Vec2(0.0f, -1.0f), 40.0f, 1.0f);
+
+	const float32 x[2] = { -10.0f, 10.0f };
+	const int32 rowCounts[2] = { 12, 8 };
+	for (int32 p = 0; p < 2; ++p)
+	{
+		for (int32 row = 0; row < rowCounts[p]; ++row)
+		{
+			int32 count = rowCounts[p] - row;
+			for (int32 i = 0; i < count; ++i)
+			{
+				b2Vec2 position(x[p] + 1.0f * i - 0.5f * count + 0.5f, 0.5f + 1.0f * row);
+				CreateBox(world, b2_dynamicBody, position, 0.5f, 0.5f);
+			}
+		}
+	}
+}
+
+// A rope of revolute joints hanging from a static anchor, with a heavy weight at its end. It
+// starts at the given angle from the vertical. The joints' own solvers let it stretch at the
+// default iteration counts.
+static void CreateRope(b2World* world, float32 angle)
+{
+	const b2Vec2 anchor(25.0f, 30.0f);
+	const b2Rot q(angle);
+	b2Body* previous = CreateBox(world, b2_staticBody, anchor, 0.5f, 0.5f);
+
+	const int32 linkCount = 30;
+	for (int32 i = 0; i < linkCount; ++i)
+	{
+		b2Body* link = CreateBox(world, b2_dynamicBody, anchor, 0.06f, 0.25f);
+		link->SetTransform(anchor + b2Mul(q, b2Vec2(0.0f, -0.75f - 0.5f * i)), angle);
+		if (i == linkCount - 1)
+		{
+			link->GetFixtureList()->SetDensity(50.0f);
+			link->ResetMassData();
+		}
+
+		b2RevoluteJointDef jd;
+		jd.Initialize(previous, link, anchor + b2Mul(q, b2Vec2(0.0f, -0.5f - 0.5f * i)));
+		world->CreateJoint(&jd);
+		previous = link;
+	}
+}
+
+// Boxes and circles dropped onto a ground box, an edge ramp and a chain bowl, in several
+// piles. Every pair of shape types that can collide touches, and the piles form islands that
+// share the static bodies.
+static void CreateCollisionScene(b2World* world)
+{
+	CreateBox(world, b2_staticBody, b2Vec2(0.0f, -1.0f), 40.0f, 1.0f);
+
+	b2BodyDef bd;
+	b2Body* ramp = world->CreateBody(&bd);
+	b2EdgeShape edge;
+	edge.Set(b2Vec2(-20.0f, 8.0f), b2Vec2(-8.0f, 4.0f));
+	ramp->CreateFixture(&edge, 0.0f);
+
+	b2Body* bowl = world->CreateBody(&bd);
+	b2Vec2 vertices[5] = { b2Vec2(8.0f, 10.0f), b2Vec2(10.0f, 5.0f), b2Vec2(14.0f, 4.0f), b2Vec2(18.0f, 5.0f), b2Vec2(20.0f, 10.0f) };
+	b2ChainShape chain;
+	chain.CreateChain(vertices, 5);
+	bowl->CreateFixture(&chain, 0.0f);
+
+	const float32 x[3] = { -14.0f, 0.0f, 14.0f };
+	for (int32 p = 0; p < 3; ++p)
+	{
+		for (int32 i = 0; i < 20; ++i)
+		{
+			b2Vec2 position(x[p] + 0.7f * (i % 4) - 1.0f, 9.0f + 1.2f * (i / 4) + 0.1f * (i % 3));
+			if (i % 3 == 0)
+			{
+				CreateCircle(world, position, 0.4f);
+			}
+			else
+			{
+				CreateBox(world, b2_dynamicBody, position, 0.3f + 0.05f * (i % 2), 0.3f)->SetTransform(position, 0.2f * i);
+			}
+		}
+	}
+}
+
+static void Run(b2World* world, int32 stepCount, int32 velocityIterations = k_velocityIterations, int32 positionIterations = k_positionIterations)
+{
+	for (int32 i = 0; i < stepCount; ++i)
+	{
+		world->Step(k_timeStep, velocityIterations, positionIterations);
+	}
+}
+
+// Whether two worlds that were built the same way have bit identical body states. A parallel
+// solve only reads static bodies, so their awake flag isn't compared.
+static bool SameState(const b2World* a, const b2World* b)
+{
+	if (a->GetBodyCount() != b->GetBodyCount())
+	{
+		return false;
+	}
+
+	for (const b2Body* ba = a->GetBodyList(), *bb = b->GetBodyList(); ba; ba = ba->GetNext(), bb = bb->GetNext())
+	{
+		b2Vec2 pa = ba->GetPosition(), pb = bb->GetPosition();
+		b2Vec2 va = ba->GetLinearVelocity(), vb = bb->GetLinearVelocity();
+		float32 stateA[6] = { pa.x, pa.y, ba->GetAngle(), va.x, va.y, ba->GetAngularVelocity() };
+		float32 stateB[6] = { pb.x, pb.y, bb->GetAngle(), vb.x, vb.y, bb->GetAngularVelocity() };
+		if (memcmp(stateA, stateB, sizeof(stateA)) != 0 ||
+			(ba->GetType() != b2_staticBody && ba->IsAwake() != bb->IsAwake()))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// The largest distance between the positions of the same body in two worlds.
+static float32 MaxPositionError(const b2World* a, const b2World* b)
+{
+	float32 error = 0.0f;
+	for (const b2Body* ba = a->GetBodyList(), *bb = b->GetBodyList(); ba && bb; ba = ba->GetNext(), bb = bb->GetNext())
+	{
+		error = b2Max(error, b2Distance(ba->GetPosition(), bb->GetPosition()));
+	}
+	return error;
+}
+
+// The largest distance between the two anchors of a joint.
+static float32 MaxJointError(const b2World* world)
+{
+	float32 error = 0.0f;
+	for (const b2Joint* j = world->GetJointList(); j; j = j->GetNext())
+	{
+		error = b2Max(error, b2Distance(j->GetAnchorA(), j->GetAnchorB()));
+	}
+	return error;
+}
+
+static bool AllAsleep(const b2World* world)
+{
+	for (const b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		if (b->GetType() == b2_dynamicBody && b->IsAwake())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Islands solved on the task scheduler and contacts updated on it must give the same result
+// as the serial step, post solve reports included.
+static void TestTaskScheduler()
+{
+	b2ThreadPool pool(4);
+	const char* names[2] = { "task scheduler, pyramids and rope", "task scheduler, collision" };
+	for (int32 scene = 0; scene < 2; ++scene)
+	{
+		b2World serial(b2Vec2(0.0f, -10.0f));
+		b2World parallel(b2Vec2(0.0f, -10.0f));
+		ImpulseListener serialListener, parallelListener;
+		serial.SetContactListener(&serialListener);
+		parallel.SetContactListener(&parallelListener);
+		parallel.SetTaskScheduler(&pool);
+
+		if (scene == 0)
+		{
+			CreatePyramids(&serial);
+			CreateRope(&serial, 0.5f * b2_pi);
+			CreatePyramids(&parallel);
+			CreateRope(&parallel, 0.5f * b2_pi);
+		}
+		else
+		{
+			CreateCollisionScene(&serial);
+			CreateCollisionScene(&parallel);
+		}
+
+		Run(&serial, 300);
+		Run(&parallel, 300);
+		Check(names[scene], SameState(&serial, &parallel) &&
+			serialListener.m_sum == parallelListener.m_sum && serialListener.m_count == parallelListener.m_count);
+	}
+}
+
+// Every lane count of the wide contact solver gives the same result, and the result stays
+// close to the scalar solver's.
+static void TestWideContactSolver(const b2World* reference)
+{
+	b2World lanes1(b2Vec2(0.0f, -10.0f));
+	CreatePyramids(&lanes1);
+	lanes1.SetWideContactLanes(1);
+	Run(&lanes1, 300);
+
+	b2World wide(b2Vec2(0.0f, -10.0f));
+	CreatePyramids(&wide);
+	wide.SetWideContactSolver(true);
+	Run(&wide, 300);
+
+	printf("wide contact solver runs %d lanes\n", wide.GetWideContactLanes());
+	Check("wide contact solver, lane counts agree", SameState(&lanes1, &wide));
+	CheckError("wide contact solver, positions", MaxPositionError(reference, &wide), 0.05f);
+	Check("wide contact solver, pyramids asleep", AllAsleep(&wide));
+}
+
+// The island integrates bodies four at a time. The lane types must agree bit for bit with
+// the one lane type, which runs the scalar expressions.
+static void TestWideLanes()
+{
+#if B2_WIDE_SSE2
+	float32 v[8], a[8], d[8];
+	for (int32 i = 0; i < 8; ++i)
+	{
+		v[i] = -3.7f + 1.3f * i;
+		a[i] = 10.0f / (1.0f + i);
+		d[i] = 0.1f * i;
+	}
+
+	bool same = true;
+	const float32 h = k_timeStep;
+	for (int32 i = 0; i < 8; i += 4)
+	{
+		b2FloatW4 hW = b2FloatW4::Splat(h);
+		b2FloatW4 one = b2FloatW4::Splat(1.0f);
+		b2FloatW4 vW = (b2FloatW4::Load(v + i) + hW * b2FloatW4::Load(a + i)) * (one / (one + hW * b2FloatW4::Load(d + i)));
+		b2FloatW4 limited = b2SelectW(b2GreaterW(vW * vW, one), vW / b2SqrtW(vW * vW), b2MaxW(vW, -vW));
+		float32 wide[4], wideLimited[4];
+		b2StoreW(vW, wide);
+		b2StoreW(limited, wideLimited);
+
+		for (int32 l = 0; l < 4; ++l)
+		{
+			b2FloatW1 h1 = b2FloatW1::Splat(h);
+			b2FloatW1 one1 = b2FloatW1::Splat(1.0f);
+			b2FloatW1 v1 = (b2FloatW1::Load(v + i + l) + h1 * b2FloatW1::Load(a + i + l)) * (one1 / (one1 + h1 * b2FloatW1::Load(d + i + l)));
+			b2FloatW1 limited1 = b2SelectW(b2GreaterW(v1 * v1, one1), v1 / b2SqrtW(v1 * v1), b2MaxW(v1, -v1));
+			same = same && memcmp(&v1.v, wide + l, sizeof(float32)) == 0 && memcmp(&limited1.v, wideLimited + l, sizeof(float32)) == 0;
+		}
+	}
+	Check("wide lanes match one lane", same);
+#else
+	printf("%-44s skipped, no SSE2\n", "wide lanes match one lane");
+#endif
+}
+
+// Disables the contacts between one body and the other dynamic bodies, like a one sided
+// platform would.
+class DisableListener : public b2ContactListener
+{
+public:
+	DisableListener() : m_body(NULL) {}
+
+	void PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
+	{
+		B2_NOT_USED(oldManifold);
+		b2Body* bodyA = contact->GetFixtureA()->GetBody();
+		b2Body* bodyB = contact->GetFixtureB()->GetBody();
+		if ((bodyA == m_body || bodyB == m_body) &&
+			bodyA->GetType() == b2_dynamicBody && bodyB->GetType() == b2_dynamicBody)
+		{
+			contact->SetEnabled(false);
+		}
+	}
+
+	b2Body* m_body;
+};
+
+// Islands are kept between steps. A contact disabled in PreSolve must not join its bodies'
+// islands, and destroying a body must wake the bodies it held up and no others.
+static void TestPersistentIslands()
+{
+	{
+		b2World world(b2Vec2(0.0f, -10.0f));
+		DisableListener listener;
+		world.SetContactListener(&listener);
+		CreateBox(&world, b2_staticBody, b2Vec2(0.0f, -1.0f), 20.0f, 1.0f);
+		b2Body* lower = CreateBox(&world, b2_dynamicBody, b2Vec2(0.0f, 1.0f), 1.0f, 1.0f);
+		b2Body* upper = CreateBox(&world, b2_dynamicBody, b2Vec2(0.0f, 3.1f), 1.0f, 1.0f);
+		listener.m_body = upper;
+
+		// The upper box falls through the lower one while that one comes to rest.
+		bool sleptAlone = false;
+		for (int32 i = 0; i < 300; ++i)
+		{
+			Run(&world, 1);
+			sleptAlone = sleptAlone || (lower->IsAwake() == false && upper->IsAwake());
+		}
+		Check("persistent islands, disabled contact apart", sleptAlone);
+	}
+
+	{
+		b2World world(b2Vec2(0.0f, -10.0f));
+		CreateBox(&world, b2_staticBody, b2Vec2(0.0f, -1.0f), 20.0f, 1.0f);
+		b2Body* stacks[2][5];
+		for (int32 s = 0; s < 2; ++s)
+		{
+			for (int32 i = 0; i < 5; ++i)
+			{
+				stacks[s][i] = CreateBox(&world, b2_dynamicBody, b2Vec2(-5.0f + 10.0f * s, 0.5f + 1.0f * i), 0.5f, 0.5f);
+			}
+		}
+		Run(&world, 300);
+		bool asleep = AllAsleep(&world);
+
+		// Pull the bottom box out of the first stack.
+		world.DestroyBody(stacks[0][0]);
+		Run(&world, 1);
+		bool woken = stacks[0][4]->IsAwake() && stacks[1][0]->IsAwake() == false && stacks[1][4]->IsAwake() == false;
+
+		Run(&world, 300);
+		bool fell = AllAsleep(&world) && stacks[0][4]->GetPosition().y < 4.0f && stacks[1][4]->GetPosition().y > 4.0f;
+		Check("persistent islands, removal wakes a stack", asleep && woken && fell);
+	}
+}
+
+// A bullet fired at a thin static wall must not pass it.
+static bool BulletStopped(bool continuous, bool speculative, int32 softSubSteps)
+{
+	b2World world(b2Vec2_zero);
+	world.SetContinuousPhysics(continuous);
+	world.SetSpeculativeContacts(speculative);
+	world.SetSoftSubSteps(softSubSteps);
+	CreateBox(&world, b2_staticBody, b2Vec2(10.0f, 0.0f), 0.05f, 2.0f);
+
+	b2Body* bullet = CreateCircle(&world, b2Vec2_zero, 0.1f);
+	bullet->SetBullet(true);
+	bullet->SetLinearVelocity(b2Vec2(300.0f, 0.0f));
+
+	Run(&world, 60);
+	return bullet->GetPosition().x < 10.0f;
+}
+
+// An inelastic circle dropped fast onto a static box must land on the box, which keeps it
+// about b2_polygonRadius away. Returns the gap between them in the first step its fall is
+// stopped.
+static float32 LandingGap(bool speculative, int32 softSubSteps)
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	world.SetSpeculativeContacts(speculative);
+	world.SetSoftSubSteps(softSubSteps);
+	CreateBox(&world, b2_staticBody, b2Vec2(0.0f, -1.0f), 5.0f, 1.0f);
+
+	const float32 radius = 0.25f;
+	b2Body* body = CreateCircle(&world, b2Vec2(0.0f, 5.0f), radius);
+	body->GetFixtureList()->SetRestitution(0.0f);
+	body->SetLinearVelocity(b2Vec2(0.0f, -20.0f));
+
+	for (int32 i = 0; i < 60; ++i)
+	{
+		Run(&world, 1);
+		if (body->GetLinearVelocity().y > -1.0f)
+		{
+			return body->GetPosition().y - radius;
+		}
+	}
+	return b2_maxFloat;
+}
+
+static void TestContinuous()
+{
+	Check("time of impact, bullet stopped", BulletStopped(true, false, 0));
+	CheckError("time of impact, landing gap", LandingGap(false, 0), b2_polygonRadius + b2_linearSlop);
+	Check("no continuous physics, bullet passes", BulletStopped(false, false, 0) == false);
+}
+
+static void TestSpeculativeContacts(const b2World* reference)
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	world.SetSpeculativeContacts(true);
+	CreatePyramids(&world);
+	Run(&world, 300);
+
+	CheckError("speculative contacts, positions", MaxPositionError(reference, &world), 0.05f);
+	Check("speculative contacts, bullet stopped", BulletStopped(true, true, 0));
+	CheckError("speculative contacts, landing gap", LandingGap(true, 0), b2_polygonRadius + b2_linearSlop);
+}
+
+// Whether the pyramids and a swinging rope stepped on the task scheduler match the serial
+// step. The pyramids' islands share the ground, so each island maps it to its own slot.
+static bool SameOnTaskScheduler(int32 softSubSteps, bool jointChains)
+{
+	b2ThreadPool pool(4);
+	b2World serial(b2Vec2(0.0f, -10.0f));
+	b2World parallel(b2Vec2(0.0f, -10.0f));
+	b2World* worlds[2] = { &serial, &parallel };
+	for (int32 i = 0; i < 2; ++i)
+	{
+		worlds[i]->SetSoftSubSteps(softSubSteps);
+		worlds[i]->SetJointChainSolver(jointChains);
+		CreatePyramids(worlds[i]);
+		CreateRope(worlds[i], 0.5f * b2_pi);
+	}
+	parallel.SetTaskScheduler(&pool);
+
+	Run(&serial, 300);
+	Run(&parallel, 300);
+	return SameState(&serial, &parallel);
+}
+
+static void TestSoftSubSteps(const b2World* reference)
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	world.SetSoftSubSteps(4);
+	CreatePyramids(&world);
+	Run(&world, 300);
+
+	CheckError("soft sub-steps, positions", MaxPositionError(reference, &world), 0.05f);
+	Check("soft sub-steps, bullet stopped", BulletStopped(true, false, 4));
+	CheckError("soft sub-steps, landing gap", LandingGap(false, 4), b2_polygonRadius + b2_linearSlop);
+	Check("soft sub-steps, task scheduler", SameOnTaskScheduler(4, false));
+}
+
+// The chain solver must hold a swinging rope together far better than the joints' own
+// solvers, which open up by more than 2 m, and a hanging rope must come to rest close to
+// where they converge with many iterations.
+static void TestJointChains()
+{
+	b2World reference(b2Vec2(0.0f, -10.0f));
+	b2World world(b2Vec2(0.0f, -10.0f));
+	world.SetJointChainSolver(true);
+	CreateRope(&reference, 0.5f * b2_pi);
+	CreateRope(&world, 0.5f * b2_pi);
+
+	float32 referenceError = 0.0f;
+	float32 chainError = 0.0f;
+	for (int32 i = 0; i < 300; ++i)
+	{
+		Run(&reference, 1);
+		Run(&world, 1);
+		referenceError = b2Max(referenceError, MaxJointError(&reference));
+		chainError = b2Max(chainError, MaxJointError(&world));
+	}
+	printf("joint solvers alone, swinging joint error %g\n", referenceError);
+	CheckError("joint chains, swinging joint error", chainError, 0.15f);
+
+	b2World converged(b2Vec2(0.0f, -10.0f));
+	b2World hanging(b2Vec2(0.0f, -10.0f));
+	hanging.SetJointChainSolver(true);
+	CreateRope(&converged, 0.0f);
+	CreateRope(&hanging, 0.0f);
+	Run(&converged, 300, 200, 50);
+	Run(&hanging, 300);
+	CheckError("joint chains, hanging positions", MaxPositionError(&converged, &hanging), 0.05f);
+
+	Check("joint chains, task scheduler", SameOnTaskScheduler(0, true));
+	Check("joint chains, soft sub-steps, task scheduler", SameOnTaskScheduler(4, true));
+}
+
+// Compares the manifold of every contact about to be solved with the one the collision
+// function for its shapes gives.
+class DispatchListener : public b2ContactListener
+{
+public:
+	DispatchListener() : m_mismatchCount(0)
+	{
+		memset(m_counts, 0, sizeof(m_counts));
+	}
+
+	void PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
+	{
+		B2_NOT_USED(oldManifold);
+
+		b2Fixture* fixtureA = contact->GetFixtureA();
+		b2Fixture* fixtureB = contact->GetFixtureB();
+		b2Shape* shapeA = fixtureA->GetShape();
+		b2Shape* shapeB = fixtureB->GetShape();
+		const b2Transform& xfA = fixtureA->GetBody()->GetTransform();
+		const b2Transform& xfB = fixtureB->GetBody()->GetTransform();
+		b2Shape::Type typeA = shapeA->GetType();
+		b2Shape::Type typeB = shapeB->GetType();
+
+		b2EdgeShape edge;
+		const b2EdgeShape* edgeA = NULL;
+		if (typeA == b2Shape::e_edge)
+		{
+			edgeA = (b2EdgeShape*)shapeA;
+		}
+		else if (typeA == b2Shape::e_chain)
+		{
+			((b2ChainShape*)shapeA)->GetChildEdge(&edge, contact->GetChildIndexA());
+			edgeA = &edge;
+		}
+
+		b2Manifold manifold;
+		manifold.pointCount = -1;
+		if (typeA == b2Shape::e_circle && typeB == b2Shape::e_circle)
+		{
+			b2CollideCircles(&manifold, (b2CircleShape*)shapeA, xfA, (b2CircleShape*)shapeB, xfB);
+		}
+		else if (typeA == b2Shape::e_polygon && typeB == b2Shape::e_circle)
+		{
+			b2CollidePolygonAndCircle(&manifold, (b2PolygonShape*)shapeA, xfA, (b2CircleShape*)shapeB, xfB);
+		}
+		else if (typeA == b2Shape::e_polygon && typeB == b2Shape::e_polygon)
+		{
+			b2CollidePolygons(&manifold, (b2PolygonShape*)shapeA, xfA, (b2PolygonShape*)shapeB, xfB);
+		}
+		else if ((typeA == b2Shape::e_edge || typeA == b2Shape::e_chain) && typeB == b2Shape::e_circle)
+		{
+			b2CollideEdgeAndCircle(&manifold, edgeA, xfA, (b2CircleShape*)shapeB, xfB);
+		}
+		else if ((typeA == b2Shape::e_edge || typeA == b2Shape::e_chain) && typeB == b2Shape::e_polygon)
+		{
+			b2CollideEdgeAndPolygon(&manifold, edgeA, xfA, (b2PolygonShape*)shapeB, xfB);
+		}
+
+		++m_counts[typeA][typeB];
+		if (SameManifold(contact->GetManifold(), &manifold) == false)
+		{
+			++m_mismatchCount;
+		}
+	}
+
+	static bool SameManifold(const b2Manifold* a, const b2Manifold* b)
+	{
+		if (a->pointCount != b->pointCount || a->type != b->type ||
+			a->localNormal != b->localNormal || a->localPoint != b->localPoint)
+		{
+			return false;
+		}
+
+		for (int32 i = 0; i < a->pointCount; ++i)
+		{
+			if (a->points[i].localPoint != b->points[i].localPoint || a->points[i].id.key != b->points[i].id.key)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	int32 m_counts[b2Shape::e_typeCount][b2Shape::e_typeCount];
+	int32 m_mismatchCount;
+};
+
+// The contact of each shape pair must compute the same manifold as calling the collision
+// function of the shape types directly.
+static void TestContactDispatch()
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	DispatchListener listener;
+	world.SetContactListener(&listener);
+	CreateCollisionScene(&world);
+	Run(&world, 300);
+
+	const b2Shape::Type pairs[7][2] =
+	{
+		{ b2Shape::e_circle, b2Shape::e_circle },
+		{ b2Shape::e_polygon, b2Shape::e_circle },
+		{ b2Shape::e_polygon, b2Shape::e_polygon },
+		{ b2Shape::e_edge, b2Shape::e_circle },
+		{ b2Shape::e_edge, b2Shape::e_polygon },
+		{ b2Shape::e_chain, b2Shape::e_circle },
+		{ b2Shape::e_chain, b2Shape::e_polygon }
+	};
+
+	bool covered = true;
+	for (int32 i = 0; i < 7; ++i)
+	{
+		int32 count = listener.m_counts[pairs[i][0]][pairs[i][1]];
+		printf("shape types %d and %d: %d manifolds\n", pairs[i][0], pairs[i][1], count);
+		covered = covered && count > 0;
+	}
+
+	Check("contact dispatch, every shape pair seen", covered);
+	Check("contact dispatch, manifolds match", listener.m_mismatchCount == 0);
+}
+
+int main(int argc, char** argv)
+{
+	B2_NOT_USED(argc);
+	B2_NOT_USED(argv);
+
+	// The default serial solver that the solver modes are compared with.
+	b2World reference(b2Vec2(0.0f, -10.0f));
+	CreatePyramids(&reference);
+	Run(&reference, 300);
+	Check("reference, pyramids asleep", AllAsleep(&reference));
+
+	TestTaskScheduler();
+	TestWideContactSolver(&reference);
+	TestWideLanes();
+	TestPersistentIslands();
+	TestContinuous();
+	TestSpeculativeContacts(&reference);
+	TestSoftSubSteps(&reference);
+	TestJointChains();
+	TestContactDispatch();
+
+	printf("%d failed\n", s_failureCount);
+	return s_failureCount;
+}
@@ -381,6 +381,8 @@ static void sInterface()
 		ImGui::SliderInt("##Vel Iters", &settings.velocityIterations, 0, 50);
 		ImGui::Text("Pos Iters");
 		ImGui::SliderInt("##Pos Iters", &settings.positionIterations, 0, 50);
+		ImGui::Text("Soft Sub-Steps");
+		ImGui::SliderInt("##Soft Sub-Steps", &settings.softSubSteps, 0, 16);
 		ImGui::Text("Hertz");
 		ImGui::SliderFloat("##Hertz", &settings.hz, 5.0f, 120.0f, "%.0f hz");
 		ImGui::PopItemWidth();
@@ -389,6 +391,7 @@ static void sInterface()
 		ImGui::Checkbox("Warm Starting", &settings.enableWarmStarting);
 		ImGui::Checkbox("Time of Impact", &settings.enableContinuous);
 		ImGui::Checkbox("Sub-Stepping", &settings.enableSubStepping);
+		ImGui::Checkbox("Joint Chains", &settings.enableJointChains);
 
 		ImGui::Separator();
 
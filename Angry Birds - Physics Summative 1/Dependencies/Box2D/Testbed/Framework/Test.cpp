@@ -294,6 +294,8 @@ void Test::Step(Settings* settings)
 	m_world->SetWarmStarting(settings->enableWarmStarting);
 	m_world->SetContinuousPhysics(settings->enableContinuous);
 	m_world->SetSubStepping(settings->enableSubStepping);
+	m_world->SetSoftSubSteps(settings->softSubSteps);
+	m_world->SetJointChainSolver(settings->enableJointChains);
 
 	m_pointCount = 0;
 
@@ -380,6 +382,8 @@ void Test::Step(Settings* settings)
 		m_textLine += DRAW_STRING_NEW_LINE;
 		g_debugDraw.DrawString(5, m_textLine, "broad-phase [ave] (max) = %5.2f [%6.2f] (%6.2f)", p.broadphase, aveProfile.broadphase, m_maxProfile.broadphase);
 		m_textLine += DRAW_STRING_NEW_LINE;
+		g_debugDraw.DrawString(5, m_textLine, "stack spills/bytes/capacity = %d/%d/%d", p.stackSpillCount, p.stackSpillSize, p.stackCapacity);
+		m_textLine += DRAW_STRING_NEW_LINE;
 	}
 
 	if (m_mouseJoint)
@@ -65,6 +65,7 @@ struct Settings
 		hz = 60.0f;
 		velocityIterations = 8;
 		positionIterations = 3;
+		softSubSteps = 0;
 		drawShapes = true;
 		drawJoints = true;
 		drawAABBs = false;
@@ -78,6 +79,7 @@ struct Settings
 		enableWarmStarting = true;
 		enableContinuous = true;
 		enableSubStepping = false;
+		enableJointChains = false;
 		enableSleep = true;
 		pause = false;
 		singleStep = false;
@@ -86,6 +88,7 @@ struct Settings
 	float32 hz;
 	int32 velocityIterations;
 	int32 positionIterations;
+	int32 softSubSteps;
 	bool drawShapes;
 	bool drawJoints;
 	bool drawAABBs;
@@ -99,6 +102,7 @@ struct Settings
 	bool enableWarmStarting;
 	bool enableContinuous;
 	bool enableSubStepping;
+	bool enableJointChains;
 	bool enableSleep;
 	bool pause;
 	bool singleStep;
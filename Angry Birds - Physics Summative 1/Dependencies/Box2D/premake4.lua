@@ -47,6 +47,14 @@ solution "Box2D"
 		includedirs { "." }
 		links { "Box2D" }
 
+	project "Regression"
+		kind "ConsoleApp"
+		language "C++"
+		files { "Regression/Regression.cpp" }
+		vpaths { [""] = "Regression" }
+		includedirs { "." }
+		links { "Box2D" }
+
 	project "Testbed"
 		kind "ConsoleApp"
 		language "C++"
@@ -15,7 +15,7 @@ public:
 	Background(char* filePath);
 	~Background();
 
-	virtual void LoadShape();
+	virtual void Render();
 
 private:
 
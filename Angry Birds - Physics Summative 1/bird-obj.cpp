@@ -13,6 +13,7 @@
 */
 BirdObj::BirdObj(float posX, float posY, float width, float height, b2World* world, char* filePath, BirdType type) :
 	GameObject(posX, posY, width, height, filePath),
+	m_timeSinceLaunch(0.0f),
 	m_isAlive(true),
 	m_isLaunched(false),
 	m_isAbilityUsed(false),
@@ -39,7 +40,7 @@ BirdObj::~BirdObj()
 
 /*
 *	Update - updates the position, check whether the bird should be dead or not
-*	Parameters - current time of the program
+*	Parameters - time since the last update
 *	Return - void
 */
 void BirdObj::Update(float time)
@@ -48,47 +49,24 @@ void BirdObj::Update(float time)
 
 	// if the bird has been launched, and has lived for 6 seconds, kill it
 	if (m_isLaunched)
-		if ((float)glfwGetTime() - m_launchTime >= ALIVETIME)
+	{
+		// Count game time rather than reading the clock, so the headless build can run faster than real time
+		m_timeSinceLaunch += time;
+		if (m_timeSinceLaunch >= ALIVETIME)
 		{
 			m_isAlive = false;
 		}
+	}
 }
 
 /*
-*	Render - draws the sprite with the correct scale, rotation and position
+*	Render - queues the sprite at the interpolated transform of the physics body
 *	Parameters - none
 *	Return - void
 */
 void BirdObj::Render()
 {
-	// bind the program
-	m_program->Use();
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	// bind the texture and set the "tex" uniform in the fragment shader
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
-	m_program->setUniform("tex", 0);
-	m_program->setUniform("model",
-		glm::scale(glm::mat4(), glm::vec3(((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH), 1.0f, 1.0f)) *
-		glm::translate(glm::mat4(), glm::vec3(m_position.x * METERSTOUNITS, m_position.y * METERSTOUNITS, 0.0f)) *
-		glm::rotate(glm::mat4(), m_body->GetAngle(), glm::vec3(0, 0, 1)));
-
-	// bind the texture and set the "tex" uniform in the fragment shader
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
-
-	// bind the VAO and draw
-	glBindVertexArray(m_vao);
-	glDrawArrays(GL_TRIANGLES, 0, 6 * 2 * 3);
-
-	// unbind the VAO, the program and the texture
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	glDisable(GL_BLEND);
-	m_program->StopUsing();
+	QueueSprite();
 }
 
 /*
@@ -129,7 +107,7 @@ void BirdObj::CopyVariables(const BirdObj& other)
 {
 	// copies several variables to another bird, used for splitter birds
 	this->m_isAlive = other.m_isAlive;
-	this->m_launchTime = other.m_launchTime;
+	this->m_timeSinceLaunch = other.m_timeSinceLaunch;
 	this->m_isLaunched = other.m_isLaunched;
 }
 
@@ -212,7 +190,7 @@ void BirdObj::Launch()
 {
 	// start the alive timer
 	m_isLaunched = true;
-	m_launchTime = (float)glfwGetTime();
+	m_timeSinceLaunch = 0.0f;
 }
 
 /*
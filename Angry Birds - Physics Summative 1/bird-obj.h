@@ -32,7 +32,7 @@ public:
 	void Ability();
 	void CopyVariables(const BirdObj& other);
 
-	b2Body* GetBody();
+	virtual b2Body* GetBody();
 	b2Vec2 Position();
 	BirdType GetBirdType();
 
@@ -43,7 +43,7 @@ public:
 
 private:
 
-	float m_launchTime;
+	float m_timeSinceLaunch;
 	bool m_isLaunched;
 	bool m_isAlive;
 	bool m_isAbilityUsed;
@@ -4,7 +4,7 @@
 #include "construct.h"
 
 // Local includes
-#include "hud.h"
+#include "gamescene.h"
 
 /*
 *	Construct Constructor - sets variables depending on type, creates the physics body, and loads shape and sprite
@@ -13,7 +13,8 @@
 */
 Construct::Construct(float posX, float posY, b2World* world, ConstructType type, float angle) :
 	m_constructType(type),
-	m_isAlive(true)
+	m_isAlive(true),
+	m_isDamaged(false)
 {
 	m_position = b2Vec2(posX, posY);
 
@@ -59,8 +60,6 @@ Construct::Construct(float posX, float posY, b2World* world, ConstructType type,
 	default: break;
 	}
 	
-	// Load the shape
-	LoadShape();
 	CreatePhysicsBody(world, angle);
 	m_currentHealth = m_health;
 
@@ -149,45 +148,18 @@ void Construct::Update(float time)
 	if (m_currentHealth <= 0)
 	{
 		m_isAlive = false;
-		HUD::GetInstance().AddScoreText(10);
+		GameScene::GetInstance().AddScore(10);
 	}
 }
 
 /*
-*	Render - draws the sprite with the correct scale, rotation and position
+*	Render - queues the sprite at the interpolated transform of the physics body
 *	Parameters - none
 *	Return - void
 */
 void Construct::Render()
 {
-	// bind the program
-	m_program->Use();
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	// bind the texture and set the "tex" uniform in the fragment shader
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
-	m_program->setUniform("tex", 0);
-	m_program->setUniform("model",
-		glm::scale(glm::mat4(), glm::vec3(((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH), 1.0f, 1.0f)) *
-		glm::translate(glm::mat4(), glm::vec3(m_position.x * METERSTOUNITS, m_position.y * METERSTOUNITS, 0.0f)) *
-		glm::rotate(glm::mat4(), m_body->GetAngle(), glm::vec3(0, 0, 1)));
-
-	// bind the texture and set the "tex" uniform in the fragment shader
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
-
-	// bind the VAO and draw
-	glBindVertexArray(m_vao);
-	glDrawArrays(GL_TRIANGLES, 0, 6 * 2 * 3);
-
-	// unbind the VAO, the program and the texture
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	glDisable(GL_BLEND);
-	m_program->StopUsing();
+	QueueSprite();
 }
 
 /*
@@ -223,10 +195,11 @@ void Construct::TakeDamage(int damage, ConstructType type)
 {
 	// subract the damage taken from the total health
 	m_currentHealth -= abs(damage);
-	if (m_currentHealth <= m_health / 2)
+	if (m_currentHealth <= m_health / 2 && !m_isDamaged)
 	{
-		// Change the sprite if the object is below half health
+		// Change the sprite once when the object drops below half health
 		ChangeSprite(type);
+		m_isDamaged = true;
 	}
 }
 
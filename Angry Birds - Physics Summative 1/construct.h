@@ -29,7 +29,7 @@ public:
 	void ChangeSprite(ConstructType type);
 	bool IsAlive();
 	ConstructType GetConstructType();
-	b2Body* GetBody();
+	virtual b2Body* GetBody();
 
 private:
 
@@ -38,6 +38,7 @@ private:
 	int m_health;
 	int m_currentHealth;
 	bool m_isAlive;
+	bool m_isDamaged;
 
 };
 
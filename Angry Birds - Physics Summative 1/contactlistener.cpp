@@ -1,5 +1,4 @@
 
-
 // This include
 #include "contactlistener.h"
 
@@ -7,16 +6,64 @@
 #include "enemy.h"
 #include "construct.h"
 #include "rope.h"
-#include "gamescene.h"
 
 /*
-*	ContactListener Constructor
+*	Kills an enemy hit hard enough by a bird
+*	Parameters - the bird, the enemy, and the contact
+*	Return - void
+*/
+static void OnBirdHitEnemy(GameObject* /*bird*/, GameObject* enemy, const ContactEvent& contact)
+{
+	if (contact.type == CONTACT_BEGIN && contact.approachSpeed > 2.0f)
+		static_cast<Enemy*>(enemy)->Kill();
+}
+
+/*
+*	Damages a building object by how fast a bird hit it
+*	Parameters - the bird, the construct, and the contact
+*	Return - void
+*/
+static void OnBirdHitConstruct(GameObject* /*bird*/, GameObject* construct, const ContactEvent& contact)
+{
+	if (contact.type == CONTACT_BEGIN)
+	{
+		Construct* c = static_cast<Construct*>(construct);
+		c->TakeDamage((int)contact.approachSpeed, c->GetConstructType());
+	}
+}
+
+/*
+*	Breaks a rope hit hard enough by a bird
+*	Parameters - the bird, the rope, and the contact
+*	Return - void
+*/
+static void OnBirdHitRope(GameObject* /*bird*/, GameObject* rope, const ContactEvent& contact)
+{
+	if (contact.type == CONTACT_BEGIN && contact.approachSpeed > 2.0f)
+		static_cast<Rope*>(rope)->BreakRope();
+}
+
+/*
+*	ContactListener Constructor - clears the event buffer and registers the game's contact handlers
 *	Parameters - none
 *	Return - none
 */
-ContactListener::ContactListener()
+ContactListener::ContactListener() :
+	m_eventCount(0),
+	m_droppedEvents(0)
 {
+	for (int i = 0; i < GAMEOBJECT_TYPE_COUNT; ++i)
+	{
+		for (int j = 0; j < GAMEOBJECT_TYPE_COUNT; ++j)
+		{
+			m_handlers[i][j] = 0;
+			m_isSwapped[i][j] = false;
+		}
+	}
 
+	RegisterHandler(BIRDOBJ, ENEMY, OnBirdHitEnemy);
+	RegisterHandler(BIRDOBJ, CONSTRUCT, OnBirdHitConstruct);
+	RegisterHandler(BIRDOBJ, ROPE, OnBirdHitRope);
 }
 
 /*
@@ -30,77 +77,109 @@ ContactListener::~ContactListener()
 }
 
 /*
-*	Occurs when collision happens, but before it resolves. Uses velocities before colision to calculate damage ot objects
-*	Parameters - b2Contact, b2Manifold
+*	Called during the step when two fixtures start touching, records how fast they approached each other if a handler wants the contact
+*	Parameters - b2Contact
 *	Return - void
 */
-void ContactListener::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
+void ContactListener::BeginContact(b2Contact* contact)
 {
-	// Get collision variables
+	b2Body* bodyA = contact->GetFixtureA()->GetBody();
+	b2Body* bodyB = contact->GetFixtureB()->GetBody();
+	GameObject* objectA = GetGameObject(bodyA);
+	GameObject* objectB = GetGameObject(bodyB);
+	if (m_handlers[objectA != 0 ? objectA->GetType() : OTHER][objectB != 0 ? objectB->GetType() : OTHER] == 0)
+		return;
+
+	// Velocities haven't been solved yet, so this is the speed of the impact
 	b2WorldManifold worldManifold;
 	contact->GetWorldManifold(&worldManifold);
-	b2PointState state1[2], state2[2];
-	b2GetPointStates(state1, state2, oldManifold, contact->GetManifold());
-	if (state2[0] == b2_addState)
+	b2Vec2 point = worldManifold.points[0];
+	b2Vec2 vA = bodyA->GetLinearVelocityFromWorldPoint(point);
+	b2Vec2 vB = bodyB->GetLinearVelocityFromWorldPoint(point);
+	float32 approachVelocity = b2Dot(vB - vA, worldManifold.normal);
+
+	PushEvent(CONTACT_BEGIN, contact, b2Abs(approachVelocity));
+}
+
+/*
+*	Adds an event to the buffer, events past the end of the buffer are counted and dropped
+*	Parameters - the type of event, the contact and the approach speed
+*	Return - void
+*/
+void ContactListener::PushEvent(ContactEventType type, b2Contact* contact, float approachSpeed)
+{
+	if (m_eventCount == MAX_CONTACT_EVENTS)
 	{
-		// Find the resulting velocity of the collision
-		b2Body* bodyA = contact->GetFixtureA()->GetBody();
-		b2Body* bodyB = contact->GetFixtureB()->GetBody();
-		b2Vec2 point = worldManifold.points[0];
-		b2Vec2 vA = bodyA->GetLinearVelocityFromWorldPoint(point);
-		b2Vec2 vB = bodyB->GetLinearVelocityFromWorldPoint(point);
-		float32 approachVelocity = b2Dot(vB - vA, worldManifold.normal);
-
-		// if the collision was with and enemy and has enough force, kill the enemy
-		if (GetBodyType(bodyA) == ENEMY && GetBodyType(bodyB) == BIRDOBJ && abs(approachVelocity) > 2.0f)
-		{
-			Enemy* e = static_cast<Enemy*>(bodyA->GetUserData());
-			if (e != NULL)
-				e->Kill();
-		}
-		if (GetBodyType(bodyB) == ENEMY && GetBodyType(bodyA) == BIRDOBJ && abs(approachVelocity) > 2.0f)
-		{
-			Enemy* e = static_cast<Enemy*>(bodyB->GetUserData());
-			if (e != NULL)
-				e->Kill();
-		}
+		++m_droppedEvents;
+		return;
+	}
 
-		// If it collides with a building object, damage the object
-		if (GetBodyType(bodyA) == CONSTRUCT && GetBodyType(bodyB) == BIRDOBJ)
-		{
-			Construct* e = static_cast<Construct*>(bodyA->GetUserData());
-			if (e != NULL)
-				e->TakeDamage((int)approachVelocity, e->GetConstructType());
-		}
-		if (GetBodyType(bodyB) == BIRDOBJ && GetBodyType(bodyA) == CONSTRUCT)
-		{
-			Construct* e = static_cast<Construct*>(bodyB->GetUserData());
-			if (e != NULL)
-				e->TakeDamage((int)approachVelocity, e->GetConstructType());
-		}
+	ContactEvent& event = m_events[m_eventCount++];
+	event.type = type;
+	event.bodyA = contact->GetFixtureA()->GetBody();
+	event.bodyB = contact->GetFixtureB()->GetBody();
+	event.approachSpeed = approachSpeed;
+}
 
-		// If a bird collides with a Rope with enough force, break the Rope
-		if (GetBodyType(bodyA) == ROPE && GetBodyType(bodyB) == BIRDOBJ && abs(approachVelocity) > 2.0f)
-		{
-			GameScene::GetInstance().GetRope()->BreakRope();
-		}
-		if (GetBodyType(bodyB) == ROPE && GetBodyType(bodyA) == BIRDOBJ && abs(approachVelocity) > 2.0f)
-		{
-			GameScene::GetInstance().GetRope()->BreakRope();
-		}
+/*
+*	Sets the game logic to run for contacts between two types of object, in either order
+*	Parameters - the two object types, and the handler that takes objects of those types in that order
+*	Return - void
+*/
+void ContactListener::RegisterHandler(GameObjectType first, GameObjectType second, ContactHandler handler)
+{
+	m_handlers[first][second] = handler;
+	m_isSwapped[first][second] = false;
+	if (first != second)
+	{
+		m_handlers[second][first] = handler;
+		m_isSwapped[second][first] = true;
 	}
 }
 
 /*
-*	Converts the body user data from the collision into a GameObject to determine the type of object
+*	Runs the handler for every event recorded during the step and empties the buffer. Called after the step, so handlers can change the world
+*	Parameters - none
+*	Return - void
+*/
+void ContactListener::DispatchEvents()
+{
+	for (unsigned i = 0; i < m_eventCount; ++i)
+	{
+		const ContactEvent& event = m_events[i];
+		GameObject* objectA = GetGameObject(event.bodyA);
+		GameObject* objectB = GetGameObject(event.bodyB);
+		GameObjectType typeA = objectA != 0 ? objectA->GetType() : OTHER;
+		GameObjectType typeB = objectB != 0 ? objectB->GetType() : OTHER;
+
+		ContactHandler handler = m_handlers[typeA][typeB];
+		if (handler == 0)
+			continue;
+
+		if (m_isSwapped[typeA][typeB])
+			handler(objectB, objectA, event);
+		else
+			handler(objectA, objectB, event);
+	}
+	m_eventCount = 0;
+}
+
+/*
+*	Returns how many events didn't fit in the buffer since the listener was created
+*	Parameters - none
+*	Return - unsigned number of events
+*/
+unsigned ContactListener::GetDroppedEventCount()
+{
+	return m_droppedEvents;
+}
+
+/*
+*	Converts the body user data into a GameObject
 *	Parameters - collision body
-*	Return - GameObjectType enumerator
+*	Return - the game object, or null for bodies without one such as the ground
 */
-GameObjectType ContactListener::GetBodyType(b2Body* body)
+GameObject* ContactListener::GetGameObject(b2Body* body)
 {
-	// cast the user data to a game object to find the type
-	GameObject* object = static_cast<GameObject*>(body->GetUserData());
-	if (object != NULL)
-		return object->GetType();
-	return OTHER;
-}
\ No newline at end of file
+	return static_cast<GameObject*>(body->GetUserData());
+}
@@ -7,6 +7,28 @@
 #include "utils.h"
 #include "gameobject.h"
 
+// Constants
+#define MAX_CONTACT_EVENTS 1024
+#define GAMEOBJECT_TYPE_COUNT (OTHER + 1)
+
+enum ContactEventType
+{
+	CONTACT_BEGIN
+};
+
+// A contact recorded during the physics step, handled once the step is over
+struct ContactEvent
+{
+	ContactEventType type;
+	b2Body* bodyA;
+	b2Body* bodyB;
+	// Speed the bodies were moving towards each other when they touched
+	float approachSpeed;
+};
+
+// Game logic run for a contact between two types of object, the objects are passed in the order the handler was registered with
+typedef void (*ContactHandler)(GameObject* first, GameObject* second, const ContactEvent& contact);
+
 class ContactListener : public b2ContactListener
 {
 public:
@@ -14,12 +36,27 @@ public:
 	ContactListener();
 	~ContactListener();
 
-	virtual void PreSolve(b2Contact* contact, const b2Manifold* oldManifold);
+	virtual void BeginContact(b2Contact* contact);
+
+	void RegisterHandler(GameObjectType first, GameObjectType second, ContactHandler handler);
+	void DispatchEvents();
+
+	unsigned GetDroppedEventCount();
 
 private:
 
-	GameObjectType GetBodyType(b2Body* body);
+	void PushEvent(ContactEventType type, b2Contact* contact, float approachSpeed);
+	GameObject* GetGameObject(b2Body* body);
+
+	// Events of the current step
+	ContactEvent m_events[MAX_CONTACT_EVENTS];
+	unsigned m_eventCount;
+	unsigned m_droppedEvents;
+
+	// Handler for each pair of object types, and whether the pair has to be swapped to match the handler
+	ContactHandler m_handlers[GAMEOBJECT_TYPE_COUNT][GAMEOBJECT_TYPE_COUNT];
+	bool m_isSwapped[GAMEOBJECT_TYPE_COUNT][GAMEOBJECT_TYPE_COUNT];
 
 };
 
-#endif
\ No newline at end of file
+#endif
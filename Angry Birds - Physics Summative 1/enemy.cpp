@@ -4,7 +4,7 @@
 #include "enemy.h"
 
 // Local includes
-#include "hud.h"
+#include "gamescene.h"
 
 /*
 *	Enemy Constructor - Calls GameObject Constructor and assigns variables, and creates the physics body
@@ -39,40 +39,13 @@ void Enemy::Update(float time)
 }
 
 /*
-*	Render - draws the sprite with the correct scale, rotation and position
+*	Render - queues the sprite at the interpolated transform of the physics body
 *	Parameters - none
 *	Return - void
 */
 void Enemy::Render()
 {
-	// bind the program
-	m_program->Use();
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	// bind the texture and set the "tex" uniform in the fragment shader
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
-	m_program->setUniform("tex", 0);
-	m_program->setUniform("model",
-		glm::scale(glm::mat4(), glm::vec3(((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH), 1.0f, 1.0f)) *
-		glm::translate(glm::mat4(), glm::vec3(m_position.x * METERSTOUNITS, m_position.y * METERSTOUNITS, 0.0f)) *
-		glm::rotate(glm::mat4(), m_body->GetAngle(), glm::vec3(0, 0, 1)));
-
-	// bind the texture and set the "tex" uniform in the fragment shader
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
-
-	// bind the VAO and draw
-	glBindVertexArray(m_vao);
-	glDrawArrays(GL_TRIANGLES, 0, 6 * 2 * 3);
-
-	// unbind the VAO, the program and the texture
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	glDisable(GL_BLEND);
-	m_program->StopUsing();
+	QueueSprite();
 }
 
 /*
@@ -112,8 +85,12 @@ void Enemy::CreatePhysicsBody(b2World* world)
 */
 void Enemy::Kill()
 {
+	// Only score once, the body can be hit again before it is destroyed
+	if (!m_isAlive)
+		return;
+
 	// add to the score and set the object to dead
-	HUD::GetInstance().AddScoreText(50);
+	GameScene::GetInstance().AddScore(50);
 	m_isAlive = false;
 }
 
@@ -21,7 +21,7 @@ public:
 
 	void Kill();
 
-	b2Body* GetBody();
+	virtual b2Body* GetBody();
 	b2Vec2 Position();
 	bool IsAlive();
 
@@ -0,0 +1,131 @@
+#pragma once
+
+#ifndef ENTITYSTORE_H
+#define ENTITYSTORE_H
+
+// Library includes
+#include <new>
+#include <vector>
+
+// A list of live game objects of one type. Removed objects stay alive until RecycleRemoved, so their
+// bodies can be destroyed after the physics step, and their memory is then reused by later objects.
+// Objects are created in place with: store.Add(new (store.Allocate()) T(...))
+template <class T>
+class EntityStore
+{
+public:
+
+	typedef typename std::vector<T*>::iterator iterator;
+
+	EntityStore()
+	{
+
+	}
+
+	~EntityStore()
+	{
+		RemoveAll();
+		RecycleRemoved();
+
+		for (std::vector<void*>::iterator it = m_pool.begin(); it != m_pool.end(); ++it)
+			::operator delete(*it);
+		m_pool.clear();
+	}
+
+	/*
+	*	Returns memory for a new object, reusing a recycled object's memory when there is one
+	*	Parameters - none
+	*	Return - memory big enough for a T
+	*/
+	void* Allocate()
+	{
+		if (m_pool.empty())
+			return ::operator new(sizeof(T));
+
+		void* memory = m_pool.back();
+		m_pool.pop_back();
+		return memory;
+	}
+
+	/*
+	*	Adds an object created in memory from Allocate to the end of the store
+	*	Parameters - the object
+	*	Return - the object
+	*/
+	T* Add(T* object)
+	{
+		m_objects.push_back(object);
+		return object;
+	}
+
+	/*
+	*	Removes an object in constant time by moving the last object into its place
+	*	Parameters - index of the object
+	*	Return - void
+	*/
+	void SwapRemove(size_t index)
+	{
+		m_removed.push_back(m_objects[index]);
+		m_objects[index] = m_objects.back();
+		m_objects.pop_back();
+	}
+
+	/*
+	*	Removes an object and keeps the order of the rest, for stores where the order matters
+	*	Parameters - index of the object
+	*	Return - void
+	*/
+	void OrderedRemove(size_t index)
+	{
+		m_removed.push_back(m_objects[index]);
+		m_objects.erase(m_objects.begin() + index);
+	}
+
+	/*
+	*	Removes every object
+	*	Parameters - none
+	*	Return - void
+	*/
+	void RemoveAll()
+	{
+		m_removed.insert(m_removed.end(), m_objects.begin(), m_objects.end());
+		m_objects.clear();
+	}
+
+	/*
+	*	Destroys the removed objects and keeps their memory for new objects
+	*	Parameters - none
+	*	Return - void
+	*/
+	void RecycleRemoved()
+	{
+		for (typename std::vector<T*>::iterator it = m_removed.begin(); it != m_removed.end(); ++it)
+		{
+			(*it)->~T();
+			m_pool.push_back(*it);
+		}
+		m_removed.clear();
+	}
+
+	// Get methods
+	size_t Size() const { return m_objects.size(); }
+	bool Empty() const { return m_objects.empty(); }
+	T* operator[](size_t index) const { return m_objects[index]; }
+	T* Front() const { return m_objects.front(); }
+	T* Back() const { return m_objects.back(); }
+	iterator begin() { return m_objects.begin(); }
+	iterator end() { return m_objects.end(); }
+
+private:
+
+	// Private methods
+	EntityStore(const EntityStore& other);
+	EntityStore& operator= (const EntityStore& other);
+
+	std::vector<T*> m_objects;
+	std::vector<T*> m_removed;
+	std::vector<void*> m_pool;
+
+};
+
+#endif
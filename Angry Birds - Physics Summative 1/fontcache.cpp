@@ -0,0 +1,185 @@
+
+// This include
+#include "fontcache.h"
+
+// Library includes
+#include <vector>
+
+// Static Variables
+FontCache* FontCache::m_fontCache = 0;
+
+/*
+*	FontCache Constructor
+*	Parameters - none
+*	Return - none
+*/
+FontCache::FontCache()
+{
+
+}
+
+/*
+*	FontCache Destructor - deletes all the atlas textures
+*	Parameters - none
+*	Return - none
+*/
+FontCache::~FontCache()
+{
+	for (std::map<std::pair<std::string, unsigned>, FontAtlas*>::iterator it = m_atlases.begin(); it != m_atlases.end(); ++it)
+	{
+		glDeleteTextures(1, &it->second->texture);
+		delete it->second;
+		it->second = 0;
+	}
+	m_atlases.clear();
+}
+
+/*
+*	Returns the atlas for a font at a pixel size, rasterising it only the first time it is requested
+*	Parameters - file path of the font, the pixel size to rasterise at
+*	Return - the atlas, owned by the cache
+*/
+const FontAtlas* FontCache::Get(const std::string& fontPath, unsigned pixelSize)
+{
+	std::pair<std::string, unsigned> key(fontPath, pixelSize);
+
+	// Share the atlas if it has already been built
+	std::map<std::pair<std::string, unsigned>, FontAtlas*>::iterator it = m_atlases.find(key);
+	if (it != m_atlases.end())
+		return it->second;
+
+	FontAtlas* atlas = BuildAtlas(fontPath, pixelSize);
+	m_atlases[key] = atlas;
+	return atlas;
+}
+
+/*
+*	Rasterises the first 128 ASCII characters with FreeType and packs them into rows of one texture
+*	Parameters - file path of the font, the pixel size to rasterise at
+*	Return - the new atlas
+*/
+FontAtlas* FontCache::BuildAtlas(const std::string& fontPath, unsigned pixelSize)
+{
+	FontAtlas* atlas = new FontAtlas();
+	atlas->texture = 0;
+	atlas->width = FONT_ATLAS_WIDTH;
+	atlas->height = 0;
+
+	FT_Library ft;
+	if (FT_Init_FreeType(&ft)) {
+		std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+		return atlas;
+	}
+
+	FT_Face face; // Load font as face
+	if (FT_New_Face(ft, fontPath.c_str(), 0, &face)) {
+		std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+		FT_Done_FreeType(ft);
+		return atlas;
+	}
+
+	// Set size to load glyphs as 
+	FT_Set_Pixel_Sizes(face, 0, pixelSize);
+
+	// Rasterise every glyph and place it in the next free spot of the current row
+	std::vector<unsigned char> bitmaps[FONT_GLYPH_COUNT];
+	glm::ivec2 offsets[FONT_GLYPH_COUNT];
+	int penX = 1, penY = 1, rowHeight = 0;
+	for (GLubyte c = 0; c < FONT_GLYPH_COUNT; c++) {
+		Glyph& glyph = atlas->glyphs[c];
+		glyph = Glyph();
+		offsets[c] = glm::ivec2(0, 0);
+
+		// Load character glyph
+		if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
+			std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl; continue;
+		}
+
+		FT_Bitmap& bitmap = face->glyph->bitmap;
+		glyph.Size = glm::ivec2(bitmap.width, bitmap.rows);
+		glyph.Bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+		glyph.Advance = face->glyph->advance.x;
+
+		// Wrap to a new row, leaving a pixel of padding so filtering does not bleed between glyphs
+		if (penX + (int)bitmap.width + 1 > atlas->width)
+		{
+			penX = 1;
+			penY += rowHeight + 1;
+			rowHeight = 0;
+		}
+		offsets[c] = glm::ivec2(penX, penY);
+		penX += bitmap.width + 1;
+		rowHeight = b2Max(rowHeight, (int)bitmap.rows);
+
+		// Copy the rows out, the pitch can be wider than the glyph
+		bitmaps[c].resize(bitmap.width * bitmap.rows);
+		for (unsigned row = 0; row < bitmap.rows; ++row)
+			for (unsigned col = 0; col < bitmap.width; ++col)
+				bitmaps[c][row * bitmap.width + col] = bitmap.buffer[row * bitmap.pitch + col];
+	}
+
+	// Destroy FreeType once we're finished 
+	FT_Done_Face(face);
+	FT_Done_FreeType(ft);
+
+	// Round the height up to a power of two
+	atlas->height = 1;
+	while (atlas->height < penY + rowHeight + 1)
+		atlas->height *= 2;
+
+	// Disable byte-alignment restriction 
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// Generate the atlas texture, cleared so the padding stays empty
+	std::vector<unsigned char> clear(atlas->width * atlas->height, 0);
+	glGenTextures(1, &atlas->texture);
+	glBindTexture(GL_TEXTURE_2D, atlas->texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, atlas->width, atlas->height, 0, GL_RED, GL_UNSIGNED_BYTE, &clear[0]);
+
+	// Set texture options
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// Upload each glyph into its spot and store its texture coordinates
+	for (GLubyte c = 0; c < FONT_GLYPH_COUNT; c++) {
+		Glyph& glyph = atlas->glyphs[c];
+		if (!bitmaps[c].empty())
+			glTexSubImage2D(GL_TEXTURE_2D, 0, offsets[c].x, offsets[c].y, glyph.Size.x, glyph.Size.y, GL_RED, GL_UNSIGNED_BYTE, &bitmaps[c][0]);
+
+		glm::vec2 atlasSize((float)atlas->width, (float)atlas->height);
+		glyph.UVMin = glm::vec2(offsets[c]) / atlasSize;
+		glyph.UVMax = glm::vec2(offsets[c] + glyph.Size) / atlasSize;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	return atlas;
+}
+
+/*
+*	Returns the singleton instance of the font cache
+*	Parameters - none
+*	Return - reference to the font cache instance
+*/
+FontCache& FontCache::GetInstance()
+{
+	// Return the singleton
+	if (m_fontCache == 0)
+		m_fontCache = new FontCache();
+
+	return *m_fontCache;
+}
+
+/*
+*	Destroys the singleton instance of the font cache
+*	Parameters - none
+*	Return - void
+*/
+void FontCache::DestroyInstance()
+{
+	// Delete the singleton instance
+	delete m_fontCache;
+	m_fontCache = 0;
+}
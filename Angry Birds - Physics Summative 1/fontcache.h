@@ -0,0 +1,69 @@
+#pragma once
+
+#ifndef FONTCACHE_H
+#define FONTCACHE_H
+
+// Local includes
+#include "utils.h"
+
+// Third-party includes
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+// Library includes
+#include <map>
+#include <string>
+#include <utility>
+
+// Constants
+#define FONT_GLYPH_COUNT 128
+#define FONT_ATLAS_WIDTH 1024
+
+// Metrics of one glyph, and where it sits in the atlas
+struct Glyph
+{
+	glm::ivec2 Size; // Size of glyph
+	glm::ivec2 Bearing;
+	GLuint Advance;
+	glm::vec2 UVMin;
+	glm::vec2 UVMax;
+};
+
+// Every ASCII glyph of a font at one pixel size, packed into a single texture
+struct FontAtlas
+{
+	GLuint texture;
+	int width;
+	int height;
+	Glyph glyphs[FONT_GLYPH_COUNT];
+};
+
+class FontCache
+{
+public:
+
+	~FontCache();
+
+	static FontCache& GetInstance();
+	static void DestroyInstance();
+
+	const FontAtlas* Get(const std::string& fontPath, unsigned pixelSize);
+
+private:
+
+	// Private methods
+	FontCache();
+	FontCache(const FontCache& other);
+	FontCache& operator= (const FontCache& other);
+
+	FontAtlas* BuildAtlas(const std::string& fontPath, unsigned pixelSize);
+
+	// Atlases by (font path, pixel size)
+	std::map<std::pair<std::string, unsigned>, FontAtlas*> m_atlases;
+
+	// Singleton Instance
+	static FontCache* m_fontCache;
+
+};
+
+#endif
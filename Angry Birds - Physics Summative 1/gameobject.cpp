@@ -3,137 +3,84 @@
 // This include
 #include "gameobject.h"
 
+// Static Variables
+float GameObject::s_interpolation = 1.0f;
+
 /*
-*	GameObject Constructor - loads the shaders and creates the program
+*	GameObject Constructor - gets the shared program
 *	Parameters - none
 *	Return - none
 */
 GameObject::GameObject() : 
+	m_hasPreviousTransform(false),
+#ifndef HEADLESS
+	m_texture(0),
+#endif
 	m_type(OTHER)
 {
-	// Load shaders
-	std::vector<Shader> shaders;
-	shaders.push_back(Shader::GetShaderFromFile("Assets/Shaders/vertex-shader.vs", GL_VERTEX_SHADER));
-	shaders.push_back(Shader::GetShaderFromFile("Assets/Shaders/fragment-shader.fs", GL_FRAGMENT_SHADER));
-	m_program = new Program(shaders);
+#ifndef HEADLESS
+	// Get the shared sprite program
+	m_program = ProgramRegistry::GetInstance().Get("Assets/Shaders/vertex-shader.vs", "Assets/Shaders/fragment-shader.fs");
+#endif
 }
 
 /*
-*	GameObject Constructor - loads the shaders and creates the program, Loads the shape and the sprite
+*	GameObject Constructor - gets the shared program and loads the sprite
 *	Parameters - position x and y, width and height, and file path of the sprite
 *	Return - none
 */
 GameObject::GameObject(float posX, float posY, float width, float height, char* filePath) :
+	m_hasPreviousTransform(false),
 	m_position(b2Vec2(posX, posY)),
+#ifndef HEADLESS
+	m_texture(0),
+#endif
 	m_width(width),
 	m_height(height),
 	m_type(OTHER)
 {
-	// Load shaders
-	std::vector<Shader> shaders;
-	shaders.push_back(Shader::GetShaderFromFile("Assets\\Shaders\\vertex-shader.vs", GL_VERTEX_SHADER));
-	shaders.push_back(Shader::GetShaderFromFile("Assets\\Shaders\\fragment-shader.fs", GL_FRAGMENT_SHADER));
-	m_program = new Program(shaders);
-
-	// Load the shape
-	LoadShape();
+#ifndef HEADLESS
+	// Get the shared sprite program
+	m_program = ProgramRegistry::GetInstance().Get("Assets/Shaders/vertex-shader.vs", "Assets/Shaders/fragment-shader.fs");
+#endif
 
 	// Load the texture for the sprite
 	LoadSprite(filePath);
 }
 
 /*
-*	GameObject Destructor - deletes the program
+*	GameObject Destructor - releases the texture
 *	Parameters - none
 *	Return - none
 */
 GameObject::~GameObject()
 {
-	// Delete pointers
-	delete m_program;
+#ifndef HEADLESS
+	// The program is owned by the registry
 	m_program = 0;
-}
 
-/*
-*	Loads the opengl shape on which the sprite will be drawn
-*	Parameters - none
-*	Return - void
-*/
-void GameObject::LoadShape()
-{
-	float width = m_width / 2.0f * METERSTOUNITS;
-	float height = m_height / 2.0f * METERSTOUNITS;
-
-	std::vector<GLfloat> vertexData = {
-		//  X		Y		  Z			 U     V
-		-width,  -height,	1.0f,		1.0f, 0.0f,
-		 width,  -height,	1.0f,		0.0f, 0.0f,
-		-width,	  height,	1.0f,		1.0f, 1.0f,
-		 width,  -height,	1.0f,		0.0f, 0.0f,
-		 width,	  height,	1.0f,		0.0f, 1.0f,
-		-width,	  height,	1.0f,		1.0f, 1.0f,
-	};
-
-	// make and bind the VAO
-	glGenVertexArrays(1, &m_vao);
-	glBindVertexArray(m_vao);
-
-	// make and bind the VBO
-	glGenBuffers(1, &m_vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-	glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(GLfloat), &vertexData[0], GL_STATIC_DRAW);
-
-	// connect the xyz to the "vert" attribute of the vertex shader
-	glEnableVertexAttribArray(m_program->attrib("vert"));
-	glVertexAttribPointer(m_program->attrib("vert"), 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), NULL);
-
-	// connect the uv coords to the "vertTexCoord" attribute of the vertex shader
-	glEnableVertexAttribArray(m_program->attrib("vertTexCoord"));
-	glVertexAttribPointer(m_program->attrib("vertTexCoord"), 2, GL_FLOAT, GL_TRUE, 5 * sizeof(GLfloat), (const GLvoid*)(3 * sizeof(GLfloat)));
-
-	// unbind the VAO
-	glBindVertexArray(0);
+	if (m_texture != 0)
+		TextureCache::GetInstance().Release(m_texture);
+	m_texture = 0;
+#endif
 }
 
 /*
-*	Load the sprite using SOIL
+*	Gets the sprite from the texture cache, which only decodes and uploads each file once. Does nothing in the headless build
 *	Parameters - file path of the sprite
 *	Return - void
 */
 void GameObject::LoadSprite(char* path)
 {
-	// Generate texture
-	glGenTextures(1, &m_texture);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	int width, height;
-
-	// Load actual image
-	unsigned char* image = SOIL_load_image(path,
-		&width,
-		&height,
-		0,
-		SOIL_LOAD_RGBA);
-
-	glTexImage2D(GL_TEXTURE_2D,
-		0,
-		GL_RGBA,
-		width,
-		height,
-		0,
-		GL_RGBA,
-		GL_UNSIGNED_BYTE,
-		image);
-
-	// Bind texture
-	glGenerateMipmap(GL_TEXTURE_2D);
-	SOIL_free_image_data(image);
-	glBindTexture(GL_TEXTURE_2D, 0);
+#ifndef HEADLESS
+	// Acquire before releasing so swapping to the same sprite keeps it resident
+	GLuint texture = TextureCache::GetInstance().Acquire(path);
+	if (m_texture != 0)
+		TextureCache::GetInstance().Release(m_texture);
+	m_texture = texture;
+#else
+	B2_NOT_USED(path);
+#endif
 }
 
 /*
@@ -147,37 +94,81 @@ void GameObject::Update(float time)
 }
 
 /*
-*	Render - draws the sprite with the correct position
+*	Render - queues the sprite in the sprite batch at the correct position
 *	Parameters - none
 *	Return - void
 */
 void GameObject::Render()
 {
-	// bind the program
-	m_program->Use();
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	// bind the texture and set the "tex" uniform in the fragment shader
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
-	m_program->setUniform("tex", 0);
-	m_program->setUniform("model", glm::translate(glm::mat4(), glm::vec3(m_position.x * METERSTOUNITS, m_position.y * METERSTOUNITS, 0.0f)));
-
-	// bind the texture and set the "tex" uniform in the fragment shader
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
-
-	// bind the VAO and draw
-	glBindVertexArray(m_vao);
-	glDrawArrays(GL_TRIANGLES, 0, 6 * 2 * 3);
-
-	// unbind the VAO, the program and the texture
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	glDisable(GL_BLEND);
-	m_program->StopUsing();
+#ifndef HEADLESS
+	SpriteBatch::GetInstance().Draw(m_program, m_texture,
+		glm::translate(glm::mat4(), glm::vec3(m_position.x * METERSTOUNITS, m_position.y * METERSTOUNITS, 0.0f)) *
+		glm::scale(glm::mat4(), glm::vec3(m_width / 2.0f * METERSTOUNITS, m_height / 2.0f * METERSTOUNITS, 1.0f)));
+#endif
+}
+
+/*
+*	Queues the sprite in the sprite batch with the correct scale, rotation and position, used by physics objects
+*	Parameters - none
+*	Return - void
+*/
+void GameObject::QueueSprite()
+{
+#ifndef HEADLESS
+	b2Body* body = GetBody();
+	b2Vec2 position = body->GetPosition();
+	float angle = body->GetAngle();
+
+	// Blend from the transform before the last physics step, so motion is smooth whatever the frame rate
+	if (m_hasPreviousTransform)
+	{
+		position = m_previousPosition + s_interpolation * (position - m_previousPosition);
+		angle = m_previousAngle + s_interpolation * (angle - m_previousAngle);
+	}
+
+	// The aspect ratio scale is applied by the shader from the frame constants
+	SpriteBatch::GetInstance().Draw(m_program, m_texture,
+		glm::translate(glm::mat4(), glm::vec3(position.x * METERSTOUNITS, position.y * METERSTOUNITS, 0.0f)) *
+		glm::rotate(glm::mat4(), angle, glm::vec3(0, 0, 1)) *
+		glm::scale(glm::mat4(), glm::vec3(m_width / 2.0f * METERSTOUNITS, m_height / 2.0f * METERSTOUNITS, 1.0f)),
+		SPACE_WORLD);
+#endif
+}
+
+/*
+*	Saves the current body transform, called before each physics step so rendering can interpolate
+*	Parameters - none
+*	Return - void
+*/
+void GameObject::StorePreviousTransform()
+{
+	b2Body* body = GetBody();
+	if (body == 0)
+		return;
+
+	m_previousPosition = body->GetPosition();
+	m_previousAngle = body->GetAngle();
+	m_hasPreviousTransform = true;
+}
+
+/*
+*	Sets how far rendering is between the previous and the current physics step
+*	Parameters - blend factor from 0 (previous step) to 1 (current step)
+*	Return - void
+*/
+void GameObject::SetInterpolation(float alpha)
+{
+	s_interpolation = alpha;
+}
+
+/*
+*	returns the physics body, objects without one return null
+*	Parameters - none
+*	Return - b2Body pointer
+*/
+b2Body* GameObject::GetBody()
+{
+	return 0;
 }
 
 /*
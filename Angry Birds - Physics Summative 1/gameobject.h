@@ -7,7 +7,12 @@
 
 // Local includes
 #include "utils.h"
+#ifndef HEADLESS
 #include "program.h"
+#include "programregistry.h"
+#include "spritebatch.h"
+#include "texturecache.h"
+#endif
 
 enum GameObjectType
 {
@@ -28,22 +33,35 @@ public:
 	GameObject(float posX, float posY, float width, float height, char* filePath);
 	~GameObject();
 
-	virtual void LoadShape();
 	void LoadSprite(char* path);
 
 	virtual void Render();
 	virtual void Update(float time);
 
+	void StorePreviousTransform();
+	static void SetInterpolation(float alpha);
+
 	// Get & set methods
+	virtual b2Body* GetBody();
 	float GetHalfWidth();
 	float GetHalfHeight();
 	GameObjectType GetType();
 
 protected:
 
+	void QueueSprite();
+
+	// Body transform before the last physics step, blended with the current one when rendering
+	b2Vec2 m_previousPosition;
+	float m_previousAngle;
+	bool m_hasPreviousTransform;
+	static float s_interpolation;
+
 	b2Vec2 m_position;
+#ifndef HEADLESS
 	Program* m_program;
-	GLuint m_vao, m_vbo, m_texture;
+	GLuint m_texture;
+#endif
 
 	float m_width, m_height;
 	GameObjectType m_type;
@@ -4,7 +4,13 @@
 #include "gamescene.h"
 
 // Local includes
+#include "levelfile.h"
+#ifndef HEADLESS
 #include "hud.h"
+#endif
+
+// Library includes
+#include <algorithm>
 
 // Static Variables
 GameScene* GameScene::m_gameScene = 0;
@@ -16,14 +22,18 @@ GameScene* GameScene::m_gameScene = 0;
 */
 GameScene::GameScene() :
 	m_world(0),
+#ifndef HEADLESS
 	m_background(0),
-	m_ground(0),
-	m_mouseJoint(0),
 	m_slingshotBack(0),
 	m_slingshotFore(0),
+#endif
+	m_ground(0),
+	m_mouseJoint(0),
 	m_isGameOver(0),
-	m_rope(0),
-	m_spring(0)
+	m_score(0),
+	m_currentLevel(0),
+	m_accumulator(0.0f),
+	m_stepCount(0)
 {
 	
 }
@@ -38,6 +48,7 @@ GameScene::~GameScene()
 	// Free memory of game objects by calling the reset function
 	Reset();
 
+#ifndef HEADLESS
 	// Free memory by deleting other objects in the scene
 	delete m_background;
 	m_background = 0;
@@ -45,6 +56,7 @@ GameScene::~GameScene()
 	m_slingshotBack = 0;
 	delete m_slingshotFore;
 	m_slingshotFore = 0;
+#endif
 }
 
 /*
@@ -56,11 +68,32 @@ void GameScene::InitialiseWorld()
 {
 	// Set up the physics world
 	m_world = new b2World(b2Vec2(0.0f, -9.81f));
+
+	// Record contacts during the step, they are handled once it's done
+	m_world->SetContactListener(&m_contactListener);
 	
+#ifndef HEADLESS
 	// Create a background
 	m_background = new Background("Assets/Sprites/background.png");
+#endif
 
 	// Create a ground object
+	CreateGround();
+	
+#ifndef HEADLESS
+	// Create the slingshot object
+	m_slingshotBack = new GameObject(-3.6f, -2.6f, 0.3f, 1.8f, "Assets/Sprites/slingshotback.png");
+	m_slingshotFore = new GameObject(-3.6f, -2.6f, 0.3f, 1.8f, "Assets/Sprites/slingshotfore.png");
+#endif
+}
+
+/*
+*	Creates the ground body that the level sits on and the mouse joint pulls against
+*	Parameters - none
+*	Return - void
+*/
+void GameScene::CreateGround()
+{
 	b2BodyDef bodyDef;
 	bodyDef.position.Set(0.0f, -4.5f);
 
@@ -76,105 +109,97 @@ void GameScene::InitialiseWorld()
 	fixtureDef.friction = 1.0f;
 	fixtureDef.shape = &shape;
 	m_ground->CreateFixture(&fixtureDef);
-	
-	// Create the slingshot object
-	m_slingshotBack = new GameObject(-3.6f, -2.6f, 0.3f, 1.8f, "Assets/Sprites/slingshotback.png");
-	m_slingshotFore = new GameObject(-3.6f, -2.6f, 0.3f, 1.8f, "Assets/Sprites/slingshotfore.png");
 }
 
 /*
-*	Creates the objects for the first level of the game
-*	Parameters - none
-*	Return - void
+*	Loads a numbered level from the levels folder
+*	Parameters - the level number
+*	Return - whether the level exists
 */
-void GameScene::SetupLevel1()
+bool GameScene::LoadLevel(int level)
 {
-	m_currentLevel = 1;
+	std::ostringstream path;
+	path << LEVEL_PATH_PREFIX << level << LEVEL_PATH_EXTENSION;
 
-	// Add the birds
-	AddBirdObj(-3.6f, -2.0f, CLASSIC);
-	AddBirdObj(-3.6f, -2.0f, CLASSIC);
-	AddBirdObj(-3.6f, -2.0f, CLASSIC);
+	if (!LoadLevelFile(path.str()))
+		return false;
 
-	// Add the objects
-	m_constructs.push_back(new Construct(2.6f, -3.0f, m_world, DESTRUCTIBLE_BLOCK, 0.0f));
-	m_constructs.push_back(new Construct(3.8f, -3.0f, m_world, DESTRUCTIBLE_BLOCK, 0.0f));
-	m_constructs.push_back(new Construct(3.8f, -2.3f, m_world, DESTRUCTIBLE_BLOCK, 0.0f));
-	m_constructs.push_back(new Construct(4.2f, -3.0f, m_world, DESTRUCTIBLE_PLANK, 110.0f));
-
-	// Add the enemies
-	m_enemies.push_back(new Enemy(3.2f, -3.0f, 0.4f, 0.55f, m_world, "Assets/Sprites/pig.png"));
-
-	// Update the 'birds left' text in the HUD
-	HUD::GetInstance().UpdateBirdsLeftText(m_birds.size());
+	m_currentLevel = level;
+	return true;
 }
 
 /*
-*	Creates the objects for the second level of the game
-*	Parameters - none
-*	Return - void
+*	Deletes the current level elements and creates every object in a binary level file in one pass
+*	Parameters - file path of the level
+*	Return - whether the file could be loaded
 */
-void GameScene::SetupLevel2()
+bool GameScene::LoadLevelFile(const std::string& path)
 {
-	m_currentLevel = 2;
-
-	// Add the birds
-	AddBirdObj(-3.6f, -2.0f, SPLITTER);
-	AddBirdObj(-3.6f, -2.0f, SPLITTER);
-	AddBirdObj(-3.6f, -2.0f, SPLITTER);
-
-	// Add the objects
-	m_constructs.push_back(new Construct(2.6f, -3.0f, m_world, INDESTRUCTIBLE_BLOCK, 0.0f));
-	m_constructs.push_back(new Construct(1.15f, -3.0f, m_world, INDESTRUCTIBLE_BLOCK, 0.0f));
-	m_constructs.push_back(new Construct(2.6f, -2.3f, m_world, DESTRUCTIBLE_BLOCK, 0.0f));
-	m_constructs.push_back(new Construct(1.15f, -2.3f, m_world, DESTRUCTIBLE_BLOCK, 0.0f));
-	m_constructs.push_back(new Construct(3.8f, -2.3f, m_world, DESTRUCTIBLE_BLOCK, 0.0f));
-
-	// Add the enemies
-	m_enemies.push_back(new Enemy(3.2f, -3.0f, 0.4f, 0.55f, m_world, "Assets/Sprites/pig.png"));
-	m_enemies.push_back(new Enemy(1.9f, -3.0f, 0.4f, 0.55f, m_world, "Assets/Sprites/pig.png"));
-
-
-	// Misc objects (Rope)
-	m_rope = new Rope(1.42f, -2.0f, m_world, 9, m_constructs[3], m_constructs[2]);
-
-	// Update the 'birds left' text in the HUD
-	HUD::GetInstance().UpdateBirdsLeftText(m_birds.size());
-}
-
-/*
-*	Creates the objects for the third level of the game
-*	Parameters - none
-*	Return - void
-*/
-void GameScene::SetupLevel3()
-{
-	m_currentLevel = 3;
-
-	// Add the birds
-	AddBirdObj(-3.6f, -2.0f, BOMBER);
-	AddBirdObj(-3.6f, -2.0f, BOMBER);
-	AddBirdObj(-3.6f, -2.0f, BOMBER);
+	// Reset the game scene by deleting game objects
+	Reset();
 
-	// Add the objects
-	m_constructs.push_back(new Construct(2.6f, -3.0f, m_world, DESTRUCTIBLE_BLOCK, 0.0f));
-	m_constructs.push_back(new Construct(2.6f, -2.5f, m_world, INDESTRUCTIBLE_PLANK, 0.0f));
-	m_constructs.push_back(new Construct(2.6f, -2.0f, m_world, DESTRUCTIBLE_BLOCK, 0.0f));
-	m_constructs.push_back(new Construct(2.6f, -1.5f, m_world, INDESTRUCTIBLE_PLANK, 0.0f));
-	m_constructs.push_back(new Construct(2.6f, -1.0f, m_world, DESTRUCTIBLE_BLOCK, 0.0f));
-	m_constructs.push_back(new Construct(2.6f, -0.5f, m_world, INDESTRUCTIBLE_PLANK, 0.0f));
-	m_constructs.push_back(new Construct(2.6f, 0.0f, m_world, DESTRUCTIBLE_BLOCK, 0.0f));
+	LevelFile file;
+	if (!file.Open(path))
+		return false;
 
-	// Add the enemies
-	m_enemies.push_back(new Enemy(3.5f, -3.0f, 0.4f, 0.55f, m_world, "Assets/Sprites/pig.png"));
+	const LevelHeader& header = file.GetHeader();
+	const LevelEntity* entities = file.GetEntities();
 
+	// The object created for each entity, so attachments can find them by index
+	std::vector<GameObject*> objects(header.entityCount, (GameObject*)0);
 
-	// Misc objects (Spring)
-	m_spring = new Spring(1.5f, -2.9f, m_world, m_ground);
+	for (unsigned int i = 0; i < header.entityCount; ++i)
+	{
+		const LevelEntity& entity = entities[i];
+		switch (entity.type)
+		{
+		case LEVEL_BIRD:
+		{
+			AddBirdObj(entity.x, entity.y, (BirdType)entity.variant);
+			objects[i] = m_birds.Back();
+		}
+		break;
+		case LEVEL_CONSTRUCT:
+		{
+			objects[i] = m_constructs.Add(new (m_constructs.Allocate()) Construct(entity.x, entity.y, m_world, (ConstructType)entity.variant, entity.angle));
+		}
+		break;
+		case LEVEL_ENEMY:
+		{
+			objects[i] = m_enemies.Add(new (m_enemies.Allocate()) Enemy(entity.x, entity.y, entity.width, entity.height, m_world, "Assets/Sprites/pig.png"));
+		}
+		break;
+		case LEVEL_SPRING:
+		{
+			m_springs.push_back(new Spring(entity.x, entity.y, m_world, m_ground));
+			objects[i] = m_springs.back();
+		}
+		break;
+		default: break;
+		}
+	}
 
+	const LevelAttachment* attachments = file.GetAttachments();
+	for (unsigned int i = 0; i < header.attachmentCount; ++i)
+	{
+		const LevelAttachment& attachment = attachments[i];
+		if (attachment.type != LEVEL_ROPE)
+			continue;
+
+		// Ropes can only hang from constructs
+		GameObject* fix = objects[attachment.entityA];
+		GameObject* fix2 = (attachment.entityB != LEVEL_NO_ENTITY) ? objects[attachment.entityB] : 0;
+		if (fix == 0 || fix->GetType() != CONSTRUCT || (fix2 != 0 && fix2->GetType() != CONSTRUCT))
+		{
+			std::cerr << "Level file " << path << " has a rope that isn't attached to a construct" << std::endl;
+			continue;
+		}
+		m_ropes.push_back(new Rope(attachment.x, attachment.y, m_world, attachment.length, static_cast<Construct*>(fix), static_cast<Construct*>(fix2)));
+	}
 
 	// Update the 'birds left' text in the HUD
-	HUD::GetInstance().UpdateBirdsLeftText(m_birds.size());
+	ShowBirdsLeft(m_birds.Size());
+	return true;
 }
 
 /*
@@ -184,158 +209,135 @@ void GameScene::SetupLevel3()
 */
 void GameScene::GoToNextLevel(bool isSameLevel, GameState& state)
 {
-	// Reset the game scene by deleting game objects
-	Reset();
+	// If isSameLevel is true, reset the same level instead
+	int level = isSameLevel ? m_currentLevel : m_currentLevel + 1;
 
-	// Go to a new level based on the current level
-	switch (m_currentLevel)
-	{
-	case 1:
-	{
-		if (isSameLevel)
-			// If this variable is true, reset the same level instead
-			SetupLevel1();
-		else
-			SetupLevel2();
-	}
-	break;
-	case 2:
-	{
-		if (isSameLevel)
-			SetupLevel2();
-		else
-			SetupLevel3();
-	}
-	break;
-	case 3:
-	{
-		if (isSameLevel)
-			SetupLevel3();
-		else
-			state = MENU;
-	}
-	break;
-	default:
-	{
-		// By default return to the menu
+	// Return to the menu after the last level
+	if (!LoadLevel(level))
 		state = MENU;
-	}
-	break;
-	}
 }
 
 /*
-*	Updates all game objects in the scene
-*	Parameters - the window, the current game time, and the main game state
+*	Updates all game objects in the scene and steps the physics world
+*	Parameters - the time since the last update, and the main game state
 *	Return - void
 */
-void GameScene::Update(GLFWwindow* window, float time, GameState& state)
+void GameScene::Update(float time, GameState& state)
 {
+	// Step the physics world at a fixed rate, however long the frame took
+	m_accumulator += time;
 
+	// Drop time we can't catch up on, so a long stall doesn't keep the following frames stepping
+	if (m_accumulator > MAX_PHYSICS_STEPS * PHYSICS_TIMESTEP)
+		m_accumulator = MAX_PHYSICS_STEPS * PHYSICS_TIMESTEP;
 
-	// Update all game objects
-	for (std::vector<Construct*>::iterator it = m_constructs.begin(); it != m_constructs.end();)
+	while (m_accumulator >= PHYSICS_TIMESTEP)
 	{
-		(*it)->Update(time);
-		if ((*it)->IsAlive())
-			// If the object is alive, advance the iterator
-			++it;
-		else
-		{
-			// delete the bird if it's not alive
-			m_world->DestroyBody((*it)->GetBody());
-			delete (*it);
-			(*it) = 0;
-			it = m_constructs.erase(it);
-		}
-	}
+		StorePreviousTransforms();
+		m_world->Step(PHYSICS_TIMESTEP, 8, 3);
+		++m_stepCount;
 
-	for (std::vector<BirdObj*>::iterator it = m_birds.begin(); it != m_birds.end();)
-	{
-		(*it)->Update(time);
-		if ((*it)->IsAlive())
-			// If the object is alive, advance the iterator
-			++it;
-		else
-		{
-			// delete the bird if it's not alive
-			m_world->DestroyBody((*it)->GetBody());
-			delete (*it);
-			(*it) = 0;
-			it = m_birds.erase(it);
-		}
-	}
+		// Run the game logic for the contacts of the step, then update all game objects, splitting off the ones that died
+		m_contactListener.DispatchEvents();
+		UpdateEntities(m_constructs, PHYSICS_TIMESTEP, false);
+		UpdateEntities(m_birds, PHYSICS_TIMESTEP, true);
+		UpdateEntities(m_enemies, PHYSICS_TIMESTEP, false);
+		UpdateEntities(m_splitterBirds, PHYSICS_TIMESTEP, false);
 
-	for (std::vector<Enemy*>::iterator it = m_enemies.begin(); it != m_enemies.end();)
-	{
-		(*it)->Update(time);
-		if ((*it)->IsAlive())
-			// If the object is alive, advance the iterator
-			++it;
-		else
-		{
-			// delete the enemy if it's not alive
-			m_world->DestroyBody((*it)->GetBody());
-			delete (*it);
-			(*it) = 0;
-			it = m_enemies.erase(it);
-		}
-	}
+		// Destroy the broken joints and the bodies of the dead objects before the world steps again
+		FlushDestructionQueue();
 
-	for (std::vector<BirdObj*>::iterator it = m_splitterBirds.begin(); it != m_splitterBirds.end();)
-	{
-		(*it)->Update(time);
-		if ((*it)->IsAlive())
-			// If the object is alive, advance the iterator
-			++it;
-		else
-		{
-			// delete the enemy if it's not alive
-			m_world->DestroyBody((*it)->GetBody());
-			delete (*it);
-			(*it) = 0;
-			it = m_splitterBirds.erase(it);
-		}
+		m_accumulator -= PHYSICS_TIMESTEP;
 	}
 
-	// Press the space bar to activate the bird
-	if (glfwGetKey(window, GLFW_KEY_SPACE) && !m_birds.empty())
-		m_birds.front()->Ability();
+	// Check win and lose conditions
+	if (m_enemies.Empty())
+		m_isGameOver = 1;
+	if (!m_enemies.Empty() && m_birds.Empty())
+		m_isGameOver = 2;
 
-	// Update the joint def
-	if (m_mouseJoint != 0)
-	{
-		double x, y;
-		glfwGetCursorPos(window, &x, &y);
-		float posX = ((float)x / (WINDOW_WIDTH / (UNITSTOMETERS * 2))) - UNITSTOMETERS;
-		float posY = ((UNITSTOMETERS * 2) - ((float)y / (WINDOW_HEIGHT / (UNITSTOMETERS * 2)))) - UNITSTOMETERS;
+	// Render the bodies part way between the last two steps by the time left over
+	GameObject::SetInterpolation(m_accumulator / PHYSICS_TIMESTEP);
+}
 
-		b2Vec2 vec = b2Vec2(posX, posY) - m_slingshotStart;
-		if (vec.Length() > 1.0f)
+/*
+*	Updates every object in a store, and removes the dead ones and queues their bodies for destruction
+*	Parameters - the store, the time since the last update, and whether the order of the store matters
+*	Return - void
+*/
+template <class T>
+void GameScene::UpdateEntities(EntityStore<T>& store, float time, bool keepOrder)
+{
+	for (size_t i = 0; i < store.Size();)
+	{
+		T* object = store[i];
+		object->Update(time);
+		if (object->IsAlive())
 		{
-			vec.Normalize();
-			b2Vec2 v = (vec + m_slingshotStart);
-			m_mouseJoint->SetTarget(b2Vec2(v.x / ((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH), v.y));
+			// If the object is alive, move to the next one
+			++i;
+			continue;
 		}
+
+		// The object is recycled once its body is gone, the object moved into this slot is updated next
+		m_destroyBodies.push_back(object->GetBody());
+		if (keepOrder)
+			store.OrderedRemove(i);
 		else
-			m_mouseJoint->SetTarget(b2Vec2(posX / ((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH), posY));
+			store.SwapRemove(i);
 	}
+}
 
-	// Check win and lose conditions
-	if (m_enemies.empty())
-		m_isGameOver = 1;
-	if (!m_enemies.empty() && m_birds.empty())
-		m_isGameOver = 2;
+/*
+*	Destroys all queued joints and bodies, then recycles the objects that owned the bodies
+*	Parameters - none
+*	Return - void
+*/
+void GameScene::FlushDestructionQueue()
+{
+	if (m_destroyJoints.empty() && m_destroyBodies.empty())
+		return;
+
+	// Joints go first, as destroying a body also destroys its joints. A joint can be queued more than once
+	std::sort(m_destroyJoints.begin(), m_destroyJoints.end());
+	m_destroyJoints.erase(std::unique(m_destroyJoints.begin(), m_destroyJoints.end()), m_destroyJoints.end());
+	for (std::vector<b2Joint*>::iterator it = m_destroyJoints.begin(); it != m_destroyJoints.end(); ++it)
+		m_world->DestroyJoint(*it);
+	m_destroyJoints.clear();
 
-	// Update the physics world
-	m_world->Step(1.0f / 60.0f, 8, 3);
+	for (std::vector<b2Body*>::iterator it = m_destroyBodies.begin(); it != m_destroyBodies.end(); ++it)
+		m_world->DestroyBody(*it);
+	m_destroyBodies.clear();
 
-	// Destroy the joints that need to be destroyed
-	if (!m_destroyJoints.empty())
-		m_world->DestroyJoint(m_destroyJoints.front());
-	m_destroyJoints.clear();
+	// Nothing refers to the removed objects any more
+	m_constructs.RecycleRemoved();
+	m_birds.RecycleRemoved();
+	m_enemies.RecycleRemoved();
+	m_splitterBirds.RecycleRemoved();
+}
+
+/*
+*	Saves the body transform of every physics object before a physics step, for render interpolation
+*	Parameters - none
+*	Return - void
+*/
+void GameScene::StorePreviousTransforms()
+{
+	for (EntityStore<BirdObj>::iterator it = m_birds.begin(); it != m_birds.end(); ++it)
+		(*it)->StorePreviousTransform();
+	for (EntityStore<Enemy>::iterator it = m_enemies.begin(); it != m_enemies.end(); ++it)
+		(*it)->StorePreviousTransform();
+	for (EntityStore<Construct>::iterator it = m_constructs.begin(); it != m_constructs.end(); ++it)
+		(*it)->StorePreviousTransform();
+	for (EntityStore<BirdObj>::iterator it = m_splitterBirds.begin(); it != m_splitterBirds.end(); ++it)
+		(*it)->StorePreviousTransform();
+	for (std::vector<Rope*>::iterator it = m_ropes.begin(); it != m_ropes.end(); ++it)
+		(*it)->StorePreviousTransforms();
+	for (std::vector<Spring*>::iterator it = m_springs.begin(); it != m_springs.end(); ++it)
+		(*it)->StorePreviousTransform();
 }
 
+#ifndef HEADLESS
 /*
 *	Renders all objects in the scene
 *	Parameters - the window
@@ -347,30 +349,46 @@ void GameScene::Render(GLFWwindow* window)
 	glClearColor(0, 0, 0, 1);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	// Render the background
+	SpriteBatch& spriteBatch = SpriteBatch::GetInstance();
+
+	// Queue the background
+	spriteBatch.SetLayer(LAYER_BACKGROUND);
 	m_background->Render();
 
-	// Render all game objects
+	// Queue all game objects, layered around the slingshot
+	spriteBatch.SetLayer(LAYER_BACK);
 	m_slingshotBack->Render();
 
+	spriteBatch.SetLayer(LAYER_BIRD);
+	if (!m_birds.Empty())
+		m_birds.Front()->Render();
 
-	if (!m_birds.empty())
-		m_birds.front()->Render();
-	for (std::vector<Enemy*>::iterator it = m_enemies.begin(); it != m_enemies.end(); ++it)
+	spriteBatch.SetLayer(LAYER_ENEMIES);
+	for (EntityStore<Enemy>::iterator it = m_enemies.begin(); it != m_enemies.end(); ++it)
 		(*it)->Render();
-	for (std::vector<Construct*>::iterator it = m_constructs.begin(); it != m_constructs.end(); ++it)
+
+	// Constructs only touch at their edges, so the planks of each material can be drawn together
+	spriteBatch.SetLayer(LAYER_CONSTRUCTS, true);
+	for (EntityStore<Construct>::iterator it = m_constructs.begin(); it != m_constructs.end(); ++it)
 		(*it)->Render();
-	for (std::vector<BirdObj*>::iterator it = m_splitterBirds.begin(); it != m_splitterBirds.end(); ++it)
+
+	spriteBatch.SetLayer(LAYER_SPLITTER_BIRDS);
+	for (EntityStore<BirdObj>::iterator it = m_splitterBirds.begin(); it != m_splitterBirds.end(); ++it)
 		(*it)->Render();
 
+	spriteBatch.SetLayer(LAYER_FRONT);
 	m_slingshotFore->Render();
 
+	// Draw the queued sprites
+	spriteBatch.Flush();
+
 	// Render the HUD
 	HUD::GetInstance().Render();
 
 	// Swap the display buffers (displays what was just drawn)
 	glfwSwapBuffers(window);
 }
+#endif
 
 /*
 *	Deletes all physics bodies and objects in the scene
@@ -379,46 +397,56 @@ void GameScene::Render(GLFWwindow* window)
 */
 void GameScene::Reset()
 {
-	// Clear all the vectors of objects
-	for (std::vector<BirdObj*>::iterator it = m_birds.begin(); it != m_birds.end(); ++it)
-	{
-		// Deleting physics objects and their container objects
-		m_world->DestroyBody((*it)->GetBody());
-		delete (*it);
-		(*it) = 0;
-	}
-	m_birds.clear();
-
-	for (std::vector<Enemy*>::iterator it = m_enemies.begin(); it != m_enemies.end(); ++it)
+	if (m_world != 0)
 	{
-		m_world->DestroyBody((*it)->GetBody());
-		delete (*it);
-		(*it) = 0;
-	}
-	m_enemies.clear();
+		// Clearing the world frees every body and joint at once, so the queued ones are already gone
+		m_destroyJoints.clear();
+		m_destroyBodies.clear();
+
+		// The objects don't touch their bodies when destroyed, so they are removed and recycled straight away
+		m_birds.RemoveAll();
+		m_enemies.RemoveAll();
+		m_constructs.RemoveAll();
+		m_splitterBirds.RemoveAll();
+		m_constructs.RecycleRemoved();
+		m_birds.RecycleRemoved();
+		m_enemies.RecycleRemoved();
+		m_splitterBirds.RecycleRemoved();
+
+		// The links are freed with the world, rather than destroyed one body at a time by the rope
+		for (std::vector<Rope*>::iterator it = m_ropes.begin(); it != m_ropes.end(); ++it)
+		{
+			(*it)->ReleaseLinks();
+			delete (*it);
+			(*it) = 0;
+		}
+		m_ropes.clear();
 
-	for (std::vector<Construct*>::iterator it = m_constructs.begin(); it != m_constructs.end(); ++it)
-	{
-		m_world->DestroyBody((*it)->GetBody());
-		delete (*it);
-		(*it) = 0;
-	}
-	m_constructs.clear();
+		for (std::vector<Spring*>::iterator it = m_springs.begin(); it != m_springs.end(); ++it)
+		{
+			delete (*it);
+			(*it) = 0;
+		}
+		m_springs.clear();
 
-	for (std::vector<BirdObj*>::iterator it = m_splitterBirds.begin(); it != m_splitterBirds.end(); ++it)
-	{
-		m_world->DestroyBody((*it)->GetBody());
-		delete (*it);
-		(*it) = 0;
+		// Free all of the physics bodies, joints and contacts together, then put the ground back
+		m_world->Clear();
+		m_mouseJoint = 0;
+		CreateGround();
 	}
-	m_splitterBirds.clear();
 
-	// Reset the score for the HUD
+	// Reset the score
+	m_score = 0;
+#ifndef HEADLESS
 	HUD::GetInstance().ResetScore();
-	HUD::GetInstance().UpdateBirdsLeftText(m_birds.size());
+#endif
+	ShowBirdsLeft(m_birds.Size());
 
 	// Reset the isGameOver variable
 	m_isGameOver = 0;
+
+	// Start the new level without any leftover frame time
+	m_accumulator = 0.0f;
 }
 
 /*
@@ -443,7 +471,7 @@ void GameScene::AddBirdObj(float posX, float posY, BirdType type)
 		filePath = "Assets/Sprites/bird.png";
 		break;
 	}
-	m_birds.push_back(new BirdObj(posX, posY, 1.0f, 1.0f, m_world, filePath, type));
+	m_birds.Add(new (m_birds.Allocate()) BirdObj(posX, posY, 1.0f, 1.0f, m_world, filePath, type));
 }
 
 /*
@@ -454,22 +482,22 @@ void GameScene::AddBirdObj(float posX, float posY, BirdType type)
 void GameScene::AddSplitterBirds(BirdObj* splitter)
 {
 	// Add two new birds that split off from a given bird
-	m_splitterBirds.push_back(new BirdObj(splitter->GetBody()->GetPosition().x * ((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH) + 0.05f, splitter->GetBody()->GetPosition().y, 0.7f, 0.7f, m_world, "Assets/Sprites/birdsplitter.png", SPLITTER));
+	m_splitterBirds.Add(new (m_splitterBirds.Allocate()) BirdObj(splitter->GetBody()->GetPosition().x * ((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH) + 0.05f, splitter->GetBody()->GetPosition().y, 0.7f, 0.7f, m_world, "Assets/Sprites/birdsplitter.png", SPLITTER));
 	
 	// Activate the new birds, and set the physics to the same as the original
-	m_splitterBirds.back()->Activate();
-	m_splitterBirds.back()->CopyVariables(*splitter);
+	m_splitterBirds.Back()->Activate();
+	m_splitterBirds.Back()->CopyVariables(*splitter);
 	
 	// Split effect achieved by altering the velocity a little bit
-	m_splitterBirds.back()->GetBody()->SetLinearVelocity(splitter->GetBody()->GetLinearVelocity() + b2Vec2(1.0f, 0.0f));
-	m_splitterBirds.back()->GetBody()->SetAngularVelocity(-splitter->GetBody()->GetAngularVelocity());
+	m_splitterBirds.Back()->GetBody()->SetLinearVelocity(splitter->GetBody()->GetLinearVelocity() + b2Vec2(1.0f, 0.0f));
+	m_splitterBirds.Back()->GetBody()->SetAngularVelocity(-splitter->GetBody()->GetAngularVelocity());
 
 	// Repeat with a second bird
-	m_splitterBirds.push_back(new BirdObj(splitter->GetBody()->GetPosition().x * ((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH) - 0.05f, splitter->GetBody()->GetPosition().y, 0.7f, 0.7f, m_world, "Assets/Sprites/birdsplitter.png", SPLITTER));
-	m_splitterBirds.back()->Activate();
-	m_splitterBirds.back()->CopyVariables(*splitter);
-	m_splitterBirds.back()->GetBody()->SetLinearVelocity(splitter->GetBody()->GetLinearVelocity() + b2Vec2(-1.0f, 0.0f));
-	m_splitterBirds.back()->GetBody()->SetAngularVelocity(-splitter->GetBody()->GetAngularVelocity());
+	m_splitterBirds.Add(new (m_splitterBirds.Allocate()) BirdObj(splitter->GetBody()->GetPosition().x * ((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH) - 0.05f, splitter->GetBody()->GetPosition().y, 0.7f, 0.7f, m_world, "Assets/Sprites/birdsplitter.png", SPLITTER));
+	m_splitterBirds.Back()->Activate();
+	m_splitterBirds.Back()->CopyVariables(*splitter);
+	m_splitterBirds.Back()->GetBody()->SetLinearVelocity(splitter->GetBody()->GetLinearVelocity() + b2Vec2(-1.0f, 0.0f));
+	m_splitterBirds.Back()->GetBody()->SetAngularVelocity(-splitter->GetBody()->GetAngularVelocity());
 }
 
 /*
@@ -480,18 +508,18 @@ void GameScene::AddSplitterBirds(BirdObj* splitter)
 void GameScene::CreateMouseJoint(float posX, float posY)
 {
 	// If the mouse joint is not null and there are birds left
-	if (m_mouseJoint == 0 && !m_birds.empty())
+	if (m_mouseJoint == 0 && !m_birds.Empty())
 	{
 		// If the front bird is clicked on and is not yet launched
-		if (m_birds.front()->IsMouseHit(posX, posY) && !m_birds.front()->IsLaunched())
+		if (m_birds.Front()->IsMouseHit(posX, posY) && !m_birds.Front()->IsLaunched())
 		{
 			// Activate the physics body of the object
-			m_birds.front()->Activate();
+			m_birds.Front()->Activate();
 
 			// Create a mosue joint def and adjust settings
 			b2MouseJointDef mouseJointDef;
 			mouseJointDef.bodyA = m_ground;
-			mouseJointDef.bodyB = m_birds.front()->GetBody();
+			mouseJointDef.bodyB = m_birds.Front()->GetBody();
 			mouseJointDef.target = b2Vec2(posX / ((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH), posY);
 			mouseJointDef.collideConnected = true;
 			mouseJointDef.maxForce = 10000;
@@ -521,30 +549,104 @@ void GameScene::ReleaseMouseJoint(float posX, float posY)
 		m_mouseJoint = 0;
 
 		// Launch the ball with the slingshot
-		b2Vec2 vec = (m_slingshotStart - b2Vec2(posX, posY));
-		if (vec.Length() > 5.0f)
-			// restrict the velocity of the launch
-			vec.Normalize();
+		LaunchFrontBird(b, m_slingshotStart - b2Vec2(posX, posY));
+	}
+}
 
-		vec *= 6.4f;
-		b->ApplyLinearImpulse(vec, b->GetPosition(), true);
-		BirdObj* current = static_cast<BirdObj*>(b->GetUserData());
-		current->Launch();
-		HUD::GetInstance().UpdateBirdsLeftText(m_birds.size() - 1);
+/*
+*	Moves the mouse joint target towards the mouse, keeping it within reach of the slingshot
+*	Parameters - mouse coordinates
+*	Return - void
+*/
+void GameScene::MoveMouseJoint(float posX, float posY)
+{
+	// Update the joint def
+	if (m_mouseJoint != 0)
+	{
+		b2Vec2 vec = b2Vec2(posX, posY) - m_slingshotStart;
+		if (vec.Length() > 1.0f)
+		{
+			vec.Normalize();
+			b2Vec2 v = (vec + m_slingshotStart);
+			m_mouseJoint->SetTarget(b2Vec2(v.x / ((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH), v.y));
+		}
+		else
+			m_mouseJoint->SetTarget(b2Vec2(posX / ((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH), posY));
 	}
 }
 
+/*
+*	Launches the front bird straight from the slingshot without dragging it, used by scripted launches
+*	Parameters - how far the slingshot is pulled back, in the same units as the mouse coordinates
+*	Return - whether there was a bird ready to launch
+*/
+bool GameScene::LaunchBird(b2Vec2 pull)
+{
+	if (m_mouseJoint != 0 || m_birds.Empty() || m_birds.Front()->IsLaunched())
+		return false;
+
+	m_birds.Front()->Activate();
+	LaunchFrontBird(m_birds.Front()->GetBody(), pull);
+	return true;
+}
 
 /*
-*	returns the chain object
+*	Applies the slingshot impulse to a bird and starts its alive timer
+*	Parameters - the body of the bird, and how far the slingshot was pulled back
+*	Return - void
+*/
+void GameScene::LaunchFrontBird(b2Body* body, b2Vec2 pull)
+{
+	if (pull.Length() > 5.0f)
+		// restrict the velocity of the launch
+		pull.Normalize();
+
+	pull *= 6.4f;
+	body->ApplyLinearImpulse(pull, body->GetPosition(), true);
+	BirdObj* current = static_cast<BirdObj*>(body->GetUserData());
+	current->Launch();
+	ShowBirdsLeft(m_birds.Size() - 1);
+}
+
+/*
+*	Activates the ability of the bird in flight
 *	Parameters - none
-*	Return - Chain pointer
+*	Return - void
+*/
+void GameScene::UseAbility()
+{
+	if (!m_birds.Empty())
+		m_birds.Front()->Ability();
+}
+
+/*
+*	Adds to the score of the level, and to the score shown by the HUD
+*	Parameters - the points to add
+*	Return - void
+*/
+void GameScene::AddScore(int score)
+{
+	m_score += score;
+#ifndef HEADLESS
+	HUD::GetInstance().AddScoreText(score);
+#endif
+}
+
+/*
+*	Updates the 'birds left' text in the HUD, the headless build has no HUD
+*	Parameters - the number of birds left
+*	Return - void
 */
-Rope* GameScene::GetRope()
+void GameScene::ShowBirdsLeft(unsigned birdsLeft)
 {
-	return m_rope;
+#ifndef HEADLESS
+	HUD::GetInstance().UpdateBirdsLeftText(birdsLeft);
+#else
+	B2_NOT_USED(birdsLeft);
+#endif
 }
 
+
 /*
 *	Return whether the game is over, won, or lost
 *	Parameters - none
@@ -555,6 +657,46 @@ unsigned GameScene::GetIsGameOver()
 	return m_isGameOver;
 }
 
+/*
+*	Returns the score of the current level
+*	Parameters - none
+*	Return - int score
+*/
+int GameScene::GetScore()
+{
+	return m_score;
+}
+
+/*
+*	Returns the number of physics steps taken since the world was created
+*	Parameters - none
+*	Return - unsigned step count
+*/
+unsigned GameScene::GetStepCount()
+{
+	return m_stepCount;
+}
+
+/*
+*	Returns the number of birds that have not been used up yet, including the one in flight
+*	Parameters - none
+*	Return - unsigned number of birds
+*/
+unsigned GameScene::GetBirdsLeft()
+{
+	return m_birds.Size();
+}
+
+/*
+*	Returns the number of contact events dropped because the contact listener's buffer was full
+*	Parameters - none
+*	Return - unsigned number of events
+*/
+unsigned GameScene::GetDroppedContactEvents()
+{
+	return m_contactListener.GetDroppedEventCount();
+}
+
 
 
 /*
@@ -6,15 +6,22 @@
 
 // Local includes
 #include "utils.h"
+#include "entitystore.h"
 #include "bird-obj.h"
-#include "background.h"
 #include "enemy.h"
 #include "construct.h"
-#include "textlabel.h"
 #include "rope.h"
 #include "ropelink.h"
 #include "spring.h"
+#include "contactlistener.h"
+#ifndef HEADLESS
+#include "background.h"
+#include "textlabel.h"
+#endif
 
+// Constants
+#define PHYSICS_TIMESTEP (1.0f / 60.0f)
+#define MAX_PHYSICS_STEPS 5
 
 class GameScene
 {
@@ -26,26 +33,33 @@ public:
 	static void DestroyInstance();
 
 	void InitialiseWorld();
-	void Update(GLFWwindow* window, float time, GameState& state);
+	void Update(float time, GameState& state);
+#ifndef HEADLESS
 	void Render(GLFWwindow* window);
+#endif
 	void Reset();
 
-	void SetupLevel1();
-	void SetupLevel2();
-	void SetupLevel3();
+	bool LoadLevel(int level);
+	bool LoadLevelFile(const std::string& path);
 	void GoToNextLevel(bool isSameLevel, GameState& state);
 
 	void AddSplitterBirds(BirdObj* splitter);
 	void AddBirdObj(float posX, float posY, BirdType type);
 	void CreateMouseJoint(float posX, float posY);
+	void MoveMouseJoint(float posX, float posY);
 	void ReleaseMouseJoint(float posX, float posY);
+	bool LaunchBird(b2Vec2 pull);
+	void UseAbility();
+	void AddScore(int score);
 
 	unsigned GetIsGameOver();
+	int GetScore();
+	unsigned GetStepCount();
+	unsigned GetBirdsLeft();
+	unsigned GetDroppedContactEvents();
 
 	void SetDestroyJoint(b2Joint*);
 
-	Rope* GetRope();
-
 private:
 
 	// Private methods
@@ -53,29 +67,45 @@ private:
 	GameScene(const GameScene& other);
 	GameScene& operator= (const GameScene& other);
 
+	void CreateGround();
+	void StorePreviousTransforms();
+	template <class T> void UpdateEntities(EntityStore<T>& store, float time, bool keepOrder);
+	void FlushDestructionQueue();
+	void LaunchFrontBird(b2Body* body, b2Vec2 pull);
+	void ShowBirdsLeft(unsigned birdsLeft);
+
 	// Game objects
-	std::vector<BirdObj*> m_birds;
-	std::vector<BirdObj*> m_splitterBirds;
-	std::vector<Enemy*> m_enemies;
-	std::vector<Construct*> m_constructs;
+	EntityStore<BirdObj> m_birds;
+	EntityStore<BirdObj> m_splitterBirds;
+	EntityStore<Enemy> m_enemies;
+	EntityStore<Construct> m_constructs;
+#ifndef HEADLESS
 	GameObject* m_slingshotFore;
 	GameObject* m_slingshotBack;
 	Background* m_background;
+#endif
 	unsigned m_isGameOver;
+	int m_score;
 
-	Rope* m_rope;
-	Spring* m_spring;
+	std::vector<Rope*> m_ropes;
+	std::vector<Spring*> m_springs;
 
+	// Destroyed together after the physics step
 	std::vector<b2Joint*> m_destroyJoints;
+	std::vector<b2Body*> m_destroyBodies;
 
 	int m_currentLevel;
 
 	// Physics variables
 	b2World* m_world;
+	ContactListener m_contactListener;
 	b2Body* m_ground;
 	b2MouseJoint* m_mouseJoint;
 	b2Vec2 m_slingshotStart;
-	
+
+	// Frame time not yet simulated, always less than one physics step after an update
+	float m_accumulator;
+	unsigned m_stepCount;
 
 	// Singleton Instance
 	static GameScene* m_gameScene;
@@ -0,0 +1,144 @@
+
+// Local includes
+#include "utils.h"
+#include "gamescene.h"
+
+// Library includes
+#include <chrono>
+#include <fstream>
+#include <vector>
+#include <cstdlib>
+
+// Constants
+#define DEFAULT_MAX_STEPS 7200
+
+// A scripted slingshot launch
+struct ScriptedLaunch
+{
+	// Seconds of game time to wait after the previous launch, or after the level starts
+	float wait;
+	// How far the slingshot is pulled back, in the same units as the mouse coordinates
+	b2Vec2 pull;
+	// Seconds after the launch to use the bird's ability, negative to never use it
+	float abilityDelay;
+};
+
+/*
+*	Reads the launch script, one launch per line as "wait pullX pullY [abilityDelay]". Lines starting with # are comments
+*	Parameters - file path of the script, the vector to fill with launches
+*	Return - whether the script could be read
+*/
+bool LoadLaunchScript(const char* path, std::vector<ScriptedLaunch>& launches)
+{
+	std::ifstream file(path);
+	if (!file)
+		return false;
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		std::istringstream stream(line);
+		ScriptedLaunch launch;
+		launch.abilityDelay = -1.0f;
+		if (!(stream >> launch.wait >> launch.pull.x >> launch.pull.y))
+		{
+			std::cerr << "Skipping bad launch line: " << line << std::endl;
+			continue;
+		}
+		stream >> launch.abilityDelay;
+		launches.push_back(launch);
+	}
+	return true;
+}
+
+/*
+*	Loads a level, applies the scripted launches and steps until the level is won, lost, or runs out of steps
+*	Parameters - level number or level file, launch script path, and optionally the maximum number of steps
+*	Return - int
+*/
+int main(int argc, char *argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: angrybirds_headless <level number or .lvl file> [launch script] [max steps]" << std::endl;
+		return 1;
+	}
+
+	std::string level = argv[1];
+	std::vector<ScriptedLaunch> launches;
+	if (argc > 2 && !LoadLaunchScript(argv[2], launches))
+	{
+		std::cerr << "Could not read launch script " << argv[2] << std::endl;
+		return 1;
+	}
+	unsigned maxSteps = (argc > 3) ? (unsigned)atoi(argv[3]) : DEFAULT_MAX_STEPS;
+
+	GameScene& gameScene = GameScene::GetInstance();
+	gameScene.InitialiseWorld();
+	// A number loads from the levels folder, anything else is a path to a level file
+	bool isLevelNumber = level.find_first_not_of("0123456789") == std::string::npos;
+	if (isLevelNumber ? !gameScene.LoadLevel(atoi(level.c_str())) : !gameScene.LoadLevelFile(level))
+	{
+		std::cerr << "Could not load level " << level << std::endl;
+		GameScene::DestroyInstance();
+		return 1;
+	}
+
+	GameState state = GAME;
+	size_t nextLaunch = 0;
+	float sinceLastLaunch = 0.0f;
+	float abilityTimer = -1.0f;
+	unsigned startStep = gameScene.GetStepCount();
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	// Every update is exactly one physics step, so the run is the same however fast the machine is
+	while (gameScene.GetIsGameOver() == 0 && gameScene.GetStepCount() - startStep < maxSteps)
+	{
+		sinceLastLaunch += PHYSICS_TIMESTEP;
+
+		// Launch as soon as the wait is over and the next bird is on the slingshot
+		if (nextLaunch < launches.size() && sinceLastLaunch >= launches[nextLaunch].wait &&
+			gameScene.LaunchBird(launches[nextLaunch].pull))
+		{
+			abilityTimer = launches[nextLaunch].abilityDelay;
+			sinceLastLaunch = 0.0f;
+			++nextLaunch;
+		}
+		else if (abilityTimer >= 0.0f)
+		{
+			abilityTimer -= PHYSICS_TIMESTEP;
+			if (abilityTimer < 0.0f)
+				gameScene.UseAbility();
+		}
+
+		gameScene.Update(PHYSICS_TIMESTEP, state);
+	}
+
+	double wallSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	unsigned steps = gameScene.GetStepCount() - startStep;
+
+	// Report the result of the run
+	const char* result = "unfinished";
+	if (gameScene.GetIsGameOver() == 1)
+		result = "won";
+	else if (gameScene.GetIsGameOver() == 2)
+		result = "lost";
+
+	std::cout << "Level " << level << ": " << result << std::endl;
+	std::cout << "Score: " << gameScene.GetScore() << std::endl;
+	std::cout << "Launches: " << nextLaunch << " of " << launches.size() << std::endl;
+	std::cout << "Birds left: " << gameScene.GetBirdsLeft() << std::endl;
+	std::cout << "Dropped contact events: " << gameScene.GetDroppedContactEvents() << std::endl;
+	std::cout << "Steps: " << steps << " (" << steps * PHYSICS_TIMESTEP << " s of game time)" << std::endl;
+	std::cout << "Wall time: " << wallSeconds * 1000.0 << " ms";
+	if (wallSeconds > 0.0)
+		std::cout << " (" << steps / wallSeconds << " steps/s)";
+	std::cout << std::endl;
+
+	GameScene::DestroyInstance();
+	return 0;
+}
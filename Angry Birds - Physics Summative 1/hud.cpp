@@ -68,12 +68,16 @@ void HUD::Initialise()
 */
 void HUD::Render()
 {
-	// Render all HUD items
-	m_scoreText->Render();
-	m_birdsLeftText->Render();
+	// Draw the HUD images first so the text sits on top
+	SpriteBatch::GetInstance().SetLayer(LAYER_HUD);
 	m_birdImage->Render();
 	m_exit->Render();
 	m_restart->Render();
+	SpriteBatch::GetInstance().Flush();
+
+	// Render all HUD text
+	m_scoreText->Render();
+	m_birdsLeftText->Render();
 
 	// If the game is over, display correct message
 	if (GameScene::GetInstance().GetIsGameOver() == 1)
@@ -0,0 +1,27 @@
+
+// Local includes
+#include "levelfile.h"
+
+/*
+*	Converts level text files to binary level files
+*	Parameters - pairs of text file and binary file paths
+*	Return - int
+*/
+int main(int argc, char *argv[])
+{
+	if (argc < 3 || (argc - 1) % 2 != 0)
+	{
+		std::cerr << "Usage: levelconvert <level.txt> <level.lvl> [<level.txt> <level.lvl> ...]" << std::endl;
+		return 1;
+	}
+
+	int failed = 0;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (LevelFile::ConvertText(argv[i], argv[i + 1]))
+			std::cout << argv[i] << " -> " << argv[i + 1] << std::endl;
+		else
+			++failed;
+	}
+	return failed == 0 ? 0 : 1;
+}
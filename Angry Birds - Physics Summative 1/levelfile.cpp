@@ -0,0 +1,399 @@
+
+// This include
+#include "levelfile.h"
+
+// Local includes
+#include "bird-obj.h"
+#include "construct.h"
+
+// Library includes
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(LevelHeader) == 16 && sizeof(LevelEntity) == 28 && sizeof(LevelAttachment) == 24,
+	"Level records must match the file layout");
+
+// Type names used in level text files
+struct VariantName
+{
+	const char* name;
+	unsigned int value;
+};
+
+static const VariantName s_birdTypes[] = {
+	{ "CLASSIC", CLASSIC },
+	{ "BOMBER", BOMBER },
+	{ "SPLITTER", SPLITTER },
+};
+
+static const VariantName s_constructTypes[] = {
+	{ "INDESTRUCTIBLE_PLANK", INDESTRUCTIBLE_PLANK },
+	{ "DESTRUCTIBLE_PLANK", DESTRUCTIBLE_PLANK },
+	{ "INDESTRUCTIBLE_BLOCK", INDESTRUCTIBLE_BLOCK },
+	{ "DESTRUCTIBLE_BLOCK", DESTRUCTIBLE_BLOCK },
+};
+
+/*
+*	Finds the enum value for a type name used in level text files
+*	Parameters - the type name, the table of names to search and its size, and the value to fill in
+*	Return - whether the name is in the table
+*/
+static bool ParseVariant(const std::string& name, const VariantName* names, size_t count, unsigned int& variant)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (name == names[i].name)
+		{
+			variant = names[i].value;
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+*	Checks that an enum value read from a binary level is in a table of type names
+*	Parameters - the value, and the table of names to search and its size
+*	Return - whether the value is in the table
+*/
+static bool IsVariant(unsigned int variant, const VariantName* names, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (variant == names[i].value)
+			return true;
+	}
+	return false;
+}
+
+/*
+*	LevelFile Constructor - nothing is mapped until Open is called
+*	Parameters - none
+*	Return - none
+*/
+LevelFile::LevelFile() :
+	m_data(0),
+	m_size(0),
+#ifdef _WIN32
+	m_file(INVALID_HANDLE_VALUE),
+	m_mapping(0)
+#else
+	m_file(-1)
+#endif
+{
+
+}
+
+/*
+*	LevelFile Destructor - unmaps the file
+*	Parameters - none
+*	Return - none
+*/
+LevelFile::~LevelFile()
+{
+	Close();
+}
+
+/*
+*	Maps a binary level file into memory and checks that its records fit the file
+*	Parameters - file path of the level
+*	Return - whether the file exists and is a valid level
+*/
+bool LevelFile::Open(const std::string& path)
+{
+	Close();
+
+#ifdef _WIN32
+	m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(m_file, &size) && size.QuadPart > 0)
+	{
+		m_size = (size_t)size.QuadPart;
+		m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (m_mapping != 0)
+			m_data = (const unsigned char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+#else
+	m_file = open(path.c_str(), O_RDONLY);
+	if (m_file < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(m_file, &info) == 0 && info.st_size > 0)
+	{
+		m_size = (size_t)info.st_size;
+		void* data = mmap(0, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+		if (data != MAP_FAILED)
+			m_data = (const unsigned char*)data;
+	}
+#endif
+
+	if (m_data == 0 || !Validate(path))
+	{
+		if (m_data == 0)
+			std::cerr << "Could not map level file " << path << std::endl;
+		Close();
+		return false;
+	}
+	return true;
+}
+
+/*
+*	Unmaps the file and closes it
+*	Parameters - none
+*	Return - void
+*/
+void LevelFile::Close()
+{
+#ifdef _WIN32
+	if (m_data != 0)
+		UnmapViewOfFile(m_data);
+	if (m_mapping != 0)
+		CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+	m_mapping = 0;
+	m_file = INVALID_HANDLE_VALUE;
+#else
+	if (m_data != 0)
+		munmap((void*)m_data, m_size);
+	if (m_file >= 0)
+		close(m_file);
+	m_file = -1;
+#endif
+	m_data = 0;
+	m_size = 0;
+}
+
+/*
+*	Checks the header, that the record counts match the size of the mapped file and that every record is one the game can load
+*	Parameters - file path of the level, for error messages
+*	Return - whether the level is valid
+*/
+bool LevelFile::Validate(const std::string& path) const
+{
+	if (m_size < sizeof(LevelHeader))
+	{
+		std::cerr << "Level file " << path << " is too small" << std::endl;
+		return false;
+	}
+
+	const LevelHeader& header = GetHeader();
+	if (header.magic != LEVEL_MAGIC || header.version != LEVEL_VERSION)
+	{
+		std::cerr << "Level file " << path << " is not a version " << LEVEL_VERSION << " level" << std::endl;
+		return false;
+	}
+
+	// Compare in 64 bits so huge counts in a corrupt header can't wrap around
+	unsigned long long expected = sizeof(LevelHeader) +
+		(unsigned long long)header.entityCount * sizeof(LevelEntity) +
+		(unsigned long long)header.attachmentCount * sizeof(LevelAttachment);
+	if (expected != m_size)
+	{
+		std::cerr << "Level file " << path << " has " << m_size << " bytes, its header needs " << expected << std::endl;
+		return false;
+	}
+
+	// The game casts the variant straight to a BirdType or ConstructType
+	const LevelEntity* entities = GetEntities();
+	for (unsigned int i = 0; i < header.entityCount; ++i)
+	{
+		bool isValid = false;
+		switch (entities[i].type)
+		{
+		case LEVEL_BIRD:
+			isValid = IsVariant(entities[i].variant, s_birdTypes, sizeof(s_birdTypes) / sizeof(s_birdTypes[0]));
+			break;
+		case LEVEL_CONSTRUCT:
+			isValid = IsVariant(entities[i].variant, s_constructTypes, sizeof(s_constructTypes) / sizeof(s_constructTypes[0]));
+			break;
+		case LEVEL_ENEMY:
+		case LEVEL_SPRING:
+			isValid = true;
+			break;
+		default: break;
+		}
+
+		if (!isValid)
+		{
+			std::cerr << "Level file " << path << " entity " << i << " has an unknown type " << entities[i].type << " and variant " << entities[i].variant << " pair" << std::endl;
+			return false;
+		}
+	}
+
+	// Attachments can only refer to entities that exist, and a rope needs a sensible number of links
+	const LevelAttachment* attachments = GetAttachments();
+	for (unsigned int i = 0; i < header.attachmentCount; ++i)
+	{
+		if (attachments[i].entityA >= header.entityCount ||
+			(attachments[i].entityB != LEVEL_NO_ENTITY && attachments[i].entityB >= header.entityCount))
+		{
+			std::cerr << "Level file " << path << " attachment " << i << " refers to a missing entity" << std::endl;
+			return false;
+		}
+
+		if (attachments[i].length <= 0 || attachments[i].length > LEVEL_MAX_ROPE_LENGTH)
+		{
+			std::cerr << "Level file " << path << " attachment " << i << " has a length of " << attachments[i].length << ", it must be from 1 to " << LEVEL_MAX_ROPE_LENGTH << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+*	Returns the header of the mapped level
+*	Parameters - none
+*	Return - reference to the header
+*/
+const LevelHeader& LevelFile::GetHeader() const
+{
+	return *(const LevelHeader*)m_data;
+}
+
+/*
+*	Returns the entity records of the mapped level
+*	Parameters - none
+*	Return - pointer to the first entity record
+*/
+const LevelEntity* LevelFile::GetEntities() const
+{
+	return (const LevelEntity*)(m_data + sizeof(LevelHeader));
+}
+
+/*
+*	Returns the attachment records of the mapped level, which follow the entities
+*	Parameters - none
+*	Return - pointer to the first attachment record
+*/
+const LevelAttachment* LevelFile::GetAttachments() const
+{
+	return (const LevelAttachment*)(m_data + sizeof(LevelHeader) + GetHeader().entityCount * sizeof(LevelEntity));
+}
+
+/*
+*	Converts a level text file to the binary level format. Each line of the text file is one of:
+*		bird <x> <y> <CLASSIC|BOMBER|SPLITTER>
+*		construct <x> <y> <construct type> <angle in degrees>
+*		enemy <x> <y> <width> <height>
+*		spring <x> <y>
+*		rope <x> <y> <length> <construct index> [construct index]
+*	Entities are numbered from 0 in the order they appear, and lines starting with # are comments
+*	Parameters - file path of the text level, file path to write the binary level to
+*	Return - whether the conversion succeeded
+*/
+bool LevelFile::ConvertText(const std::string& textPath, const std::string& binaryPath)
+{
+	std::ifstream text(textPath.c_str());
+	if (!text)
+	{
+		std::cerr << "Could not read " << textPath << std::endl;
+		return false;
+	}
+
+	std::vector<LevelEntity> entities;
+	std::vector<LevelAttachment> attachments;
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(text, line))
+	{
+		++lineNumber;
+
+		std::istringstream stream(line);
+		std::string keyword;
+		if (!(stream >> keyword) || keyword[0] == '#')
+			continue;
+
+		bool isValid = false;
+		if (keyword == "rope")
+		{
+			LevelAttachment attachment = {};
+			attachment.type = LEVEL_ROPE;
+			attachment.entityB = LEVEL_NO_ENTITY;
+			isValid = (bool)(stream >> attachment.x >> attachment.y >> attachment.length >> attachment.entityA);
+
+			// The second end is optional
+			unsigned int entityB;
+			if (stream >> entityB)
+				attachment.entityB = entityB;
+
+			// Ropes hang between constructs
+			unsigned int ends[2] = { attachment.entityA, attachment.entityB };
+			for (int i = 0; i < 2 && isValid; ++i)
+				if (ends[i] != LEVEL_NO_ENTITY && (ends[i] >= entities.size() || entities[ends[i]].type != LEVEL_CONSTRUCT))
+					isValid = false;
+
+			if (isValid)
+				attachments.push_back(attachment);
+		}
+		else
+		{
+			LevelEntity entity = {};
+			std::string variant;
+			if (keyword == "bird")
+			{
+				entity.type = LEVEL_BIRD;
+				isValid = (stream >> entity.x >> entity.y >> variant) && ParseVariant(variant, s_birdTypes, 3, entity.variant);
+			}
+			else if (keyword == "construct")
+			{
+				entity.type = LEVEL_CONSTRUCT;
+				isValid = (stream >> entity.x >> entity.y >> variant >> entity.angle) && ParseVariant(variant, s_constructTypes, 4, entity.variant);
+			}
+			else if (keyword == "enemy")
+			{
+				entity.type = LEVEL_ENEMY;
+				isValid = (bool)(stream >> entity.x >> entity.y >> entity.width >> entity.height);
+			}
+			else if (keyword == "spring")
+			{
+				entity.type = LEVEL_SPRING;
+				isValid = (bool)(stream >> entity.x >> entity.y);
+			}
+
+			if (isValid)
+				entities.push_back(entity);
+		}
+
+		if (!isValid)
+		{
+			std::cerr << textPath << ":" << lineNumber << ": can't read '" << line << "'" << std::endl;
+			return false;
+		}
+	}
+
+	LevelHeader header;
+	header.magic = LEVEL_MAGIC;
+	header.version = LEVEL_VERSION;
+	header.entityCount = (unsigned int)entities.size();
+	header.attachmentCount = (unsigned int)attachments.size();
+
+	std::ofstream binary(binaryPath.c_str(), std::ios::binary);
+	if (!binary)
+	{
+		std::cerr << "Could not write " << binaryPath << std::endl;
+		return false;
+	}
+	binary.write((const char*)&header, sizeof(header));
+	if (!entities.empty())
+		binary.write((const char*)&entities[0], entities.size() * sizeof(LevelEntity));
+	if (!attachments.empty())
+		binary.write((const char*)&attachments[0], attachments.size() * sizeof(LevelAttachment));
+	return (bool)binary;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#ifndef LEVELFILE_H
+#define LEVELFILE_H
+
+// Local includes
+#include "utils.h"
+
+// Library includes
+#include <string>
+
+// Constants
+#define LEVEL_MAGIC 0x4C564241
+#define LEVEL_VERSION 1
+#define LEVEL_NO_ENTITY 0xFFFFFFFFu
+#define LEVEL_MAX_ROPE_LENGTH 64
+#define LEVEL_PATH_PREFIX "Assets/Levels/level"
+#define LEVEL_PATH_EXTENSION ".lvl"
+
+// Binary level layout: a LevelHeader, then entityCount LevelEntity records, then attachmentCount
+// LevelAttachment records. Every field is 4 bytes and little-endian, so the mapped file is used in place
+
+enum LevelEntityType
+{
+	LEVEL_BIRD,
+	LEVEL_CONSTRUCT,
+	LEVEL_ENEMY,
+	LEVEL_SPRING
+};
+
+enum LevelAttachmentType
+{
+	LEVEL_ROPE
+};
+
+struct LevelHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int entityCount;
+	unsigned int attachmentCount;
+};
+
+// A bird, construct, enemy or spring. Variant is the BirdType or ConstructType, size is only used by enemies
+struct LevelEntity
+{
+	unsigned int type;
+	unsigned int variant;
+	float x, y;
+	float width, height;
+	float angle;
+};
+
+// A rope between one or two constructs, which are given by their index in the entity records
+struct LevelAttachment
+{
+	unsigned int type;
+	unsigned int entityA;
+	unsigned int entityB;
+	int length;
+	float x, y;
+};
+
+class LevelFile
+{
+public:
+
+	LevelFile();
+	~LevelFile();
+
+	bool Open(const std::string& path);
+	void Close();
+
+	const LevelHeader& GetHeader() const;
+	const LevelEntity* GetEntities() const;
+	const LevelAttachment* GetAttachments() const;
+
+	static bool ConvertText(const std::string& textPath, const std::string& binaryPath);
+
+private:
+
+	// Private methods
+	LevelFile(const LevelFile& other);
+	LevelFile& operator= (const LevelFile& other);
+
+	bool Validate(const std::string& path) const;
+
+	// The mapped file
+	const unsigned char* m_data;
+	size_t m_size;
+
+#ifdef _WIN32
+	void* m_file;
+	void* m_mapping;
+#else
+	int m_file;
+#endif
+
+};
+
+#endif
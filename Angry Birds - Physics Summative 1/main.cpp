@@ -4,6 +4,10 @@
 #include "gamescene.h"
 #include "menu.h"
 #include "hud.h"
+#include "spritebatch.h"
+#include "texturecache.h"
+#include "programregistry.h"
+#include "fontcache.h"
 
 // Global variables
 GLFWwindow* g_window = 0;
@@ -122,6 +126,25 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 	lastTime = thisTime;
 }
 
+/*
+*	Passes the keyboard and cursor state to the game scene, called once per frame while in game
+*	Parameters - none
+*	Return - void
+*/
+void ProcessGameInput()
+{
+	// Press the space bar to activate the bird
+	if (glfwGetKey(g_window, GLFW_KEY_SPACE))
+		g_gameScene.UseAbility();
+
+	// Drag the bird on the slingshot towards the cursor
+	double x, y;
+	glfwGetCursorPos(g_window, &x, &y);
+	float posX = ((float)x / (WINDOW_WIDTH / (UNITSTOMETERS * 2))) - UNITSTOMETERS;
+	float posY = ((UNITSTOMETERS * 2) - ((float)y / (WINDOW_HEIGHT / (UNITSTOMETERS * 2)))) - UNITSTOMETERS;
+	g_gameScene.MoveMouseJoint(posX, posY);
+}
+
 /*
 *	Sets up game, and runs the main game loop
 *	Parameters - parameters
@@ -137,11 +160,17 @@ int main(int argc, char *argv[])
 	InitialiseGLFW();
 	InitialiseGlew();
 
-	// Initialise game scene, menu, and hud
+	// Initialise the sprite batch, game scene, menu, and hud
+	SpriteBatch::GetInstance().Initialise();
 	g_gameScene.InitialiseWorld();
 	g_menu.Initialise();
 	g_hud.Initialise();
 
+	// Report how long the shared shader programs took to build
+	ProgramRegistry& programs = ProgramRegistry::GetInstance();
+	std::cout << "Built " << programs.GetProgramCount() << " shader programs: compile "
+		<< programs.GetCompileSeconds() * 1000.0 << " ms, link " << programs.GetLinkSeconds() * 1000.0 << " ms" << std::endl;
+
 	// Set callabacks
 	glfwSetMouseButtonCallback(g_window, MouseButtonCallback);
 
@@ -153,11 +182,15 @@ int main(int argc, char *argv[])
 		// process pending events
 		glfwPollEvents();
 
+		// Write the per-frame shader constants
+		SpriteBatch::GetInstance().BeginFrame();
+
 		// Update and render the game scene
 		double thisTime = glfwGetTime();
 		if (g_state == GAME)
 		{
-			g_gameScene.Update(g_window, (float)(thisTime - lastTime), g_state);
+			ProcessGameInput();
+			g_gameScene.Update((float)(thisTime - lastTime), g_state);
 			g_gameScene.Render(g_window);
 		}
 		if (g_state == MENU)
@@ -180,6 +213,10 @@ int main(int argc, char *argv[])
 	g_gameScene.DestroyInstance();
 	g_menu.DestroyInstance();
 	g_hud.DestroyInstance();
+	SpriteBatch::DestroyInstance();
+	TextureCache::DestroyInstance();
+	ProgramRegistry::DestroyInstance();
+	FontCache::DestroyInstance();
 	glfwDestroyWindow(g_window);
 	glfwTerminate();
 	return 0;
@@ -58,7 +58,10 @@ void Menu::Render(GLFWwindow* window)
 	glClearColor(0, 0, 0, 1);
 	glClear(GL_COLOR_BUFFER_BIT);
 
+	SpriteBatch::GetInstance().SetLayer(LAYER_BACKGROUND);
 	m_background->Render();
+	SpriteBatch::GetInstance().Flush();
+
 	m_startText->Render();
 	m_exitText->Render();
 
@@ -76,7 +79,7 @@ void Menu::CheckIfClicked(GameState& state, float mouseX, float mouseY, GLFWwind
 	if (mouseX > 520 && mouseX < 710 && mouseY > 270 && mouseY < 315)
 	{
 		// If start button was clicked, start the first level
-		GameScene::GetInstance().SetupLevel1();
+		GameScene::GetInstance().LoadLevel(1);
 		state = GAME;
 	}
 	if (mouseX > 565 && mouseX < 695 && mouseY > 345 && mouseY < 375)
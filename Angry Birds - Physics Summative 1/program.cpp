@@ -5,10 +5,36 @@
 
 // Library inludes
 #include <stdexcept>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 
 // Third-party includes
 #include "Dependencies\glm\gtc\type_ptr.hpp"
 
+// Static Variables
+GLuint Program::s_currentProgram = 0;
+
+/*
+*	Orders program variables by name, so the lookup tables can be binary searched
+*	Parameters - the two variables to compare
+*	Return - whether a comes before b
+*/
+static bool CompareVariables(const ProgramVariable& a, const ProgramVariable& b)
+{
+	return strcmp(a.name.c_str(), b.name.c_str()) < 0;
+}
+
+/*
+*	Compares a program variable with a name, for searching the sorted lookup tables
+*	Parameters - the variable, the name
+*	Return - whether the variable comes before the name
+*/
+static bool CompareVariableName(const ProgramVariable& variable, const GLchar* name)
+{
+	return strcmp(variable.name.c_str(), name) < 0;
+}
+
 /*
 *	Program Constructor - creates shaders
 *	Parameters - reference to a vector of shaders
@@ -52,6 +78,9 @@ Program::Program(const std::vector<Shader>& shaders) :
 		glDeleteProgram(m_Object); m_Object = 0;
 		throw std::runtime_error(msg);
 	}
+
+	// Look up every active attribute and uniform now, so nothing is queried by name while drawing
+	Reflect();
 }
 
 /*
@@ -63,6 +92,70 @@ Program::~Program()
 {
 	//might be 0 if ctor fails by throwing exception
 	if (m_Object != 0) glDeleteProgram(m_Object);
+	if (s_currentProgram == m_Object) s_currentProgram = 0;
+}
+
+/*
+*	Reads the name, location and type of every active attribute and uniform into the lookup tables, sorted by name
+*	Parameters - none
+*	Return - void
+*/
+void Program::Reflect()
+{
+	GLint count = 0, maxLength = 0;
+
+	// Attributes
+	glGetProgramiv(m_Object, GL_ACTIVE_ATTRIBUTES, &count);
+	glGetProgramiv(m_Object, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+	std::vector<GLchar> name(std::max(maxLength, 1));
+	for (GLint i = 0; i < count; ++i)
+	{
+		ProgramVariable variable;
+		glGetActiveAttrib(m_Object, i, (GLsizei)name.size(), NULL, &variable.size, &variable.type, &name[0]);
+		variable.name = &name[0];
+		variable.location = glGetAttribLocation(m_Object, &name[0]);
+		m_attributes.push_back(variable);
+	}
+
+	// Uniforms
+	glGetProgramiv(m_Object, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(m_Object, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	name.resize(std::max(maxLength, 1));
+	for (GLint i = 0; i < count; ++i)
+	{
+		ProgramVariable variable;
+		glGetActiveUniform(m_Object, i, (GLsizei)name.size(), NULL, &variable.size, &variable.type, &name[0]);
+		variable.name = &name[0];
+		variable.location = glGetUniformLocation(m_Object, &name[0]);
+
+		// Uniforms in blocks have no location and are set through their buffer instead
+		if (variable.location == -1)
+			continue;
+
+		// Arrays are reported as "name[0]", store them under their plain name
+		size_t bracket = variable.name.find('[');
+		if (bracket != std::string::npos)
+			variable.name.erase(bracket);
+
+		m_uniforms.push_back(variable);
+	}
+
+	std::sort(m_attributes.begin(), m_attributes.end(), CompareVariables);
+	std::sort(m_uniforms.begin(), m_uniforms.end(), CompareVariables);
+}
+
+/*
+*	Finds a variable by name in one of the sorted lookup tables
+*	Parameters - the table to search, the variable name
+*	Return - the variable, or NULL if it is not active
+*/
+const ProgramVariable* Program::Find(const std::vector<ProgramVariable>& variables, const GLchar* name)
+{
+	std::vector<ProgramVariable>::const_iterator it = std::lower_bound(variables.begin(), variables.end(), name, CompareVariableName);
+	if (it != variables.end() && strcmp(it->name.c_str(), name) == 0)
+		return &(*it);
+
+	return NULL;
 }
 
 /*
@@ -83,6 +176,7 @@ GLuint Program::Object() const
 void Program::Use() const 
 {
 	glUseProgram(m_Object);
+	s_currentProgram = m_Object;
 }
 
 /*
@@ -92,9 +186,7 @@ void Program::Use() const
 */
 bool Program::IsInUse() const 
 {
-	GLint currentProgram = 0;
-	glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
-	return (currentProgram == (GLint)m_Object);
+	return (s_currentProgram == m_Object);
 }
 
 /*
@@ -106,6 +198,7 @@ void Program::StopUsing() const
 {
 	assert(IsInUse());
 	glUseProgram(0);
+	s_currentProgram = 0;
 }
 
 /*
@@ -118,11 +211,11 @@ GLint Program::attrib(const GLchar* attribName) const
 	if (!attribName)
 		throw std::runtime_error("attribName was NULL");
 
-	GLint attrib = glGetAttribLocation(m_Object, attribName);
-	if (attrib == -1)
+	const ProgramVariable* attrib = Find(m_attributes, attribName);
+	if (attrib == NULL)
 		throw std::runtime_error(std::string("Program attribute not found: ") + attribName);
 
-	return attrib;
+	return attrib->location;
 }
 
 /*
@@ -135,11 +228,90 @@ GLint Program::uniform(const GLchar* uniformName) const
 	if (!uniformName)
 		throw std::runtime_error("uniformName was NULL");
 
-	GLint uniform = glGetUniformLocation(m_Object, uniformName);
-	if (uniform == -1)
+	const ProgramVariable* uniform = Find(m_uniforms, uniformName);
+	if (uniform == NULL)
 		throw std::runtime_error(std::string("Program uniform not found: ") + uniformName);
 
-	return uniform;
+	return uniform->location;
+}
+
+/*
+*	returns a handle for a given uniform, without throwing if it is not active
+*	Parameters - uniform name
+*	Return - the uniform handle, with a location of -1 if the uniform is not active
+*/
+UniformHandle Program::uniformHandle(const GLchar* uniformName) const
+{
+	UniformHandle handle = { -1, GL_NONE };
+
+	const ProgramVariable* uniform = Find(m_uniforms, uniformName);
+	if (uniform != NULL)
+	{
+		handle.location = uniform->location;
+		handle.type = uniform->type;
+	}
+
+	return handle;
+}
+
+/*
+*	Sets an int or sampler uniform through its handle, the program must be in use
+*	Parameters - the uniform handle, the value
+*	Return - void
+*/
+void Program::setUniform(UniformHandle uniform, GLint v0)
+{
+	assert(IsInUse());
+	assert(uniform.location == -1 || uniform.type == GL_INT || uniform.type == GL_BOOL || uniform.type == GL_SAMPLER_2D);
+	glUniform1i(uniform.location, v0);
+}
+
+/*
+*	Sets a float uniform through its handle, the program must be in use
+*	Parameters - the uniform handle, the value
+*	Return - void
+*/
+void Program::setUniform(UniformHandle uniform, GLfloat v0)
+{
+	assert(IsInUse());
+	assert(uniform.location == -1 || uniform.type == GL_FLOAT);
+	glUniform1f(uniform.location, v0);
+}
+
+/*
+*	Sets a vec3 uniform through its handle, the program must be in use
+*	Parameters - the uniform handle, the value
+*	Return - void
+*/
+void Program::setUniform(UniformHandle uniform, const glm::vec3& v)
+{
+	assert(IsInUse());
+	assert(uniform.location == -1 || uniform.type == GL_FLOAT_VEC3);
+	glUniform3fv(uniform.location, 1, glm::value_ptr(v));
+}
+
+/*
+*	Sets a vec4 uniform through its handle, the program must be in use
+*	Parameters - the uniform handle, the value
+*	Return - void
+*/
+void Program::setUniform(UniformHandle uniform, const glm::vec4& v)
+{
+	assert(IsInUse());
+	assert(uniform.location == -1 || uniform.type == GL_FLOAT_VEC4);
+	glUniform4fv(uniform.location, 1, glm::value_ptr(v));
+}
+
+/*
+*	Sets a mat4 uniform through its handle, the program must be in use
+*	Parameters - the uniform handle, the value
+*	Return - void
+*/
+void Program::setUniform(UniformHandle uniform, const glm::mat4& m)
+{
+	assert(IsInUse());
+	assert(uniform.location == -1 || uniform.type == GL_FLOAT_MAT4);
+	glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(m));
 }
 
 #define ATTRIB_N_UNIFORM_SETTERS(OGL_TYPE, TYPE_PREFIX, TYPE_SUFFIX) \
@@ -9,11 +9,28 @@
 #include "shader.h"
 
 // Library includes
+#include <string>
 #include <vector>
 
 // Third-party includes
 #include "Dependencies\glm\glm.hpp"
 
+// An active attribute or uniform, reflected once when the program is linked
+struct ProgramVariable
+{
+	std::string name;
+	GLint location;
+	GLenum type;
+	GLint size;
+};
+
+// Resolved uniform location and type, used by the handle based setters
+struct UniformHandle
+{
+	GLint location;
+	GLenum type;
+};
+
 class Program
 {
 public:
@@ -35,6 +52,16 @@ public:
 	GLint attrib(const GLchar* attribName) const;
 	GLint uniform(const GLchar* uniformName) const;
 
+	// Returns a handle for the given uniform, the location is -1 if it is not active
+	UniformHandle uniformHandle(const GLchar* uniformName) const;
+
+	// Typed setters for uniform handles
+	void setUniform(UniformHandle uniform, GLint v0);
+	void setUniform(UniformHandle uniform, GLfloat v0);
+	void setUniform(UniformHandle uniform, const glm::vec3& v);
+	void setUniform(UniformHandle uniform, const glm::vec4& v);
+	void setUniform(UniformHandle uniform, const glm::mat4& m);
+
 	// Setters for uniform and attribute objects
 #define PROGRAM_ATTRIB_N_UNIFORM_SETTERS(OGL_TYPE) \
     void setAttrib(const GLchar* attribName, OGL_TYPE v0); \
@@ -75,6 +102,16 @@ private:
 
 	GLuint m_Object;
 
+	// Active attributes and uniforms of the linked program
+	std::vector<ProgramVariable> m_attributes;
+	std::vector<ProgramVariable> m_uniforms;
+
+	// The program currently bound with Use, tracked here so checking it needs no glGet
+	static GLuint s_currentProgram;
+
+	void Reflect();
+	static const ProgramVariable* Find(const std::vector<ProgramVariable>& variables, const GLchar* name);
+
 	// Functions are private to prevent copying
 	Program(const Program&);
 	const Program& operator=(const Program&);
@@ -0,0 +1,150 @@
+
+// This include
+#include "programregistry.h"
+
+// Library includes
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// Static Variables
+ProgramRegistry* ProgramRegistry::m_programRegistry = 0;
+
+/*
+*	Makes a file path use forward slashes so the same file always gives the same key
+*	Parameters - the file path
+*	Return - the normalised path
+*/
+static std::string NormalisePath(std::string path)
+{
+	std::replace(path.begin(), path.end(), '\\', '/');
+	return path;
+}
+
+/*
+*	Returns the seconds elapsed since a given time point
+*	Parameters - the start time
+*	Return - elapsed seconds
+*/
+static double SecondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+/*
+*	ProgramRegistry Constructor
+*	Parameters - none
+*	Return - none
+*/
+ProgramRegistry::ProgramRegistry() :
+	m_compileSeconds(0.0),
+	m_linkSeconds(0.0)
+{
+
+}
+
+/*
+*	ProgramRegistry Destructor - deletes all the programs
+*	Parameters - none
+*	Return - none
+*/
+ProgramRegistry::~ProgramRegistry()
+{
+	for (std::map<std::pair<std::string, std::string>, RegisteredProgram>::iterator it = m_programs.begin(); it != m_programs.end(); ++it)
+	{
+		delete it->second.program;
+		it->second.program = 0;
+	}
+	m_programs.clear();
+}
+
+/*
+*	Returns the program for a pair of shaders, compiling and linking it only the first time it is requested
+*	Parameters - file paths of the vertex and fragment shaders
+*	Return - the shared program, owned by the registry
+*/
+Program* ProgramRegistry::Get(const std::string& vertexPath, const std::string& fragmentPath)
+{
+	std::pair<std::string, std::string> key(NormalisePath(vertexPath), NormalisePath(fragmentPath));
+
+	// Share the program if it has already been built
+	std::map<std::pair<std::string, std::string>, RegisteredProgram>::iterator it = m_programs.find(key);
+	if (it != m_programs.end())
+		return it->second.program;
+
+	RegisteredProgram entry;
+
+	// Load and compile the shaders
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	std::vector<Shader> shaders;
+	shaders.push_back(Shader::GetShaderFromFile(key.first, GL_VERTEX_SHADER));
+	shaders.push_back(Shader::GetShaderFromFile(key.second, GL_FRAGMENT_SHADER));
+	entry.compileSeconds = SecondsSince(start);
+
+	// Link them into the program
+	start = std::chrono::high_resolution_clock::now();
+	entry.program = new Program(shaders);
+	entry.linkSeconds = SecondsSince(start);
+
+	m_compileSeconds += entry.compileSeconds;
+	m_linkSeconds += entry.linkSeconds;
+	m_programs[key] = entry;
+
+	return entry.program;
+}
+
+/*
+*	Returns the number of programs that have been built
+*	Parameters - none
+*	Return - number of programs
+*/
+unsigned ProgramRegistry::GetProgramCount()
+{
+	return (unsigned)m_programs.size();
+}
+
+/*
+*	Returns the total time spent loading and compiling shaders
+*	Parameters - none
+*	Return - time in seconds
+*/
+double ProgramRegistry::GetCompileSeconds()
+{
+	return m_compileSeconds;
+}
+
+/*
+*	Returns the total time spent linking programs
+*	Parameters - none
+*	Return - time in seconds
+*/
+double ProgramRegistry::GetLinkSeconds()
+{
+	return m_linkSeconds;
+}
+
+/*
+*	Returns the singleton instance of the program registry
+*	Parameters - none
+*	Return - reference to the program registry instance
+*/
+ProgramRegistry& ProgramRegistry::GetInstance()
+{
+	// Return the singleton
+	if (m_programRegistry == 0)
+		m_programRegistry = new ProgramRegistry();
+
+	return *m_programRegistry;
+}
+
+/*
+*	Destroys the singleton instance of the program registry
+*	Parameters - none
+*	Return - void
+*/
+void ProgramRegistry::DestroyInstance()
+{
+	// Delete the singleton instance
+	delete m_programRegistry;
+	m_programRegistry = 0;
+}
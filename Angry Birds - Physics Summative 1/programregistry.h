@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef PROGRAMREGISTRY_H
+#define PROGRAMREGISTRY_H
+
+// Local includes
+#include "program.h"
+
+// Library includes
+#include <map>
+#include <string>
+#include <utility>
+
+// A linked program and how long it took to build
+struct RegisteredProgram
+{
+	Program* program;
+	double compileSeconds;
+	double linkSeconds;
+};
+
+class ProgramRegistry
+{
+public:
+
+	~ProgramRegistry();
+
+	static ProgramRegistry& GetInstance();
+	static void DestroyInstance();
+
+	Program* Get(const std::string& vertexPath, const std::string& fragmentPath);
+
+	unsigned GetProgramCount();
+	double GetCompileSeconds();
+	double GetLinkSeconds();
+
+private:
+
+	// Private methods
+	ProgramRegistry();
+	ProgramRegistry(const ProgramRegistry& other);
+	ProgramRegistry& operator= (const ProgramRegistry& other);
+
+	// Programs by (vertex shader, fragment shader) path
+	std::map<std::pair<std::string, std::string>, RegisteredProgram> m_programs;
+	double m_compileSeconds;
+	double m_linkSeconds;
+
+	// Singleton Instance
+	static ProgramRegistry* m_programRegistry;
+
+};
+
+#endif
@@ -103,6 +103,17 @@ void Rope::Update(float time)
 		(*it)->Update(time);
 }
 
+/*
+*	Saves the body transform of every Rope link before a physics step, for render interpolation
+*	Parameters - none
+*	Return - void
+*/
+void Rope::StorePreviousTransforms()
+{
+	for (std::vector<Ropelink*>::iterator it = m_links.begin(); it != m_links.end(); ++it)
+		(*it)->StorePreviousTransform();
+}
+
 /*
 *	Renders the individual Rope links
 *	Parameters - none
@@ -115,6 +126,21 @@ void Rope::Render()
 		(*it)->Render();
 }
 
+/*
+*	Deletes the Rope links without destroying their bodies, for when the whole world is cleared at once
+*	Parameters - none
+*	Return - void
+*/
+void Rope::ReleaseLinks()
+{
+	for (std::vector<Ropelink*>::iterator it = m_links.begin(); it != m_links.end(); ++it)
+	{
+		delete (*it);
+		(*it) = 0;
+	}
+	m_links.clear();
+}
+
 /*
 *	destroys the joint in the middle of the Rope, effectively breaking it in half
 *	Parameters - none
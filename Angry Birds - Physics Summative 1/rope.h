@@ -19,7 +19,9 @@ public:
 	virtual void Render();
 	virtual void Update(float time);
 
+	void StorePreviousTransforms();
 	void BreakRope();
+	void ReleaseLinks();
 	std::vector<Ropelink*> GetLinks();
 
 private:
@@ -16,8 +16,6 @@ Spring::Spring(float posX, float posY, b2World* world, b2Body* ground)
 
 	LoadSprite("Assets/Sprites/springtop.png");
 
-	// Load the shape
-	LoadShape();
 	CreatePhysicsBody(world, ground);
 
 	m_type = SPRING;
@@ -27,13 +25,14 @@ Spring::Spring(float posX, float posY, b2World* world, b2Body* ground)
 }
 
 /*
-*	Spring Destructor
+*	Spring Destructor - deletes the spring gameobject
 *	Parameters - none
 *	Return - none
 */
 Spring::~Spring()
 {
-
+	delete m_spring;
+	m_spring = 0;
 }
 
 /*
@@ -99,34 +98,7 @@ void Spring::Render()
 {
 	m_spring->Render();
 
-	// bind the program
-	m_program->Use();
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	// bind the texture and set the "tex" uniform in the fragment shader
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
-	m_program->setUniform("tex", 0);
-	m_program->setUniform("model",
-		glm::scale(glm::mat4(), glm::vec3(((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH), 1.0f, 1.0f)) *
-		glm::translate(glm::mat4(), glm::vec3(m_position.x * METERSTOUNITS, m_position.y * METERSTOUNITS, 0.0f)) *
-		glm::rotate(glm::mat4(), m_body->GetAngle(), glm::vec3(0, 0, 1)));
-
-	// bind the texture and set the "tex" uniform in the fragment shader
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
-
-	// bind the VAO and draw
-	glBindVertexArray(m_vao);
-	glDrawArrays(GL_TRIANGLES, 0, 6 * 2 * 3);
-
-	// unbind the VAO, the program and the texture
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	glDisable(GL_BLEND);
-	m_program->StopUsing();
+	QueueSprite();
 }
 
 /*
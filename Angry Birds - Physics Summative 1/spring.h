@@ -19,7 +19,7 @@ public:
 	virtual void Update(float time);
 	virtual void Render();
 
-	b2Body* GetBody();
+	virtual b2Body* GetBody();
 
 private:
 
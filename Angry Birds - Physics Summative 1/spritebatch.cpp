@@ -0,0 +1,284 @@
+
+// This include
+#include "spritebatch.h"
+
+// Library includes
+#include <algorithm>
+#include <cstddef>
+
+// Static Variables
+SpriteBatch* SpriteBatch::m_spriteBatch = 0;
+
+/*
+*	Orders sprite records by layer then group, sprites in one group overlap in the order they were queued
+*	Parameters - the two records to compare
+*	Return - whether a should be drawn before b
+*/
+static bool CompareRecords(const SpriteRecord& a, const SpriteRecord& b)
+{
+	if (a.layer != b.layer)
+		return a.layer < b.layer;
+	return a.group < b.group;
+}
+
+/*
+*	SpriteBatch Constructor - sets all handles to 0
+*	Parameters - none
+*	Return - none
+*/
+SpriteBatch::SpriteBatch() :
+	m_layer(LAYER_BACKGROUND),
+	m_groupByTexture(false),
+	m_vao(0),
+	m_quadVbo(0),
+	m_instanceVbo(0),
+	m_frameUbo(0),
+	m_instanceCapacity(0)
+{
+
+}
+
+/*
+*	SpriteBatch Destructor - deletes the buffers and the vertex array
+*	Parameters - none
+*	Return - none
+*/
+SpriteBatch::~SpriteBatch()
+{
+	glDeleteBuffers(1, &m_frameUbo);
+	glDeleteBuffers(1, &m_instanceVbo);
+	glDeleteBuffers(1, &m_quadVbo);
+	glDeleteVertexArrays(1, &m_vao);
+}
+
+/*
+*	Creates the unit quad and the instance buffer, and connects them to the sprite shader attributes
+*	Parameters - none
+*	Return - void
+*/
+void SpriteBatch::Initialise()
+{
+	// Unit quad, scaled to the size of each sprite by its model matrix
+	GLfloat vertexData[] = {
+		//  X	  Y
+		-1.0f, -1.0f,
+		 1.0f, -1.0f,
+		-1.0f,  1.0f,
+		 1.0f, -1.0f,
+		 1.0f,  1.0f,
+		-1.0f,  1.0f,
+	};
+
+	// make and bind the VAO
+	glGenVertexArrays(1, &m_vao);
+	glBindVertexArray(m_vao);
+
+	// make the quad VBO and connect it to the "vert" attribute (location 0)
+	glGenBuffers(1, &m_quadVbo);
+	glBindBuffer(GL_ARRAY_BUFFER, m_quadVbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertexData), vertexData, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), NULL);
+
+	// make the instance VBO, the model matrix takes locations 1 to 4 and the uv rect location 5
+	glGenBuffers(1, &m_instanceVbo);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+	for (GLuint column = 0; column < 4; ++column)
+	{
+		glEnableVertexAttribArray(1 + column);
+		glVertexAttribPointer(1 + column, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (const GLvoid*)(column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(1 + column, 1);
+	}
+	glEnableVertexAttribArray(5);
+	glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (const GLvoid*)offsetof(SpriteInstance, uvRect));
+	glVertexAttribDivisor(5, 1);
+
+	// the sprite space takes location 6
+	glEnableVertexAttribArray(6);
+	glVertexAttribPointer(6, 1, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (const GLvoid*)offsetof(SpriteInstance, space));
+	glVertexAttribDivisor(6, 1);
+
+	// unbind the VAO
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// make the frame constants buffer and attach it to binding point 0
+	glGenBuffers(1, &m_frameUbo);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_frameUbo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants), NULL, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, 0, m_frameUbo);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	ReserveInstances(256);
+}
+
+/*
+*	Writes the constants shared by every sprite this frame into the uniform buffer
+*	Parameters - none
+*	Return - void
+*/
+void SpriteBatch::BeginFrame()
+{
+	// World sprites are squashed horizontally to undo the window aspect ratio
+	FrameConstants constants;
+	constants.worldProjection = glm::scale(glm::mat4(), glm::vec3(((float)WINDOW_HEIGHT / (float)WINDOW_WIDTH), 1.0f, 1.0f));
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_frameUbo);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameConstants), &constants);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/*
+*	Sets the layer that following sprites are queued on
+*	Parameters - the layer, and whether its sprites can be drawn grouped by texture rather than in the order they are queued
+*	Return - void
+*/
+void SpriteBatch::SetLayer(SpriteLayer layer, bool groupByTexture)
+{
+	m_layer = layer;
+	m_groupByTexture = groupByTexture;
+}
+
+/*
+*	Queues a sprite to be drawn on the next flush
+*	Parameters - the program and texture to draw with, the model matrix of the unit quad, the space it is in, and the uv rect (offset, size)
+*	Return - void
+*/
+void SpriteBatch::Draw(Program* program, GLuint texture, const glm::mat4& model, SpriteSpace space, const glm::vec4& uvRect)
+{
+	SpriteRecord record;
+	record.layer = m_layer;
+	record.group = m_groupByTexture ? texture : 0;
+	record.program = program;
+	record.texture = texture;
+	record.instance.model = model;
+	record.instance.uvRect = uvRect;
+	record.instance.space = (GLfloat)space;
+	m_records.push_back(record);
+}
+
+/*
+*	Sorts the queued sprites by layer and group, uploads them in one go and draws each run of neighbouring sprites with matching state with one instanced draw
+*	Parameters - none
+*	Return - void
+*/
+void SpriteBatch::Flush()
+{
+	if (m_records.empty())
+		return;
+
+	// Stable so sprites in a group keep the order they were queued in
+	std::stable_sort(m_records.begin(), m_records.end(), CompareRecords);
+
+	m_instances.clear();
+	for (std::vector<SpriteRecord>::iterator it = m_records.begin(); it != m_records.end(); ++it)
+		m_instances.push_back(it->instance);
+
+	// Orphan the instance buffer and upload this batch
+	ReserveInstances(m_instances.size());
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+	glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity * sizeof(SpriteInstance), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, m_instances.size() * sizeof(SpriteInstance), &m_instances[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glActiveTexture(GL_TEXTURE0);
+	glBindVertexArray(m_vao);
+
+	Program* currentProgram = 0;
+	GLuint currentTexture = 0;
+	size_t runStart = 0;
+	for (size_t i = 1; i <= m_records.size(); ++i)
+	{
+		// Keep extending the run while the state matches
+		if (i < m_records.size() &&
+			m_records[i].program == m_records[runStart].program &&
+			m_records[i].texture == m_records[runStart].texture)
+			continue;
+
+		const SpriteRecord& run = m_records[runStart];
+		if (run.program != currentProgram)
+		{
+			if (currentProgram != 0)
+				currentProgram->StopUsing();
+			currentProgram = run.program;
+			currentProgram->Use();
+			currentProgram->setUniform(GetTextureUniform(currentProgram), 0);
+		}
+		if (run.texture != currentTexture)
+		{
+			currentTexture = run.texture;
+			glBindTexture(GL_TEXTURE_2D, currentTexture);
+		}
+
+		// Draw the whole run
+		glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, 6, (GLsizei)(i - runStart), (GLuint)runStart);
+		runStart = i;
+	}
+
+	// unbind the VAO, the program and the texture
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glDisable(GL_BLEND);
+	currentProgram->StopUsing();
+
+	m_records.clear();
+}
+
+/*
+*	Grows the instance buffer so it can hold at least the given number of instances
+*	Parameters - the number of instances
+*	Return - void
+*/
+void SpriteBatch::ReserveInstances(size_t count)
+{
+	if (count <= m_instanceCapacity)
+		return;
+
+	// Grow geometrically so a level with more objects only resizes a few times
+	size_t capacity = b2Max(m_instanceCapacity * 2, count);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+	glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(SpriteInstance), NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	m_instanceCapacity = capacity;
+}
+
+/*
+*	Returns the handle of the "tex" sampler of a program, looking it up the first time the program is drawn with
+*	Parameters - the program
+*	Return - the uniform handle
+*/
+UniformHandle SpriteBatch::GetTextureUniform(Program* program)
+{
+	std::map<Program*, UniformHandle>::iterator it = m_textureUniforms.find(program);
+	if (it == m_textureUniforms.end())
+		it = m_textureUniforms.insert(std::make_pair(program, program->uniformHandle("tex"))).first;
+	return it->second;
+}
+
+/*
+*	Returns the singleton instance of the sprite batch
+*	Parameters - none
+*	Return - reference to the sprite batch instance
+*/
+SpriteBatch& SpriteBatch::GetInstance()
+{
+	// Return the singleton
+	if (m_spriteBatch == 0)
+		m_spriteBatch = new SpriteBatch();
+
+	return *m_spriteBatch;
+}
+
+/*
+*	Destroys the singleton instance of the sprite batch
+*	Parameters - none
+*	Return - void
+*/
+void SpriteBatch::DestroyInstance()
+{
+	// Delete the singleton instance
+	delete m_spriteBatch;
+	m_spriteBatch = 0;
+}
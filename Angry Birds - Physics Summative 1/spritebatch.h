@@ -0,0 +1,104 @@
+#pragma once
+
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+// Local includes
+#include "utils.h"
+#include "program.h"
+
+// Library includes
+#include <map>
+#include <vector>
+
+// Draw layers, sprites are sorted by layer so the scene keeps its draw order. Each type of world object
+// has its own layer so sprites sharing a texture end up next to each other and draw together
+enum SpriteLayer
+{
+	LAYER_BACKGROUND,
+	LAYER_BACK,
+	LAYER_BIRD,
+	LAYER_ENEMIES,
+	LAYER_CONSTRUCTS,
+	LAYER_SPLITTER_BIRDS,
+	LAYER_FRONT,
+	LAYER_HUD
+};
+
+// Whether a sprite's model matrix is in world units or already in screen space
+enum SpriteSpace
+{
+	SPACE_SCREEN,
+	SPACE_WORLD
+};
+
+// Per-instance data streamed into the instance buffer
+struct SpriteInstance
+{
+	glm::mat4 model;
+	glm::vec4 uvRect;
+	GLfloat space;
+};
+
+// Per-frame shader constants, laid out to match the std140 FrameConstants block
+struct FrameConstants
+{
+	glm::mat4 worldProjection;
+};
+
+// A queued sprite and the state that has to be bound to draw it
+struct SpriteRecord
+{
+	SpriteLayer layer;
+	// Sorted on within the layer, the texture on layers that don't care about order and 0 otherwise
+	GLuint group;
+	Program* program;
+	GLuint texture;
+	SpriteInstance instance;
+};
+
+class SpriteBatch
+{
+public:
+
+	~SpriteBatch();
+
+	static SpriteBatch& GetInstance();
+	static void DestroyInstance();
+
+	void Initialise();
+
+	void BeginFrame();
+	void SetLayer(SpriteLayer layer, bool groupByTexture = false);
+	void Draw(Program* program, GLuint texture, const glm::mat4& model, SpriteSpace space = SPACE_SCREEN, const glm::vec4& uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+	void Flush();
+
+private:
+
+	// Private methods
+	SpriteBatch();
+	SpriteBatch(const SpriteBatch& other);
+	SpriteBatch& operator= (const SpriteBatch& other);
+
+	void ReserveInstances(size_t count);
+	UniformHandle GetTextureUniform(Program* program);
+
+	// Queued sprites, and the sorted instance data uploaded on flush
+	std::vector<SpriteRecord> m_records;
+	std::vector<SpriteInstance> m_instances;
+	SpriteLayer m_layer;
+	bool m_groupByTexture;
+
+	// The "tex" sampler handle of each program drawn with, looked up the first time the program is used
+	std::map<Program*, UniformHandle> m_textureUniforms;
+
+	// Unit quad, the dynamic instance buffer and the per-frame uniform buffer
+	GLuint m_vao, m_quadVbo, m_instanceVbo, m_frameUbo;
+	size_t m_instanceCapacity;
+
+	// Singleton Instance
+	static SpriteBatch* m_spriteBatch;
+
+};
+
+#endif
@@ -9,79 +9,28 @@
 *	Return - none
 */
 TextLabel::TextLabel(std::string text, glm::vec2 position, float scale, glm::vec3 colour, char* font) :
-	m_isActive(true)
+	m_isActive(true),
+	m_vboSize(0),
+	m_isMeshDirty(true)
 {
 	m_text = text;
 	m_colour = colour;
 	m_scale = scale / 1000.0f;
 	m_position = position / 100.0f;
 
-	// Load shaders
-	std::vector<Shader> shaders;
-	shaders.push_back(Shader::GetShaderFromFile("Assets\\Shaders\\text-vertex-shader.vs", GL_VERTEX_SHADER));
-	shaders.push_back(Shader::GetShaderFromFile("Assets\\Shaders\\text-fragment-shader.fs", GL_FRAGMENT_SHADER));
-	m_program = new Program(shaders);
+	// Get the shared text program
+	m_program = ProgramRegistry::GetInstance().Get("Assets/Shaders/text-vertex-shader.vs", "Assets/Shaders/text-fragment-shader.fs");
+	m_colourUniform = m_program->uniformHandle("textColour");
 
-	FT_Library ft;
-	if (FT_Init_FreeType(&ft)) {
-		std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-	}
-
-	FT_Face face; // Load font as face
-	if (FT_New_Face(ft, font, 0, &face)) {
-		std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
-	}
+	// Get the glyph atlas, only rasterised for the first label using this font
+	m_font = FontCache::GetInstance().Get(font, 48);
 
-	// Set size to load glyphs as 
-	FT_Set_Pixel_Sizes(face, 0, 48);
-
-	// Disable byte-alignment restriction 
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-	// Load first 128 characters of ASCII
-	for (GLubyte c = 0; c < 128; c++) {
-		// Load character glyph
-		if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
-			std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl; continue;
-		}
-
-		// Generate texture
-		GLuint texture; glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, face->glyph->bitmap.width,
-			face->glyph->bitmap.rows, 0,
-			GL_RED,
-			GL_UNSIGNED_BYTE,
-			face->glyph->bitmap.buffer);
-
-		// Set texture options
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// Now store character for late
-		Character character = {
-			texture,
-			glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-			glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-			face->glyph->advance.x
-		};
-		Characters.insert(std::pair<GLchar, Character>(c, character));
-	}// for loop end
-
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	// Destroy FreeType once we're finished 
-	FT_Done_Face(face);
-	FT_Done_FreeType(ft);
 	// Configure VAO/VBO for texture quads 
 	glGenVertexArrays(1, &m_vao);
 	glGenBuffers(1, &m_vbo);
 
 	glBindVertexArray(m_vao);
 	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
 	glEnableVertexAttribArray(0);
 
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
@@ -90,14 +39,68 @@ TextLabel::TextLabel(std::string text, glm::vec2 position, float scale, glm::vec
 }
 
 /*
-*	Textlabel Destructor - deletes the program
+*	Textlabel Destructor - deletes the vertex buffer
 *	Parameters - none
 *	Return - none
 */
 TextLabel::~TextLabel()
 {
-	delete m_program;
+	// The program is owned by the registry
 	m_program = 0;
+
+	glDeleteBuffers(1, &m_vbo);
+	glDeleteVertexArrays(1, &m_vao);
+}
+
+/*
+*	Builds the quads for every character and uploads them to the vertex buffer
+*	Parameters - none
+*	Return - void
+*/
+void TextLabel::BuildMesh()
+{
+	glm::vec2 textPos = m_position;
+	m_vertices.clear();
+
+	std::string::const_iterator c;
+
+	for (c = m_text.begin(); c != m_text.end(); c++)
+	{
+		const Glyph& ch = m_font->glyphs[(unsigned char)*c % FONT_GLYPH_COUNT];
+		GLfloat xpos = textPos.x + ch.Bearing.x * m_scale;
+
+		GLfloat ypos = textPos.y - (ch.Size.y - ch.Bearing.y) * m_scale;
+		GLfloat w = ch.Size.x * m_scale;
+		GLfloat h = ch.Size.y * m_scale;
+
+		// Add the quad for this character, mapped to its spot in the atlas
+		GLfloat vertices[6][4] = {
+			{ xpos, ypos + h, ch.UVMin.x, ch.UVMin.y },
+			{ xpos, ypos, ch.UVMin.x, ch.UVMax.y },
+			{ xpos + w, ypos, ch.UVMax.x, ch.UVMax.y },
+			{ xpos, ypos + h, ch.UVMin.x, ch.UVMin.y },
+			{ xpos + w, ypos, ch.UVMax.x, ch.UVMax.y },
+			{ xpos + w, ypos + h, ch.UVMax.x, ch.UVMin.y }
+		};
+		m_vertices.insert(m_vertices.end(), &vertices[0][0], &vertices[0][0] + 6 * 4);
+
+		// Now advance cursors for next glyph 
+		textPos.x += (ch.Advance >> 6) * m_scale;
+	} // end of for loop
+
+	// Upload, only reallocating the buffer when the text grows
+	GLsizeiptr size = (GLsizeiptr)(m_vertices.size() * sizeof(GLfloat));
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+	if (size > m_vboSize)
+	{
+		glBufferData(GL_ARRAY_BUFFER, size, &m_vertices[0], GL_DYNAMIC_DRAW);
+		m_vboSize = size;
+	}
+	else if (size > 0)
+		glBufferSubData(GL_ARRAY_BUFFER, 0, size, &m_vertices[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	m_isMeshDirty = false;
 }
 
 /*
@@ -109,52 +112,31 @@ void TextLabel::Render()
 {
 	if (m_isActive)
 	{
-		glm::vec2 textPos = m_position;
+		if (m_isMeshDirty)
+			BuildMesh();
+
+		if (m_vertices.empty())
+			return;
+
 		glEnable(GL_CULL_FACE);
 		glEnable(GL_BLEND);
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		// Activate corresponding render state 
 		m_program->Use();
-		m_program->setUniform("textColour", m_colour);
+		m_program->setUniform(m_colourUniform, m_colour);
 		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, m_font->texture);
 		glBindVertexArray(m_vao);
 
-		std::string::const_iterator c;
-
-		for (c = m_text.begin(); c != m_text.end(); c++)
-		{
-			Character ch = Characters[*c];
-			GLfloat xpos = textPos.x + ch.Bearing.x * m_scale;
-
-			GLfloat ypos = textPos.y - (ch.Size.y - ch.Bearing.y) * m_scale;
-			GLfloat w = ch.Size.x * m_scale;
-			GLfloat h = ch.Size.y * m_scale;
-			// Update VBO for each character 
-			GLfloat vertices[6][4] = {
-				{ xpos, ypos + h, 0.0, 0.0 },
-				{ xpos, ypos, 0.0, 1.0 },
-				{ xpos + w, ypos, 1.0, 1.0 },
-				{ xpos, ypos + h, 0.0, 0.0 },
-				{ xpos + w, ypos, 1.0, 1.0 },
-				{ xpos + w, ypos + h, 1.0, 0.0 }
-			};
-
-			// Render glyph texture over quad
-
-			glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-			glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-			glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-			glBindBuffer(GL_ARRAY_BUFFER, 0);
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-			// Now advance cursors for next glyph 
-			textPos.x += (ch.Advance >> 6) * m_scale;
-		} // end of for loop
+		// Draw the whole string at once
+		glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(m_vertices.size() / 4));
 
 		glBindVertexArray(0);
 		glBindTexture(GL_TEXTURE_2D, 0);
 		glDisable(GL_CULL_FACE);
 		glDisable(GL_BLEND);
+		m_program->StopUsing();
 	}
 }
 
@@ -166,6 +148,7 @@ void TextLabel::Render()
 void TextLabel::SetPosition(glm::vec2 position)
 {
 	m_position = position;
+	m_isMeshDirty = true;
 }
 
 /*
@@ -186,6 +169,7 @@ void TextLabel::SetColor(glm::vec3 Color)
 void TextLabel::SetScale(GLfloat scale)
 {
 	m_scale = scale/1000;
+	m_isMeshDirty = true;
 }
 
 /*
@@ -195,7 +179,11 @@ void TextLabel::SetScale(GLfloat scale)
 */
 void TextLabel::SetText(std::string text)
 {
+	if (text == m_text)
+		return;
+
 	m_text = text;
+	m_isMeshDirty = true;
 }
 
 /*
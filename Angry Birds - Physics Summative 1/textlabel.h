@@ -8,23 +8,14 @@
 // Local includes
 #include "utils.h"
 #include "program.h"
-
-// Third-party includes
-#include <ft2build.h>
-#include FT_FREETYPE_H
+#include "programregistry.h"
+#include "fontcache.h"
 
 // Library includes
-#include <map>
+#include <vector>
 #include <string>
 #include <iostream>
 
-struct Character {
-	GLuint TextureID;
-	glm::ivec2 Size; // Size of glyph
-	glm::ivec2 Bearing;
-	GLuint Advance;
-};
-
 class TextLabel 
 {
 public:
@@ -49,8 +40,16 @@ private:
 
 	bool m_isActive;
 	Program* m_program;
+	UniformHandle m_colourUniform;
 	GLuint m_vao, m_vbo;
-	std::map<GLchar, Character> Characters;
+
+	// Glyph quads for the whole string, rebuilt only when the text, position or scale changes
+	const FontAtlas* m_font;
+	std::vector<GLfloat> m_vertices;
+	GLsizeiptr m_vboSize;
+	bool m_isMeshDirty;
+
+	void BuildMesh();
 };
 
 #endif
\ No newline at end of file
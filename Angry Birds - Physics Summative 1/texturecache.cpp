@@ -0,0 +1,192 @@
+
+// This include
+#include "texturecache.h"
+
+// Static Variables
+TextureCache* TextureCache::m_textureCache = 0;
+
+/*
+*	TextureCache Constructor
+*	Parameters - none
+*	Return - none
+*/
+TextureCache::TextureCache() :
+	m_residentBytes(0)
+{
+
+}
+
+/*
+*	TextureCache Destructor - deletes any textures that are still resident
+*	Parameters - none
+*	Return - none
+*/
+TextureCache::~TextureCache()
+{
+	for (std::map<std::string, CachedTexture>::iterator it = m_textures.begin(); it != m_textures.end(); ++it)
+		glDeleteTextures(1, &it->second.texture);
+	m_textures.clear();
+	m_paths.clear();
+}
+
+/*
+*	Returns the texture for an asset path, decoding and uploading it only the first time it is requested
+*	Parameters - file path of the image
+*	Return - the texture handle
+*/
+GLuint TextureCache::Acquire(const std::string& path)
+{
+	// Share the texture if it is already resident
+	std::map<std::string, CachedTexture>::iterator it = m_textures.find(path);
+	if (it != m_textures.end())
+	{
+		++it->second.refCount;
+		return it->second.texture;
+	}
+
+	CachedTexture entry;
+	GLuint texture = LoadTexture(path, entry);
+	m_textures[path] = entry;
+	m_paths[texture] = path;
+	m_residentBytes += entry.bytes;
+
+	return texture;
+}
+
+/*
+*	Drops a reference to a texture, and deletes it when nothing is using it anymore
+*	Parameters - the texture handle
+*	Return - void
+*/
+void TextureCache::Release(GLuint texture)
+{
+	std::map<GLuint, std::string>::iterator path = m_paths.find(texture);
+	if (path == m_paths.end())
+		return;
+
+	std::map<std::string, CachedTexture>::iterator it = m_textures.find(path->second);
+	if (--it->second.refCount == 0)
+	{
+		// Last user is gone, free the GPU memory
+		glDeleteTextures(1, &it->second.texture);
+		m_residentBytes -= it->second.bytes;
+		m_textures.erase(it);
+		m_paths.erase(path);
+	}
+}
+
+/*
+*	Gets the dimensions of a cached texture
+*	Parameters - the texture handle, references to write the width and height to
+*	Return - whether the texture was found
+*/
+bool TextureCache::GetSize(GLuint texture, int& width, int& height)
+{
+	std::map<GLuint, std::string>::iterator path = m_paths.find(texture);
+	if (path == m_paths.end())
+		return false;
+
+	const CachedTexture& entry = m_textures[path->second];
+	width = entry.width;
+	height = entry.height;
+	return true;
+}
+
+/*
+*	Returns the GPU memory used by all resident textures, including their mipmaps
+*	Parameters - none
+*	Return - size in bytes
+*/
+size_t TextureCache::GetResidentBytes()
+{
+	return m_residentBytes;
+}
+
+/*
+*	Returns the number of resident textures
+*	Parameters - none
+*	Return - number of textures
+*/
+unsigned TextureCache::GetTextureCount()
+{
+	return (unsigned)m_textures.size();
+}
+
+/*
+*	Loads an image using SOIL and uploads it with mipmaps
+*	Parameters - file path of the image, the cache entry to fill in
+*	Return - the texture handle
+*/
+GLuint TextureCache::LoadTexture(const std::string& path, CachedTexture& entry)
+{
+	// Generate texture
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width = 0, height = 0;
+
+	// Load actual image
+	unsigned char* image = SOIL_load_image(path.c_str(),
+		&width,
+		&height,
+		0,
+		SOIL_LOAD_RGBA);
+	if (image == 0)
+		std::cout << "ERROR::SOIL: Failed to load image " << path << std::endl;
+
+	glTexImage2D(GL_TEXTURE_2D,
+		0,
+		GL_RGBA,
+		width,
+		height,
+		0,
+		GL_RGBA,
+		GL_UNSIGNED_BYTE,
+		image);
+
+	// Bind texture
+	glGenerateMipmap(GL_TEXTURE_2D);
+	SOIL_free_image_data(image);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// RGBA8, plus a third again for the mip chain
+	entry.texture = texture;
+	entry.width = width;
+	entry.height = height;
+	entry.bytes = (size_t)width * (size_t)height * 4 * 4 / 3;
+	entry.refCount = 1;
+
+	return texture;
+}
+
+/*
+*	Returns the singleton instance of the texture cache
+*	Parameters - none
+*	Return - reference to the texture cache instance
+*/
+TextureCache& TextureCache::GetInstance()
+{
+	// Return the singleton
+	if (m_textureCache == 0)
+		m_textureCache = new TextureCache();
+
+	return *m_textureCache;
+}
+
+/*
+*	Destroys the singleton instance of the texture cache
+*	Parameters - none
+*	Return - void
+*/
+void TextureCache::DestroyInstance()
+{
+	// Delete the singleton instance
+	delete m_textureCache;
+	m_textureCache = 0;
+}
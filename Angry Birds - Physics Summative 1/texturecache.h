@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+// Local includes
+#include "utils.h"
+
+// Library includes
+#include <map>
+#include <string>
+
+// A decoded and uploaded texture, shared by every object that uses the same file
+struct CachedTexture
+{
+	GLuint texture;
+	int width;
+	int height;
+	size_t bytes;
+	unsigned refCount;
+};
+
+class TextureCache
+{
+public:
+
+	~TextureCache();
+
+	static TextureCache& GetInstance();
+	static void DestroyInstance();
+
+	GLuint Acquire(const std::string& path);
+	void Release(GLuint texture);
+
+	bool GetSize(GLuint texture, int& width, int& height);
+	size_t GetResidentBytes();
+	unsigned GetTextureCount();
+
+private:
+
+	// Private methods
+	TextureCache();
+	TextureCache(const TextureCache& other);
+	TextureCache& operator= (const TextureCache& other);
+
+	GLuint LoadTexture(const std::string& path, CachedTexture& entry);
+
+	// Textures by asset path, and the path of each texture handle
+	std::map<std::string, CachedTexture> m_textures;
+	std::map<GLuint, std::string> m_paths;
+	size_t m_residentBytes;
+
+	// Singleton Instance
+	static TextureCache* m_textureCache;
+
+};
+
+#endif
@@ -3,9 +3,12 @@
 #pragma once
 
 // Third-party includes
+// The headless build only runs the simulation, so it has no window, GL context or image loading
+#ifndef HEADLESS
 #include "Dependencies\glew\glew.h"
 #include "Dependencies\GLFW\glfw3.h"
 #include "Dependencies\soil\SOIL.h"
+#endif
 #include "Dependencies\Box2D\Box2D\Box2D.h"
 
 #include "Dependencies\glm\glm.hpp"
@@ -15,6 +18,7 @@
 // Library includes
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 // Constants
 #define WINDOW_WIDTH 1280